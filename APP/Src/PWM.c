@@ -8,310 +8,283 @@
  *                      两个PWM之间的分配比例可调
  *******************************************************************************/
 
+#include "CONFIG.h"
 #include "PWM.h"
+#include "app_log.h"
 #include "CH58x_common.h"
 #include <stdio.h>
 
-#define PWM_TMR1_ADV_TICKS 0
+// PWMX基准时钟分频（基准周期 = PWM_CLK_DIV / FREQ_SYS），一个PWM周期为 PWM_CLK_DIV * 256 个系统时钟
+#define PWM_CLK_DIV        3
+
+// PWM4/PWM5 两路通道掩码
+#define PWM_CHANNEL_MASK   (PWM_CHANNEL_1 | PWM_CHANNEL_2)
+
+// PWM4/PWM5数据保持寄存器的半字访问，低字节为PWM4、高字节为PWM5，一次写入同时提交两路
+#define R16_PWM4_5_DATA    (*((PUINT16V)&R8_PWM4_DATA))
+
+// 影子数据与输出使能两次写入之间的插入点，主机测试在此模拟周期结束中断，固件中为空
+#ifndef PWM_SHADOW_HOOK
+#define PWM_SHADOW_HOOK()
+#endif
 
 /*********************************************************************
  * GLOBAL VARIABLES
  */
 
-// 当前总占空比 (0-100)
-static uint8_t g_total_duty = 0;
+// 当前总占空比，Q8格式 (0-256，256表示100%)
+static uint16_t g_total_q8 = 0;
+
+// 当前PWM1占总占空比的比例，Q8格式 (0-256，128表示完全平衡)
+static uint16_t g_ratio_q8 = PWM_Q8_ONE / 2;
 
-// 当前平衡度 (-100 到 +100)
-static int8_t g_balance = 0;
+// PWM1和PWM2的实际宽度，Q8格式 (0-256)，两者之和恒等于gamma校正后的总宽度
+static uint16_t g_width1 = 0; // A 通道宽度, 对应 PA12 / PWM4
+static uint16_t g_width2 = 0; // B 通道宽度, 对应 PA13 / PWM5
 
-// PWM1和PWM2的实际占空比 (0-100)
-static uint8_t g_duty1 = 0; // A 通道占空比 (%), 对应 PA9 / TMR0 PWM0
-static uint8_t g_duty2 = 0; // B 通道占空比 (%), 对应 PB6 / PWMX PWM8
+// 当前输出模式，见PWM_OUTPUT_ALIGNED / PWM_OUTPUT_SEQUENTIAL
+static uint8_t g_output_mode = PWM_OUTPUT_ALIGNED;
 
-// 记录最近一次计算得到的定时器周期和高电平宽度（tick）
-static uint32_t g_period_ticks = 0; // 一个PWM周期对应的定时器计数（与PWMX保持一致）
-static uint32_t g_ta_ticks     = 0; // A 高电平宽度（tick）
-static uint32_t g_tb_ticks     = 0; // B 高电平宽度（tick）
+// PWM4/PWM5寄存器影子：最近一次提交（或待在周期结束中断中提交）的数据和输出使能，及两路输出是否已开启
+static volatile uint16_t g_hw_data    = 0;
+static volatile uint8_t  g_hw_out_en  = 0;
+static uint8_t           g_hw_enabled = 0;
 
-// 待在TMR1中断中开启的PWM8有效数据宽度（0-255），0表示当前无需开启B通道
-static volatile uint8_t g_pwm8_width_pending = 0;
+// 渐变引擎使用的TMOS任务
+static tmosTaskID PWM_TaskID = INVALID_TASK_ID;
+
+// 渐变状态：累加器为Q16格式（Q8宽度左移8位），每个tick加一次步进值
+static int32_t  g_fade_total_acc  = 0;
+static int32_t  g_fade_total_step = 0;
+static int32_t  g_fade_ratio_acc  = 0;
+static int32_t  g_fade_ratio_step = 0;
+static uint16_t g_fade_target_total = 0;
+static uint16_t g_fade_target_ratio = 0;
+static uint16_t g_fade_ticks_left   = 0; // 剩余tick数，0表示当前无渐变
 
 /*********************************************************************
  * LOCAL FUNCTIONS
  */
 
 /*********************************************************************
- * @fn      PWM_UpdateOutput
+ * @fn      PWM_ClampQ8
  *
- * @brief   根据总占空比和平衡度计算并更新PWM参数（占空比百分比）
- *          计算公式：
- *          duty1 = total_duty * (1 + balance/100) / 2
- *          duty2 = total_duty * (1 - balance/100) / 2
+ * @brief   将数值限制在 0-max 范围内（无分支实现）
+ *          比较结果直接参与掩码运算，RISC-V上编译为sltu而非跳转
  *
- * @return  None
+ * @param   x   - 输入值
+ * @param   max - 上限
+ *
+ * @return  限幅后的值
  */
-static void PWM_UpdateOutput(void)
+static inline uint16_t PWM_ClampQ8(uint32_t x, uint32_t max)
 {
-    int16_t temp_duty1, temp_duty2;
-
-    // 限制总占空比范围 0-100
-    if (g_total_duty > 100) {
-        g_total_duty = 100;
-    }
-
-    // 限制平衡度范围 -100到+100
-    if (g_balance > 100) {
-        g_balance = 100;
-    } else if (g_balance < -100) {
-        g_balance = -100;
-    }
-
-    // 计算两个PWM的占空比（百分比）
-    // duty1 = total_duty * (100 + balance) / 200
-    // duty2 = total_duty * (100 - balance) / 200
-    temp_duty1 = ((int16_t)g_total_duty * (100 + g_balance)) / 200;
-    temp_duty2 = ((int16_t)g_total_duty * (100 - g_balance)) / 200;
-
-    // 限制范围
-    if (temp_duty1 < 0) temp_duty1 = 0;
-    if (temp_duty1 > 100) temp_duty1 = 100;
-    if (temp_duty2 < 0) temp_duty2 = 0;
-    if (temp_duty2 > 100) temp_duty2 = 100;
-
-    g_duty1 = (uint8_t)temp_duty1;
-    g_duty2 = (uint8_t)temp_duty2;
-
-    // 计算对应的定时器tick数
-    // 为了与PWMX(PWM8, PB6)保持同频，这里选用与PWMX一致的周期：
-    // PWMX: F_pwm = FREQ_SYS / (3 * 256) ≈ 78.1kHz (当FREQ_SYS=60MHz)
-    // 因此TMR0的计数周期也设置为 3*256 个系统时钟
-    g_period_ticks = 3 * 256;
-    if (g_period_ticks == 0) {
-        g_period_ticks = 1;
-    }
-
-    g_ta_ticks = (g_period_ticks * g_duty1) / 100; // A高电平宽度
-    g_tb_ticks = (g_period_ticks * g_duty2) / 100; // B高电平宽度
+    return (uint16_t)(x - ((x - max) & (0U - (uint32_t)(x > max))));
+}
 
-    // 防止超过一个周期
-    if (g_ta_ticks > g_period_ticks) g_ta_ticks = g_period_ticks;
-    if (g_tb_ticks > g_period_ticks) g_tb_ticks = g_period_ticks;
+/*********************************************************************
+ * @fn      PWM_Q8ToHwWidth
+ *
+ * @brief   Q8宽度 (0-256) 转换为PWMX 8位数据寄存器值 (0-255)
+ *          256 (100%) 无法用8位表示，饱和为255
+ *
+ * @return  PWMX有效数据宽度
+ */
+static inline uint8_t PWM_Q8ToHwWidth(uint16_t w)
+{
+    return (uint8_t)(w - (w >> 8));
 }
 
-// 根据当前g_duty1/g_duty2，直接通过PWMX在PA12(PWM4)、PA13(PWM5)输出PWM
-static void PWM_UpdateHardware_PWMX(void)
+/*********************************************************************
+ * @fn      PWM_UpdateOutput
+ *
+ * @brief   根据Q8格式的总占空比和分配比例计算两路PWM宽度
+ *          总占空比先经gamma查表转换为实际输出宽度，再按比例分配
+ *          计算公式（全部为乘法与移位，无除法）：
+ *          total  = PWM_GammaLUT[total_q8]
+ *          width1 = (total * ratio_q8 + 128) >> 8
+ *          width2 = total - width1
+ *
+ * @return  None
+ */
+static void PWM_UpdateOutput(void)
 {
-    uint8_t width1 = 0;
-    uint8_t width2 = 0;
-
-    if (g_duty1 > 0)
-    {
-        uint32_t tmp = (PWM_CYCLE_MAX * g_duty1) / 100U;
-        if (tmp > 255U) tmp = 255U;
-        width1 = (uint8_t)tmp;
-    }
+    uint32_t total;
+    uint32_t w1;
 
-    if (g_duty2 > 0)
-    {
-        uint32_t tmp = (PWM_CYCLE_MAX * g_duty2) / 100U;
-        if (tmp > 255U) tmp = 255U;
-        width2 = (uint8_t)tmp;
-    }
+    g_total_q8 = PWM_ClampQ8(g_total_q8, PWM_Q8_ONE);
+    g_ratio_q8 = PWM_ClampQ8(g_ratio_q8, PWM_Q8_ONE);
 
-    // 确保PWMX时钟和周期配置为约80kHz
-    PWMX_CLKCfg(3);
-    PWMX_CycleCfg(PWMX_Cycle_256);
+#if (PWM_GAMMA_ENABLE)
+    total = PWM_GammaLUT[g_total_q8];
+#else
+    total = g_total_q8;
+#endif
 
-    // 通道1: PWM4 -> PA12
-    PWMX_ACTOUT(PWM_CHANNEL_1, width1, High_Level, (width1 ? ENABLE : DISABLE));
+    w1 = (total * g_ratio_q8 + (PWM_Q8_ONE / 2)) >> 8;
 
-    // 通道2: PWM5 -> PA13
-    PWMX_ACTOUT(PWM_CHANNEL_2, width2, High_Level, (width2 ? ENABLE : DISABLE));
+    g_width1 = (uint16_t)w1;
+    g_width2 = (uint16_t)(total - w1);
 }
 
+static void PWM_UpdateHardware_PWMX(void);
+
 /*********************************************************************
- * @fn      PWM_StopAll
+ * @fn      PWM_ApplyQ8
  *
- * @brief   停止TMR0/PWMX的PWM输出
+ * @brief   更新Q8目标并立即刷新PWM4/PWM5输出（不影响渐变状态）
+ *
+ * @return  None
  */
-static void PWM_StopAll(void)
+static void PWM_ApplyQ8(uint16_t total_q8, uint16_t ratio_q8)
 {
-    // 关闭PWMX的PWM4(PA12)、PWM5(PA13)输出
-    PWMX_ACTOUT(PWM_CHANNEL_1, 0, High_Level, DISABLE);
-    PWMX_ACTOUT(PWM_CHANNEL_2, 0, High_Level, DISABLE);
+    g_total_q8 = total_q8;
+    g_ratio_q8 = ratio_q8;
+    PWM_UpdateOutput();
 
-    // 关闭TMR1一次性延时定时器，并清除待触发的PWM8宽度
-    TMR1_ITCfg(DISABLE, RB_TMR_IE_CYC_END);
-    TMR1_Disable();
-    TMR1_ClearITFlag(RB_TMR_IF_CYC_END);
-    g_pwm8_width_pending = 0;
+    // 根据新的宽度重新配置PWM4/PWM5输出
+    PWM_UpdateHardware_PWMX();
 }
 
 /*********************************************************************
- * @fn      PWM_StartHardware
+ * @fn      PWM_FadeStop
+ *
+ * @brief   停止正在进行的渐变，输出保持在当前值
+ *          tmos_stop_task()只停止定时，已到期置位的事件需另外清除
  *
- * @brief   按当前计算出的 g_period_ticks / g_ta_ticks / g_tb_ticks
- *          配置并启动 TMR0(PA9) 和 PWMX-PWM8(PB6) 的PWM输出。
- *          先启动A( TMR0 )，再延时Ta后启动B( PWM8 )，实现同一周期内先A后B。
+ * @return  None
  */
-static void PWM_StartHardware(void)
+static void PWM_FadeStop(void)
 {
-    uint32_t ta     = g_ta_ticks;
-    uint32_t tb     = g_tb_ticks;
-    uint32_t period = g_period_ticks;
-
-    // 无高电平时，直接关闭两路PWM
-    if ((ta == 0) && (tb == 0)) {
-        PWM_StopAll();
-        return;
-    }
-
-    // 配置PA9(TMR0)为输出引脚，PB6为PWM8输出引脚
-    GPIOA_ModeCfg(bTMR0, GPIO_ModeOut_PP_5mA);
-    GPIOB_ModeCfg(GPIO_Pin_6, GPIO_ModeOut_PP_5mA);
-
-    // 先停止所有输出
-    PWM_StopAll();
-
-    PRINT("[PWM] StartHW: period=%lu, ta=%lu, tb=%lu\r\n", period, ta, tb);
-
-    // 初始化TMR0 PWM：A通道，输出在PA9
-    if (ta > 0) {
-        TMR0_PWMInit(High_Level, PWM_Times_1);
-        TMR0_PWMCycleCfg(period); // 周期
-        TMR0_PWMActDataWidth(ta); // A高电平宽度
-    }
-
-    // 计算PWM8对应的有效数据宽度（0-256），基于占空比百分比
-    uint8_t pwm8_width = 0;
-    if (tb > 0) {
-        uint32_t tmp = (256U * g_duty2) / 100U;
-        if (tmp > 255U) tmp = 255U;
-        pwm8_width = (uint8_t)tmp;
+    if (g_fade_ticks_left) {
+        g_fade_ticks_left = 0;
+        tmos_stop_task(PWM_TaskID, PWM_FADE_EVT);
+        tmos_clear_event(PWM_TaskID, PWM_FADE_EVT);
     }
+}
 
-    // 若仅有B通道有高电平，直接启动B通道即可
-    if ((ta == 0) && (tb > 0)) {
-        // 配置PWMX时钟与周期（与PB6_PWMX_80kHz_50Duty_Start一致）
-        PWMX_CLKCfg(3);
-        PWMX_CycleCfg(PWMX_Cycle_256);
+/*********************************************************************
+ * @fn      PWM_ProcessEvent
+ *
+ * @brief   PWM任务事件处理，PWM_FADE_EVT按固定tick推进一次渐变
+ *
+ * @param   task_id - The TMOS assigned task ID.
+ * @param   events - events to process.
+ *
+ * @return  events not processed
+ */
+static uint16 PWM_ProcessEvent(uint8 task_id, uint16 events)
+{
+    if (events & SYS_EVENT_MSG) {
+        uint8 *pMsg;
 
-        PWMX_ACTOUT(CH_PWM8, pwm8_width, High_Level, ENABLE);
-        return;
+        if ((pMsg = tmos_msg_receive(task_id)) != NULL) {
+            tmos_msg_deallocate(pMsg);
+        }
+        return (events ^ SYS_EVENT_MSG);
     }
 
-    // 如果B没有高电平，则仅启动A通道即可
-    if (tb == 0) {
-        if (ta > 0) {
-            TMR0_PWMEnable();
-            TMR0_Enable();
+    if (events & PWM_FADE_EVT) {
+        // 渐变已被直接设置打断，残留的事件不能再把输出拉回渐变目标
+        if (g_fade_ticks_left == 0) {
+            return (events ^ PWM_FADE_EVT);
         }
-        return;
+        if (g_fade_ticks_left > 1) {
+            g_fade_ticks_left--;
+            g_fade_total_acc += g_fade_total_step;
+            g_fade_ratio_acc += g_fade_ratio_step;
+            PWM_ApplyQ8((uint16_t)((g_fade_total_acc + 0x80) >> 8),
+                        (uint16_t)((g_fade_ratio_acc + 0x80) >> 8));
+        } else {
+            // 最后一个tick直接落到目标值，消除累加误差
+            g_fade_ticks_left = 0;
+            tmos_stop_task(PWM_TaskID, PWM_FADE_EVT);
+            PWM_ApplyQ8(g_fade_target_total, g_fade_target_ratio);
+        }
+        return (events ^ PWM_FADE_EVT);
     }
 
-    // 此时 A、B 都有高电平需求：
-    // 使用TMR1一次性定时，在Ta时间后通过中断开启B通道：
-    // 1) 先配置并使能TMR1周期结束中断；
-    // 2) 调用TMR1_TimerInit(ta)启动计数；
-    // 3) 紧接着启动A通道(TMR0)。
-
-    g_pwm8_width_pending = pwm8_width;
-
-    TMR1_Disable();
-    TMR1_ClearITFlag(RB_TMR_IF_CYC_END);
-    TMR1_ITCfg(ENABLE, RB_TMR_IE_CYC_END);
-    PFIC_EnableIRQ(TMR1_IRQn);
-    uint32_t delay_ticks = (ta > PWM_TMR1_ADV_TICKS) ? (ta - PWM_TMR1_ADV_TICKS) : 1;
-    // 启动A通道（若有高电平需求）
-    if (ta > 0) {
-        TMR0_PWMEnable();
-        TMR0_Enable();
-    }
-    TMR1_TimerInit(delay_ticks);
+    return 0;
 }
 
-// TMR1中断服务程序：在计时Ta结束后开启B通道(PWM8)输出
-__INTERRUPT __HIGH_CODE void TMR1_IRQHandler(void)
+/*********************************************************************
+ * @fn      PWM_UpdateHardware_PWMX
+ *
+ * @brief   根据当前g_width1/g_width2，通过PWMX在PA12(PWM4)、PA13(PWM5)输出PWM
+ *          PWMX时钟和周期只在初始化时配置一次，这里只写发生变化的数据：
+ *          - 两路宽度均未变化时不写任何寄存器
+ *          - 输出已开启时，新数据交给PWMX周期结束中断，以一次半字写入同时
+ *            提交两路，避免在周期中途改写单路宽度产生窄脉冲
+ *          - 对齐模式下宽度为0时保持通道开启（高电平有效，数据0即恒为低电平），
+ *            不再反复开关输出使能
+ *          - 顺序模式下PWM5为低电平有效，数据写 256-width2，使其在周期末尾
+ *            输出width2宽的高电平；width2为0时无法用数据表示，改为关闭PWM5
+ *
+ * @return  None
+ */
+static void PWM_UpdateHardware_PWMX(void)
 {
-    if (TMR1_GetITFlag(RB_TMR_IF_CYC_END)) {
-        // 清除中断标志并停止TMR1
-        TMR1_ClearITFlag(RB_TMR_IF_CYC_END);
-        TMR1_ITCfg(DISABLE, RB_TMR_IE_CYC_END);
-        TMR1_Disable();
-
-        // 读取待触发的PWM8宽度
-        uint8_t width        = g_pwm8_width_pending;
-        g_pwm8_width_pending = 0;
-
-        if (width) {
-            PWMX_CLKCfg(3);
-            PWMX_CycleCfg(PWMX_Cycle_256);
-            PWMX_ACTOUT(CH_PWM8, width, High_Level, ENABLE);
+    uint8_t  out_en = PWM_CHANNEL_MASK;
+    uint16_t data   = PWM_Q8ToHwWidth(g_width1);
+
+    if (g_output_mode == PWM_OUTPUT_SEQUENTIAL) {
+        if (g_width2) {
+            // width2为256时结果为0，低电平有效时即整周期高电平
+            data |= (uint16_t)((uint8_t)(PWM_Q8_ONE - g_width2)) << 8;
+        } else {
+            out_en = PWM_CHANNEL_1;
         }
+    } else {
+        data |= (uint16_t)PWM_Q8ToHwWidth(g_width2) << 8;
     }
-}
-
-// 使用DelayUs软件延时方式，在A高电平结束后开启B通道(PWM8)
-static void PWM_StartHardware_DelayMode(void)
-{
-    uint32_t ta     = g_ta_ticks;
-    uint32_t tb     = g_tb_ticks;
-    uint32_t period = g_period_ticks;
 
-    if ((ta == 0) && (tb == 0)) {
-        PWM_StopAll();
+    if (!g_hw_enabled) {
+        // 输出尚未开启，直接写入数据后再开启，不存在周期中途改写的问题
+        g_hw_data       = data;
+        g_hw_out_en     = out_en;
+        R16_PWM4_5_DATA = data;
+        R8_PWM_OUT_EN   = (R8_PWM_OUT_EN & ~PWM_CHANNEL_MASK) | out_en;
+        g_hw_enabled    = 1;
         return;
     }
 
-    GPIOA_ModeCfg(bTMR0, GPIO_ModeOut_PP_5mA);
-    GPIOB_ModeCfg(GPIO_Pin_6, GPIO_ModeOut_PP_5mA);
-
-    PWM_StopAll();
-
-    PRINT("[PWM] StartHW_Delay: period=%lu, ta=%lu, tb=%lu\r\n", period, ta, tb);
-
-    if (ta > 0) {
-        TMR0_PWMInit(High_Level, PWM_Times_1);
-        TMR0_PWMCycleCfg(period);
-        TMR0_PWMActDataWidth(ta);
-    }
-
-    uint8_t pwm8_width = 0;
-    if (tb > 0) {
-        uint32_t tmp = (256U * g_duty2) / 100U;
-        if (tmp > 255U) tmp = 255U;
-        pwm8_width = (uint8_t)tmp;
-    }
-
-    if ((ta == 0) && (tb > 0)) {
-        PWMX_CLKCfg(3);
-        PWMX_CycleCfg(PWMX_Cycle_256);
-        PWMX_ACTOUT(CH_PWM8, pwm8_width, High_Level, ENABLE);
+    if ((data == g_hw_data) && (out_en == g_hw_out_en)) {
         return;
     }
 
-    if (tb == 0) {
-        if (ta > 0) {
-            TMR0_PWMEnable();
-            TMR0_Enable();
-        }
-        return;
-    }
-    PWMX_CLKCfg(3);
-    PWMX_CycleCfg(PWMX_Cycle_256);
-    if (ta > 0) {
-        TMR0_PWMEnable();
-        TMR0_Enable();
-    }
+    // 上一次更新的周期结束中断可能仍在等待，先关闭，避免中断把新数据和旧使能拆开提交
+    // （顺序模式下width2变为0时会以数据0、低电平有效开着PWM5，整周期与PWM4重叠）
+    R8_PWM_INT_CTRL = RB_PWM_IF_CYC;
 
-    {
-        volatile uint32_t i;
-        for (i = 0; i < ta; i++) {
-            __nop();
-        }
+    // 更新影子数据，清除残留标志并重新开启周期结束中断，由中断完成提交
+    g_hw_data       = data;
+    PWM_SHADOW_HOOK();
+    g_hw_out_en     = out_en;
+    R8_PWM_INT_CTRL = RB_PWM_IF_CYC | RB_PWM_IE_CYC;
+}
+
+// PWMX周期结束中断：将影子数据和输出使能一次性提交到PWM4/PWM5，随后关闭中断等待下一次更新
+__INTERRUPT __HIGH_CODE void PWMX_IRQHandler(void)
+{
+    if (R8_PWM_INT_CTRL & RB_PWM_IF_CYC) {
+        R16_PWM4_5_DATA = g_hw_data;
+        R8_PWM_OUT_EN   = (R8_PWM_OUT_EN & ~PWM_CHANNEL_MASK) | g_hw_out_en;
+        R8_PWM_INT_CTRL = RB_PWM_IF_CYC;
     }
+}
 
-    PWMX_ACTOUT(CH_PWM8, pwm8_width, High_Level, ENABLE);
+/*********************************************************************
+ * @fn      PWM_StopAll
+ *
+ * @brief   停止PWM4/PWM5的PWM输出
+ */
+static void PWM_StopAll(void)
+{
+    // 关闭PWMX的PWM4(PA12)、PWM5(PA13)输出，并丢弃尚未提交的数据
+    R8_PWM_INT_CTRL = RB_PWM_IF_CYC;
+    PWMX_ACTOUT(PWM_CHANNEL_1, 0, High_Level, DISABLE);
+    PWMX_ACTOUT(PWM_CHANNEL_2, 0, High_Level, DISABLE);
+    g_hw_enabled = 0;
 }
 
 /**
@@ -342,33 +315,29 @@ void PB6_PWMX_80kHz_50Duty_Start(void)
 
 void PWM_ComplementaryInit(void)
 {
-    PRINT("[PWM] HW PWM Init start (TMR0-PA9, PWM8-PB6)\r\n");
+    PRINT("[PWM] HW PWM Init start (PWM4-PA12, PWM5-PA13)\r\n");
 
-    // 确保TMR0保持在PA9，PWMX保持在默认引脚(PA12/PA13/PB4/PB6/PB7)
-    GPIOPinRemap(DISABLE, RB_PIN_TMR0);
+    // 确保PWMX保持在默认引脚(PA12/PA13/PB4/PB6/PB7)
     GPIOPinRemap(DISABLE, RB_PIN_PWMX);
 
     // 配置PA12/PA13为PWM输出引脚（PWM4/PWM5）
     GPIOA_ModeCfg(GPIO_Pin_12 | GPIO_Pin_13, GPIO_ModeOut_PP_5mA);
 
-    // 配置PWMX基准时钟和周期，对应约78kHz
-    PWMX_CLKCfg(3);
+    // 配置PWMX基准时钟和周期，对应约78kHz；之后的更新不再重复配置
+    PWMX_CLKCfg(PWM_CLK_DIV);
     PWMX_CycleCfg(PWMX_Cycle_256);
 
-    // 初始化TMR1作为一次性延时定时器（无引脚输出）
-    TMR1_Disable();
-    TMR1_ITCfg(DISABLE, RB_TMR_IE_CYC_END);
-    TMR1_ClearITFlag(RB_TMR_IF_CYC_END);
-    PFIC_EnableIRQ(TMR1_IRQn);
+    // 默认对齐模式，PWM4/PWM5均为高电平有效，周期结束中断用于同步提交宽度
+    R8_PWM_POLAR &= ~PWM_CHANNEL_MASK;
+    R8_PWM_INT_CTRL = RB_PWM_IF_CYC;
+    PFIC_EnableIRQ(PWMX_SPI1_IRQn);
 
     // 初始化内部状态变量
-    g_total_duty   = 0;
-    g_balance      = 0;
-    g_duty1        = 0;
-    g_duty2        = 0;
-    g_period_ticks = 0;
-    g_ta_ticks     = 0;
-    g_tb_ticks     = 0;
+    g_total_q8    = 0;
+    g_ratio_q8    = PWM_Q8_ONE / 2;
+    g_width1      = 0;
+    g_width2      = 0;
+    g_output_mode = PWM_OUTPUT_ALIGNED;
 
     // 先关闭所有PWM输出
     PWM_StopAll();
@@ -388,7 +357,9 @@ void PWM_ComplementaryInit(void)
  */
 void PWM_SetTotalDuty(uint8_t duty)
 {
-    g_total_duty = duty;
+    if (duty > 100) duty = 100;
+
+    g_total_q8 = PWM_PCT_TO_Q8(duty);
     PWM_UpdateOutput();
 }
 
@@ -407,7 +378,10 @@ void PWM_SetTotalDuty(uint8_t duty)
  */
 void PWM_SetBalance(int8_t balance)
 {
-    g_balance = balance;
+    if (balance > 100) balance = 100;
+    if (balance < -100) balance = -100;
+
+    g_ratio_q8 = PWM_BALANCE_TO_Q8(balance);
     PWM_UpdateOutput();
 }
 
@@ -423,28 +397,201 @@ void PWM_SetBalance(int8_t balance)
  */
 void PWM_SetDutyAndBalance(uint8_t total_duty, int8_t balance)
 {
-    g_total_duty = total_duty;
-    g_balance    = balance;
-    PWM_UpdateOutput();
+    if (total_duty > 100) total_duty = 100;
+    if (balance > 100) balance = 100;
+    if (balance < -100) balance = -100;
 
-    // 根据新的占空比参数重新配置PWM4/PWM5输出
-    PWM_UpdateHardware_PWMX();
+    PWM_SetWidthsQ8(PWM_PCT_TO_Q8(total_duty), PWM_BALANCE_TO_Q8(balance));
 
-    PRINT("[PWM] Set: Total=%d%%, Balance=%d, duty1=%d%%, duty2=%d%%\r\n",
-          g_total_duty, g_balance, g_duty1, g_duty2);
+    APP_LOG4(APP_LOG_PWM_SET, total_duty, balance, g_width1, g_width2);
 }
 
+/*********************************************************************
+ * @fn      PWM_SetDutyAndBalance_DelayMode
+ *
+ * @brief   先A后B版本：切换到顺序输出模式后设置总占空比和平衡度
+ *          相位关系完全由PWMX计数器保证，不再使用定时器中断或软件延时
+ *
+ * @param   total_duty - 总占空比，范围0-100 (%)
+ * @param   balance    - 平衡度，范围-100到+100
+ *
+ * @return  None
+ */
 void PWM_SetDutyAndBalance_DelayMode(uint8_t total_duty, int8_t balance)
 {
-    g_total_duty = total_duty;
-    g_balance    = balance;
-    PWM_UpdateOutput();
+    if (total_duty > 100) total_duty = 100;
+    if (balance > 100) balance = 100;
+    if (balance < -100) balance = -100;
+
+    PWM_SetOutputMode(PWM_OUTPUT_SEQUENTIAL);
+    PWM_SetWidthsQ8(PWM_PCT_TO_Q8(total_duty), PWM_BALANCE_TO_Q8(balance));
+
+    APP_LOG4(APP_LOG_PWM_SET_DELAY, total_duty, balance, g_width1, g_width2);
+}
+
+/*********************************************************************
+ * @fn      PWM_SetWidthsQ8
+ *
+ * @brief   以Q8定点格式同时设置总占空比和分配比例，并更新PWM4/PWM5输出
+ *          百分比接口均为本函数的包装，热路径上只有乘法和移位
+ *
+ * @param   total_q8 - 总占空比，范围0-256 (256表示100%)
+ * @param   ratio_q8 - PWM1占总占空比的比例，范围0-256 (256表示全部给PWM1)
+ *
+ * @return  None
+ */
+void PWM_SetWidthsQ8(uint16_t total_q8, uint16_t ratio_q8)
+{
+    // 直接设置会打断正在进行的渐变
+    PWM_FadeStop();
+    PWM_ApplyQ8(total_q8, ratio_q8);
+}
+
+/*********************************************************************
+ * @fn      PWM_SetOutputMode
+ *
+ * @brief   切换PWM4/PWM5的输出模式
+ *          PWM_OUTPUT_ALIGNED    - 两路均在周期起点变高，可能重叠
+ *          PWM_OUTPUT_SEQUENTIAL - PWM4在周期起点变高，PWM5(低电平有效)在周期末尾变高，
+ *                                  width1+width2不超过一个周期，两路永不重叠
+ *          极性寄存器没有影子缓冲，切换时先关闭输出再以新极性重新开启
+ *
+ * @param   mode - PWM_OUTPUT_ALIGNED / PWM_OUTPUT_SEQUENTIAL
+ *
+ * @return  None
+ */
+void PWM_SetOutputMode(uint8_t mode)
+{
+    if (mode == g_output_mode) {
+        return;
+    }
+
+    PWM_StopAll();
+
+    if (mode == PWM_OUTPUT_SEQUENTIAL) {
+        R8_PWM_POLAR |= PWM_CHANNEL_2;
+    } else {
+        mode = PWM_OUTPUT_ALIGNED;
+        R8_PWM_POLAR &= ~PWM_CHANNEL_2;
+    }
+    g_output_mode = mode;
 
-    // 延时模式下也直接使用PWMX双通道输出，不再做额外CPU延时
     PWM_UpdateHardware_PWMX();
+}
+
+/*********************************************************************
+ * @fn      PWM_GetOutputMode
+ *
+ * @brief   获取当前PWM4/PWM5的输出模式
+ *
+ * @return  PWM_OUTPUT_ALIGNED / PWM_OUTPUT_SEQUENTIAL
+ */
+uint8_t PWM_GetOutputMode(void)
+{
+    return g_output_mode;
+}
 
-    PRINT("[PWM][Delay] Set: Total=%d%%, Balance=%d, duty1=%d%%, duty2=%d%%\r\n",
-          g_total_duty, g_balance, g_duty1, g_duty2);
+/*********************************************************************
+ * @fn      PWM_FadeInit
+ *
+ * @brief   注册PWM渐变引擎的TMOS任务，需在TMOS初始化(CH58X_BLEInit)之后调用
+ *
+ * @return  None
+ */
+void PWM_FadeInit(void)
+{
+    PWM_TaskID = TMOS_ProcessEventRegister(PWM_ProcessEvent);
+}
+
+/*********************************************************************
+ * @fn      PWM_FadeToQ8
+ *
+ * @brief   在duration_ms内从当前值线性渐变到目标值
+ *          起始时只做一次除法算出每tick步进，之后由TMOS重装载任务
+ *          每PWM_FADE_TICK_MS推进一次，无需上位机再发送任何数据
+ *
+ * @param   total_q8    - 目标总占空比，范围0-256
+ * @param   ratio_q8    - 目标PWM1分配比例，范围0-256
+ * @param   duration_ms - 渐变时长(ms)，小于一个tick时立即生效
+ *
+ * @return  None
+ */
+void PWM_FadeToQ8(uint16_t total_q8, uint16_t ratio_q8, uint16_t duration_ms)
+{
+    uint16_t steps;
+
+    total_q8 = PWM_ClampQ8(total_q8, PWM_Q8_ONE);
+    ratio_q8 = PWM_ClampQ8(ratio_q8, PWM_Q8_ONE);
+
+    if ((duration_ms < PWM_FADE_TICK_MS) || (PWM_TaskID == INVALID_TASK_ID)) {
+        PWM_SetWidthsQ8(total_q8, ratio_q8);
+        return;
+    }
+
+    steps = (duration_ms + PWM_FADE_TICK_MS / 2) / PWM_FADE_TICK_MS;
+
+    // 从当前实际输出位置（可能是另一次渐变的中途）开始
+    g_fade_total_acc    = (int32_t)g_total_q8 << 8;
+    g_fade_ratio_acc    = (int32_t)g_ratio_q8 << 8;
+    g_fade_total_step   = (((int32_t)total_q8 << 8) - g_fade_total_acc) / steps;
+    g_fade_ratio_step   = (((int32_t)ratio_q8 << 8) - g_fade_ratio_acc) / steps;
+    g_fade_target_total = total_q8;
+    g_fade_target_ratio = ratio_q8;
+    g_fade_ticks_left   = steps;
+
+    tmos_start_reload_task(PWM_TaskID, PWM_FADE_EVT, MS1_TO_SYSTEM_TIME(PWM_FADE_TICK_MS));
+}
+
+/*********************************************************************
+ * @fn      PWM_FadeTo
+ *
+ * @brief   百分比形式的渐变接口
+ *
+ * @param   total_duty  - 目标总占空比，范围0-100 (%)
+ * @param   balance     - 目标平衡度，范围-100到+100
+ * @param   duration_ms - 渐变时长(ms)
+ *
+ * @return  None
+ */
+void PWM_FadeTo(uint8_t total_duty, int8_t balance, uint16_t duration_ms)
+{
+    if (total_duty > 100) total_duty = 100;
+    if (balance > 100) balance = 100;
+    if (balance < -100) balance = -100;
+
+    PWM_FadeToQ8(PWM_PCT_TO_Q8(total_duty), PWM_BALANCE_TO_Q8(balance), duration_ms);
+}
+
+/*********************************************************************
+ * @fn      PWM_FadeIsActive
+ *
+ * @brief   查询是否有渐变正在进行
+ *
+ * @return  TRUE - 渐变中，FALSE - 空闲
+ */
+uint8_t PWM_FadeIsActive(void)
+{
+    return (g_fade_ticks_left != 0);
+}
+
+/*********************************************************************
+ * @fn      PWM_GetWidthsQ8
+ *
+ * @brief   获取当前PWM1和PWM2的Q8宽度
+ *
+ * @param   width1 - 输出PWM1的宽度 (0-256)
+ * @param   width2 - 输出PWM2的宽度 (0-256)
+ *
+ * @return  None
+ */
+void PWM_GetWidthsQ8(uint16_t *width1, uint16_t *width2)
+{
+    if (width1 != NULL) {
+        *width1 = g_width1;
+    }
+    if (width2 != NULL) {
+        *width2 = g_width2;
+    }
 }
 
 /*********************************************************************
@@ -460,10 +607,10 @@ void PWM_SetDutyAndBalance_DelayMode(uint8_t total_duty, int8_t balance)
 void PWM_GetActualDuty(uint8_t *duty1, uint8_t *duty2)
 {
     if (duty1 != NULL) {
-        *duty1 = g_duty1;
+        *duty1 = PWM_Q8_TO_PCT(g_width1);
     }
     if (duty2 != NULL) {
-        *duty2 = g_duty2;
+        *duty2 = PWM_Q8_TO_PCT(g_width2);
     }
 }
 
@@ -0,0 +1,35 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : PWM_Gamma.c
+ * Author             :
+ * Version            : V1.0
+ * Date               : 2025/12/01
+ * Description        : PWM感知亮度(gamma)查找表，由 tools/gen_pwm_gamma.py 生成，
+ *                      请勿手工修改。gamma = 2.20
+ *******************************************************************************/
+
+#include "PWM.h"
+
+#if (PWM_GAMMA_ENABLE)
+
+// 输入：Q8感知亮度 (0-256)，输出：Q8实际宽度 (0-256)
+const uint16_t PWM_GammaLUT[PWM_Q8_ONE + 1] = {
+      0,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,
+      1,   1,   1,   1,   1,   1,   1,   1,   1,   2,   2,   2,   2,   2,   2,   2,
+      3,   3,   3,   3,   3,   4,   4,   4,   4,   5,   5,   5,   5,   6,   6,   6,
+      6,   7,   7,   7,   8,   8,   8,   9,   9,   9,  10,  10,  11,  11,  11,  12,
+     12,  13,  13,  13,  14,  14,  15,  15,  16,  16,  17,  17,  18,  18,  19,  19,
+     20,  20,  21,  21,  22,  23,  23,  24,  24,  25,  26,  26,  27,  28,  28,  29,
+     30,  30,  31,  32,  32,  33,  34,  35,  35,  36,  37,  38,  38,  39,  40,  41,
+     42,  42,  43,  44,  45,  46,  47,  47,  48,  49,  50,  51,  52,  53,  54,  55,
+     56,  57,  58,  59,  60,  61,  62,  63,  64,  65,  66,  67,  68,  69,  70,  71,
+     72,  73,  74,  76,  77,  78,  79,  80,  81,  82,  84,  85,  86,  87,  89,  90,
+     91,  92,  94,  95,  96,  97,  99, 100, 101, 103, 104, 105, 107, 108, 109, 111,
+    112, 114, 115, 117, 118, 119, 121, 122, 124, 125, 127, 128, 130, 131, 133, 134,
+    136, 138, 139, 141, 142, 144, 145, 147, 149, 150, 152, 154, 155, 157, 159, 160,
+    162, 164, 166, 167, 169, 171, 173, 174, 176, 178, 180, 182, 183, 185, 187, 189,
+    191, 193, 195, 197, 198, 200, 202, 204, 206, 208, 210, 212, 214, 216, 218, 220,
+    222, 224, 226, 228, 230, 232, 235, 237, 239, 241, 243, 245, 247, 249, 252, 254,
+    256,
+};
+
+#endif
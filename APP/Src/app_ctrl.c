@@ -0,0 +1,449 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : app_ctrl.c
+ * Author             :
+ * Version            : V1.0
+ * Date               : 2026/01/12
+ * Description        : 蓝牙PWM控制协议解析实现
+ *                      一帧内的命令先解析到一个待执行结构中，同类命令后者覆盖前者，
+ *                      帧解析结束后统一执行一次，避免批量命令逐条刷新PWM
+ *                      带序号的帧执行结果存入应答环形缓冲区，由peripheral任务合并发送
+ *******************************************************************************/
+
+#include "CONFIG.h"
+#include "PWM.h"
+#include "app_ctrl.h"
+#include "app_log.h"
+#include "app_uart.h"
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+
+// 一帧解析出的待执行命令
+typedef struct
+{
+    uint8_t  has_pwm;   // 是否有PWM设置/渐变命令
+    uint8_t  has_mode;  // 是否有输出模式命令
+    uint8_t  has_seq;   // 是否需要应答
+    uint8_t  has_uart;  // 是否有串口配置命令
+    uint8_t  seq;
+    uint8_t  mode;
+    uint16_t total_q8;
+    uint16_t ratio_q8;
+    uint16_t fade_ms;
+    uint32_t uart_baud;
+    uint8_t  uart_parity;
+    uint8_t  uart_stop;
+} app_ctrl_cmd_t;
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+
+// 待发送应答，每条为 [序号][结果]；下标自由递增，访问时取模
+static uint8_t app_ctrl_ack_buf[APP_CTRL_ACK_MAX][2];
+static uint8_t app_ctrl_ack_head = 0;
+static uint8_t app_ctrl_ack_tail = 0;
+
+/*********************************************************************
+ * @fn      app_ctrl_set_pct
+ *
+ * @brief   以百分比格式记录一条PWM命令，超出0-100的值按100处理
+ *
+ * @return  None
+ */
+static void app_ctrl_set_pct(app_ctrl_cmd_t *cmd, uint8_t total_duty, uint8_t pwm4_ratio, uint16_t fade_ms)
+{
+    if(total_duty > 100) total_duty = 100;
+    if(pwm4_ratio > 100) pwm4_ratio = 100;
+
+    APP_LOG3(APP_LOG_BLE_PWM, total_duty, pwm4_ratio, fade_ms);
+
+    cmd->has_pwm = 1;
+    cmd->total_q8 = PWM_PCT_TO_Q8(total_duty);
+    cmd->ratio_q8 = PWM_PCT_TO_Q8(pwm4_ratio);
+    cmd->fade_ms = fade_ms;
+}
+
+/*********************************************************************
+ * @fn      app_ctrl_parse_tlv
+ *
+ * @brief   解析一条TLV到待执行命令，未知类型直接忽略
+ *
+ * @param   cmd  - 待执行命令
+ * @param   type - TLV类型
+ * @param   v    - TLV值
+ * @param   len  - TLV值长度（调用前已确认不超出帧尾）
+ *
+ * @return  APP_CTRL_OK 或 APP_CTRL_ERR_VALUE
+ */
+static uint8_t app_ctrl_parse_tlv(app_ctrl_cmd_t *cmd, uint8_t type, const uint8_t *v, uint8_t len)
+{
+    switch(type)
+    {
+        case APP_CTRL_TLV_SET:
+            if(len != 2)
+            {
+                return APP_CTRL_ERR_VALUE;
+            }
+            app_ctrl_set_pct(cmd, v[0], v[1], 0);
+            break;
+
+        case APP_CTRL_TLV_FADE:
+            if(len != 4)
+            {
+                return APP_CTRL_ERR_VALUE;
+            }
+            app_ctrl_set_pct(cmd, v[0], v[1], BUILD_UINT16(v[2], v[3]));
+            break;
+
+        case APP_CTRL_TLV_SET_Q8:
+            if((len != 4) && (len != 6))
+            {
+                return APP_CTRL_ERR_VALUE;
+            }
+            // 超过256的值由PWM模块钳位
+            cmd->has_pwm = 1;
+            cmd->total_q8 = BUILD_UINT16(v[0], v[1]);
+            cmd->ratio_q8 = BUILD_UINT16(v[2], v[3]);
+            cmd->fade_ms = (len == 6) ? BUILD_UINT16(v[4], v[5]) : 0;
+            break;
+
+        case APP_CTRL_TLV_MODE:
+            if((len != 1) || (v[0] > PWM_OUTPUT_SEQUENTIAL))
+            {
+                return APP_CTRL_ERR_VALUE;
+            }
+            cmd->has_mode = 1;
+            cmd->mode = v[0];
+            break;
+
+        case APP_CTRL_TLV_SEQ:
+            if(len != 1)
+            {
+                return APP_CTRL_ERR_VALUE;
+            }
+            cmd->has_seq = 1;
+            cmd->seq = v[0];
+            break;
+
+        case APP_CTRL_TLV_UART:
+            if((len != 6) || (v[4] > APP_UART_PARITY_SPACE) || (v[5] < 1) || (v[5] > 2))
+            {
+                return APP_CTRL_ERR_VALUE;
+            }
+            // 波特率误差在执行时由串口模块检查
+            cmd->has_uart = 1;
+            cmd->uart_baud = BUILD_UINT32(v[0], v[1], v[2], v[3]);
+            cmd->uart_parity = v[4];
+            cmd->uart_stop = v[5];
+            break;
+
+        default:
+            // 新版本增加的类型，按长度跳过即可
+            break;
+    }
+    return APP_CTRL_OK;
+}
+
+/*********************************************************************
+ * @fn      app_ctrl_parse_frame
+ *
+ * @brief   解析 [0xA5][版本][TLV]... 格式的帧
+ *          每条TLV在读取前都先检查长度，任何输入都不会越界访问
+ *
+ * @return  遇到的第一个错误，无错误返回APP_CTRL_OK
+ */
+static uint8_t app_ctrl_parse_frame(app_ctrl_cmd_t *cmd, const uint8_t *p_data, uint16_t length)
+{
+    uint16_t pos = APP_CTRL_HDR_LEN;
+    uint8_t  status = APP_CTRL_OK;
+    uint8_t  ret;
+
+    if(length < APP_CTRL_HDR_LEN)
+    {
+        return APP_CTRL_ERR_LENGTH;
+    }
+    if(p_data[1] > APP_CTRL_VERSION)
+    {
+        return APP_CTRL_ERR_VERSION;
+    }
+
+    while(pos < length)
+    {
+        uint8_t type, len;
+
+        if((length - pos) < APP_CTRL_TLV_HDR_LEN)
+        {
+            ret = APP_CTRL_ERR_TRUNCATED;
+        }
+        else
+        {
+            type = p_data[pos];
+            len = p_data[pos + 1];
+            pos += APP_CTRL_TLV_HDR_LEN;
+            ret = ((length - pos) < len) ? APP_CTRL_ERR_TRUNCATED
+                                         : app_ctrl_parse_tlv(cmd, type, &p_data[pos], len);
+        }
+
+        if(ret != APP_CTRL_OK)
+        {
+            APP_LOG2(APP_LOG_CTRL_ERR, ret, pos);
+            if(status == APP_CTRL_OK)
+            {
+                status = ret;
+            }
+            if(ret == APP_CTRL_ERR_TRUNCATED)
+            {
+                break;
+            }
+        }
+        pos += len;
+    }
+    return status;
+}
+
+/*********************************************************************
+ * @fn      app_ctrl_ack_push
+ *
+ * @brief   记录一帧的执行结果，缓存满时丢弃，上位机按超时重发处理
+ *
+ * @return  None
+ */
+static void app_ctrl_ack_push(uint8_t seq, uint8_t status)
+{
+    uint8_t *ack;
+
+    if((uint8_t)(app_ctrl_ack_head - app_ctrl_ack_tail) >= APP_CTRL_ACK_MAX)
+    {
+        APP_LOG1(APP_LOG_CTRL_ACK_DROP, seq);
+        return;
+    }
+    ack = app_ctrl_ack_buf[app_ctrl_ack_head & (APP_CTRL_ACK_MAX - 1)];
+    ack[0] = seq;
+    ack[1] = status;
+    app_ctrl_ack_head++;
+}
+
+/*********************************************************************
+ * @fn      app_ctrl_process
+ *
+ * @brief   解析并执行一次写入的控制数据
+ *
+ * @param   p_data - 写入的数据
+ * @param   length - 数据长度
+ *
+ * @return  APP_CTRL_OK 或 APP_CTRL_ERR_xxx
+ */
+uint8_t app_ctrl_process(const uint8_t *p_data, uint16_t length)
+{
+    app_ctrl_cmd_t cmd = {0};
+    uint8_t        status;
+
+    if((length > 0) && (p_data[0] == APP_CTRL_MAGIC))
+    {
+        status = app_ctrl_parse_frame(&cmd, p_data, length);
+        if(status == APP_CTRL_ERR_VERSION)
+        {
+            // 新版本帧的内容不可信，不执行也不应答
+            APP_LOG2(APP_LOG_CTRL_ERR, status, 1);
+            return status;
+        }
+    }
+    else if((length == 2) || (length == 4))
+    {
+        // 旧格式：2字节立即设置；4字节附带渐变时长（小端，单位ms）
+        app_ctrl_set_pct(&cmd, p_data[0], p_data[1],
+                         (length == 4) ? BUILD_UINT16(p_data[2], p_data[3]) : 0);
+        status = APP_CTRL_OK;
+    }
+    else
+    {
+        APP_LOG1(APP_LOG_BLE_PWM_LEN, length);
+        return APP_CTRL_ERR_LENGTH;
+    }
+
+    // 先切换输出模式，再按新模式刷新宽度
+    if(cmd.has_mode)
+    {
+        PWM_SetOutputMode(cmd.mode);
+    }
+    if(cmd.has_pwm)
+    {
+        // PWM4 = total * ratio，PWM5 = total - PWM4
+        // 渐变由PWM任务按固定tick插值完成，无需上位机持续发送
+        PWM_FadeToQ8(cmd.total_q8, cmd.ratio_q8, cmd.fade_ms);
+    }
+    if(cmd.has_uart && !app_uart_config(cmd.uart_baud, cmd.uart_parity, cmd.uart_stop))
+    {
+        APP_LOG2(APP_LOG_CTRL_ERR, APP_CTRL_ERR_VALUE, 0);
+        if(status == APP_CTRL_OK)
+        {
+            status = APP_CTRL_ERR_VALUE;
+        }
+    }
+    if(cmd.has_seq)
+    {
+        app_ctrl_ack_push(cmd.seq, status);
+    }
+    return status;
+}
+
+/*********************************************************************
+ * @fn      app_ctrl_match
+ *
+ * @brief   判断RX特征值上的一次写入是否为旧格式控制命令
+ *
+ * @param   p_data - 写入的数据
+ * @param   length - 数据长度
+ *
+ * @return  1 - 控制命令，0 - 串口透传数据
+ */
+uint8_t app_ctrl_match(const uint8_t *p_data, uint16_t length)
+{
+    (void)p_data;
+#if (APP_CTRL_LEGACY_ON_RX)
+    if((length == 2) || (length == 4))
+    {
+        return 1;
+    }
+#else
+    (void)length;
+#endif
+    return 0;
+}
+
+/*********************************************************************
+ * @fn      app_ctrl_dispatch
+ *
+ * @brief   分发一次蓝牙写入到控制协议或串口透传
+ *
+ * @param   char_id - APP_CTRL_CHAR_RX 或 APP_CTRL_CHAR_CTRL
+ * @param   p_data  - 写入的数据
+ * @param   length  - 数据长度
+ *
+ * @return  app_ctrl_process()的结果，透传时为APP_CTRL_PASSTHROUGH
+ */
+uint8_t app_ctrl_dispatch(uint8_t char_id, const uint8_t *p_data, uint16_t length)
+{
+    // FFF3全部按控制协议解析；FFF2只做透传，不检查0xA5帧头，旧格式兼容开启时2/4字节写入按命令处理
+    if((char_id == APP_CTRL_CHAR_CTRL) || app_ctrl_match(p_data, length))
+    {
+        APP_LOG1(APP_LOG_BLE_RX, length);
+        return app_ctrl_process(p_data, length);
+    }
+
+    // 透传数据：蓝牙 -> 串口，FIFO放不下的部分计入丢弃统计
+    app_uart_tx_data((uint8_t *)p_data, length);
+    return APP_CTRL_PASSTHROUGH;
+}
+
+/*********************************************************************
+ * @fn      app_ctrl_ack_pending
+ *
+ * @brief   获取等待发送的应答数
+ *
+ * @return  应答数
+ */
+uint8_t app_ctrl_ack_pending(void)
+{
+    return (uint8_t)(app_ctrl_ack_head - app_ctrl_ack_tail);
+}
+
+/*********************************************************************
+ * @fn      app_ctrl_ack_build
+ *
+ * @brief   把等待发送的应答组成一条ACK帧：[0xA5][版本][ACK][2n][序号,结果]...
+ *
+ * @param   buf  - 输出缓冲区
+ * @param   size - 缓冲区大小
+ *
+ * @return  帧长度，0表示没有可发送的应答
+ */
+uint16_t app_ctrl_ack_build(uint8_t *buf, uint16_t size)
+{
+    uint16_t len = APP_CTRL_HDR_LEN + APP_CTRL_TLV_HDR_LEN;
+    uint8_t  idx = app_ctrl_ack_tail;
+    uint8_t  n = 0;
+
+    // TLV长度字段只有1字节
+    if(size > 255 + APP_CTRL_HDR_LEN + APP_CTRL_TLV_HDR_LEN)
+    {
+        size = 255 + APP_CTRL_HDR_LEN + APP_CTRL_TLV_HDR_LEN;
+    }
+
+    while((idx != app_ctrl_ack_head) && ((len + 2) <= size))
+    {
+        uint8_t *ack = app_ctrl_ack_buf[idx & (APP_CTRL_ACK_MAX - 1)];
+
+        buf[len++] = ack[0];
+        buf[len++] = ack[1];
+        idx++;
+        n++;
+    }
+    if(n == 0)
+    {
+        return 0;
+    }
+
+    buf[0] = APP_CTRL_MAGIC;
+    buf[1] = APP_CTRL_VERSION;
+    buf[2] = APP_CTRL_TLV_ACK;
+    buf[3] = n * 2;
+    return len;
+}
+
+/*********************************************************************
+ * @fn      app_ctrl_credit_build
+ *
+ * @brief   组一条流控额度帧：[0xA5][版本][CREDIT][2][剩余字节 2B]
+ *
+ * @param   buf  - 输出缓冲区
+ * @param   size - 缓冲区大小
+ * @param   room - 串口发送FIFO剩余字节数
+ *
+ * @return  帧长度，缓冲区不足时返回0
+ */
+uint16_t app_ctrl_credit_build(uint8_t *buf, uint16_t size, uint16_t room)
+{
+    if(size < APP_CTRL_HDR_LEN + APP_CTRL_TLV_HDR_LEN + 2)
+    {
+        return 0;
+    }
+    buf[0] = APP_CTRL_MAGIC;
+    buf[1] = APP_CTRL_VERSION;
+    buf[2] = APP_CTRL_TLV_CREDIT;
+    buf[3] = 2;
+    buf[4] = LO_UINT16(room);
+    buf[5] = HI_UINT16(room);
+    return APP_CTRL_HDR_LEN + APP_CTRL_TLV_HDR_LEN + 2;
+}
+
+/*********************************************************************
+ * @fn      app_ctrl_ack_release
+ *
+ * @brief   释放已随ACK帧发送成功的应答
+ *
+ * @param   frame_len - app_ctrl_ack_build()返回的帧长度
+ *
+ * @return  None
+ */
+void app_ctrl_ack_release(uint16_t frame_len)
+{
+    if(frame_len > APP_CTRL_HDR_LEN + APP_CTRL_TLV_HDR_LEN)
+    {
+        app_ctrl_ack_tail += (uint8_t)((frame_len - APP_CTRL_HDR_LEN - APP_CTRL_TLV_HDR_LEN) / 2);
+    }
+}
+
+/*********************************************************************
+ * @fn      app_ctrl_ack_flush
+ *
+ * @brief   丢弃所有未发送的应答
+ *
+ * @return  None
+ */
+void app_ctrl_ack_flush(void)
+{
+    app_ctrl_ack_tail = app_ctrl_ack_head;
+}
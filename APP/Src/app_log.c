@@ -0,0 +1,176 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : app_log.c
+ * Author             :
+ * Version            : V1.0
+ * Date               : 2026/01/10
+ * Description        : Deferred binary log, see app_log.h
+ *******************************************************************************/
+
+/*********************************************************************
+ * INCLUDES
+ */
+#include "CONFIG.h"
+#include "app_log.h"
+
+#ifdef DEBUG
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+
+typedef struct
+{
+    uint32_t time;                    //TMOS system clock, 625us unit
+    uint8_t  id;                      //app_log_id_t
+    uint8_t  argc;                    //valid entries in arg[]
+    uint16_t lost;                    //records dropped just before this one
+    uint32_t arg[APP_LOG_MAX_ARGS];
+} app_log_rec_t;
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+
+static tmosTaskID app_log_task_id = INVALID_TASK_ID;
+
+static app_log_rec_t app_log_ring[APP_LOG_RING_LEN];
+
+//free-running indexes, masked on access
+static uint16_t app_log_head = 0;
+static uint16_t app_log_tail = 0;
+
+static uint16_t app_log_lost = 0;
+
+/*********************************************************************
+ * @fn      app_log_drain_one
+ *
+ * @brief   Print the oldest record as one "#L" line and release it.
+ *
+ * @return  none
+ */
+static void app_log_drain_one(void)
+{
+    app_log_rec_t *rec = &app_log_ring[app_log_tail & (APP_LOG_RING_LEN - 1)];
+    uint8_t        i;
+
+    PRINT("#L %lx %x %x", rec->time, rec->id, rec->lost);
+    for(i = 0; i < rec->argc; i++)
+    {
+        PRINT(" %lx", rec->arg[i]);
+    }
+    PRINT("\n");
+
+    app_log_tail++;
+}
+
+/*********************************************************************
+ * @fn      app_log_process_event
+ *
+ * @brief   Log task event processor.
+ *          Only one record is printed per pass so a backlog never holds
+ *          the TMOS loop for longer than one UART line.
+ *
+ * @param   task_id - The TMOS assigned task ID.
+ * @param   events - events to process.
+ *
+ * @return  events not processed
+ */
+static uint16_t app_log_process_event(uint8_t task_id, uint16_t events)
+{
+    if(events & SYS_EVENT_MSG)
+    {
+        uint8_t *pMsg;
+
+        if((pMsg = tmos_msg_receive(task_id)) != NULL)
+        {
+            tmos_msg_deallocate(pMsg);
+        }
+        return (events ^ SYS_EVENT_MSG);
+    }
+
+    if(events & APP_LOG_DRAIN_EVT)
+    {
+        if(app_log_head != app_log_tail)
+        {
+            app_log_drain_one();
+        }
+        if(app_log_head != app_log_tail)
+        {
+            tmos_set_event(app_log_task_id, APP_LOG_DRAIN_EVT);
+        }
+        return (events ^ APP_LOG_DRAIN_EVT);
+    }
+
+    return 0;
+}
+
+/*********************************************************************
+ * @fn      app_log_init
+ *
+ * @brief   Register the log drain task.
+ *
+ * @return  none
+ */
+void app_log_init(void)
+{
+    app_log_task_id = TMOS_ProcessEventRegister(app_log_process_event);
+
+    if(app_log_head != app_log_tail)
+    {
+        tmos_set_event(app_log_task_id, APP_LOG_DRAIN_EVT);
+    }
+}
+
+/*********************************************************************
+ * @fn      app_log_push
+ *
+ * @brief   Store one record in the ring and schedule the drain.
+ *
+ * @param   id   - app_log_id_t
+ * @param   argc - number of valid arguments (0-APP_LOG_MAX_ARGS)
+ * @param   a0~a3 - arguments
+ *
+ * @return  none
+ */
+void app_log_push(uint8_t id, uint8_t argc, uint32_t a0, uint32_t a1, uint32_t a2, uint32_t a3)
+{
+    app_log_rec_t *rec;
+    uint8_t        was_empty = (app_log_head == app_log_tail);
+
+    if((uint16_t)(app_log_head - app_log_tail) >= APP_LOG_RING_LEN)
+    {
+        if(app_log_lost != 0xFFFF)
+        {
+            app_log_lost++;
+        }
+        return;
+    }
+
+    rec = &app_log_ring[app_log_head & (APP_LOG_RING_LEN - 1)];
+    rec->time = TMOS_GetSystemClock();
+    rec->id = id;
+    rec->argc = (argc > APP_LOG_MAX_ARGS) ? APP_LOG_MAX_ARGS : argc;
+    rec->lost = app_log_lost;
+    rec->arg[0] = a0;
+    rec->arg[1] = a1;
+    rec->arg[2] = a2;
+    rec->arg[3] = a3;
+    app_log_lost = 0;
+    app_log_head++;
+
+    if(was_empty && (app_log_task_id != INVALID_TASK_ID))
+    {
+        tmos_set_event(app_log_task_id, APP_LOG_DRAIN_EVT);
+    }
+}
+
+#else
+
+void app_log_init(void)
+{
+}
+
+#endif /* DEBUG */
+
+/*********************************************************************
+*********************************************************************/
@@ -0,0 +1,408 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : app_pd.c
+ * Author             :
+ * Version            : V1.0
+ * Date               : 2026/01/20
+ * Description        : FUSB302 PD受电端任务实现
+ *                      USB302_Init()中的阻塞延时拆成任务状态之间的定时，
+ *                      收包只在INT脚拉低时进行，主循环和蓝牙不会被PD协商阻塞；
+ *                      硬件IIC时状态寄存器和FIFO由IIC中断读取，读取期间其他访问芯片的事件推迟
+ *                      使用PPS档位时每8s重发同一请求；PWM调光，电压不跟随亮度
+ *******************************************************************************/
+
+#include "CONFIG.h"
+#include "FUSB30X.h"
+#include "app_pd.h"
+
+/*********************************************************************
+ * GLOBAL VARIABLES
+ */
+
+volatile uint8_t app_pd_int_flag = 0;
+
+volatile uint8_t app_pd_iic_flag = 0;
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+
+static tmosTaskID app_pd_task_id = INVALID_TASK_ID;
+
+static uint8_t app_pd_cur_state = APP_PD_STATE_DETACHED;
+
+// 连接后连续检测到CC脚无电压的次数
+static uint8_t app_pd_detach_cnt = 0;
+
+// 一次INT事件最多处理的消息数，超过后让出给其他任务（阻塞读取时）
+#define APP_PD_INT_BURST         4
+
+// 中断方式收包期间访问芯片的事件，推迟到收包结束
+#define APP_PD_IIC_EVENTS        (APP_PD_STEP_EVT | APP_PD_INT_EVT | APP_PD_REQUEST_EVT | APP_PD_PPS_EVT)
+
+// 收包期间到来、被推迟的事件
+static uint16_t app_pd_deferred = 0;
+
+/*********************************************************************
+ * @fn      app_pd_detach
+ *
+ * @brief   拔出处理：清空协商状态，回到周期检测
+ *
+ * @return  none
+ */
+static void app_pd_detach(void)
+{
+    PRINT("[PD] detached\n");
+    PD_STEP = 0;
+    PD_Source_Capabilities_Inf_num = 0;
+    app_pd_cur_state = APP_PD_STATE_DETACHED;
+    tmos_stop_task(app_pd_task_id, APP_PD_REQUEST_EVT);
+    tmos_stop_task(app_pd_task_id, APP_PD_PPS_EVT);
+    tmos_clear_event(app_pd_task_id, APP_PD_INT_EVT);
+    tmos_start_task(app_pd_task_id, APP_PD_STEP_EVT, APP_PD_DETECT_PERIOD);
+}
+
+/*********************************************************************
+ * @fn      app_pd_pps_active
+ *
+ * @brief   是否已按PPS档位完成请求
+ *
+ * @return  1 - PPS, 0 - 其他
+ */
+static uint8_t app_pd_pps_active(void)
+{
+    return (app_pd_cur_state == APP_PD_STATE_ATTACHED) && (PD_STEP == 3) &&
+           (PD_Request_Inf.type == USB302_PDO_APDO);
+}
+
+/*********************************************************************
+ * @fn      app_pd_pps_refresh
+ *
+ * @brief   重发当前PPS请求并重新开始刷新计时
+ *
+ * @return  none
+ */
+static void app_pd_pps_refresh(void)
+{
+    if(!app_pd_pps_active())
+    {
+        return;
+    }
+    USB302_Send_Request(&PD_Request_Inf);
+    tmos_start_task(app_pd_task_id, APP_PD_PPS_EVT, APP_PD_PPS_REFRESH_TICKS);
+}
+
+/*********************************************************************
+ * @fn      app_pd_step
+ *
+ * @brief   检测/连接状态机的一步，每步结束时启动下一步的定时
+ *
+ * @return  none
+ */
+static void app_pd_step(void)
+{
+    switch(app_pd_cur_state)
+    {
+        case APP_PD_STATE_DETACHED:
+            USB302_Reset();
+            app_pd_cur_state = APP_PD_STATE_RESET;
+            tmos_start_task(app_pd_task_id, APP_PD_STEP_EVT, APP_PD_RESET_TICKS);
+            break;
+
+        case APP_PD_STATE_RESET:
+            USB302_Meas_CC_Start(1);
+            app_pd_cur_state = APP_PD_STATE_MEAS_CC1;
+            tmos_start_task(app_pd_task_id, APP_PD_STEP_EVT, APP_PD_MEAS_TICKS);
+            break;
+
+        case APP_PD_STATE_MEAS_CC1:
+        case APP_PD_STATE_MEAS_CC2:
+            if(USB302_Meas_CC_Read())
+            {
+                PRINT("[PD] attached on CC%d\n", (app_pd_cur_state == APP_PD_STATE_MEAS_CC1) ? 1 : 2);
+                USB302_Attach_Start((app_pd_cur_state == APP_PD_STATE_MEAS_CC1) ? 1 : 2);
+                app_pd_cur_state = APP_PD_STATE_ATTACHING;
+                tmos_start_task(app_pd_task_id, APP_PD_STEP_EVT, APP_PD_RESET_TICKS);
+            }
+            else if(app_pd_cur_state == APP_PD_STATE_MEAS_CC1)
+            {
+                USB302_Meas_CC_Start(2);
+                app_pd_cur_state = APP_PD_STATE_MEAS_CC2;
+                tmos_start_task(app_pd_task_id, APP_PD_STEP_EVT, APP_PD_MEAS_TICKS);
+            }
+            else
+            {
+                app_pd_cur_state = APP_PD_STATE_DETACHED;
+                tmos_start_task(app_pd_task_id, APP_PD_STEP_EVT, APP_PD_DETECT_PERIOD);
+            }
+            break;
+
+        case APP_PD_STATE_ATTACHING:
+            USB302_Attach_Config();
+            app_pd_cur_state = APP_PD_STATE_ATTACHED;
+            app_pd_detach_cnt = 0;
+            // 配置期间INT可能已经拉低，下降沿不会再来，直接检查一次
+            tmos_set_event(app_pd_task_id, APP_PD_INT_EVT);
+            tmos_start_task(app_pd_task_id, APP_PD_STEP_EVT, APP_PD_DETACH_PERIOD);
+            break;
+
+        case APP_PD_STATE_ATTACHED:
+            if(USB302_CC_Attached())
+            {
+                app_pd_detach_cnt = 0;
+            }
+            else if(++app_pd_detach_cnt >= APP_PD_DETACH_COUNT)
+            {
+                app_pd_detach();
+                break;
+            }
+            tmos_start_task(app_pd_task_id, APP_PD_STEP_EVT, APP_PD_DETACH_PERIOD);
+            break;
+
+        default:
+            break;
+    }
+}
+
+/*********************************************************************
+ * @fn      app_pd_iic_done
+ *
+ * @brief   IIC中断方式读取结束回调（中断上下文），只置标志
+ *
+ * @return  none
+ */
+__HIGH_CODE
+static void app_pd_iic_done(void)
+{
+    app_pd_iic_flag = 1;
+}
+
+/*********************************************************************
+ * @fn      app_pd_rx_done
+ *
+ * @brief   一条消息处理完：收到档位（首次或重新协商）后延时发送请求，还有消息时继续
+ *
+ * @return  none
+ */
+static void app_pd_rx_done(void)
+{
+    if(PD_STEP == 2)
+    {
+        tmos_start_task(app_pd_task_id, APP_PD_REQUEST_EVT, APP_PD_REQUEST_TICKS);
+    }
+    // INT仍为低说明还有消息，下一轮继续处理
+    if(READ_FUSB30X_INT == 0)
+    {
+        tmos_set_event(app_pd_task_id, APP_PD_INT_EVT);
+    }
+}
+
+/*********************************************************************
+ * @fn      app_pd_service
+ *
+ * @brief   INT脚拉低时读取收到的消息
+ *          传输支持中断方式时只启动读取，由APP_PD_IIC_EVT继续；否则阻塞读取
+ *
+ * @return  none
+ */
+static void app_pd_service(void)
+{
+    uint8_t n;
+
+    if(app_pd_cur_state != APP_PD_STATE_ATTACHED)
+    {
+        return;
+    }
+    if((READ_FUSB30X_INT == 0) && (USB302_Rx_Start() == 0))
+    {
+        tmos_start_task(app_pd_task_id, APP_PD_IIC_TIMEOUT_EVT, APP_PD_IIC_TIMEOUT_TICKS);
+        return;
+    }
+    for(n = 0; (n < APP_PD_INT_BURST) && (READ_FUSB30X_INT == 0); n++)
+    {
+        USB302_Data_Service();
+    }
+    app_pd_rx_done();
+}
+
+/*********************************************************************
+ * @fn      app_pd_rx_end
+ *
+ * @brief   中断方式收包结束：处理消息，恢复收包期间推迟的事件
+ *
+ * @return  none
+ */
+static void app_pd_rx_end(void)
+{
+    tmos_stop_task(app_pd_task_id, APP_PD_IIC_TIMEOUT_EVT);
+    app_pd_rx_done();
+    if(app_pd_deferred)
+    {
+        tmos_set_event(app_pd_task_id, app_pd_deferred);
+        app_pd_deferred = 0;
+    }
+}
+
+/*********************************************************************
+ * @fn      app_pd_process_event
+ *
+ * @brief   PD任务事件处理
+ *
+ * @param   task_id - The TMOS assigned task ID.
+ * @param   events - events to process.
+ *
+ * @return  events not processed
+ */
+static uint16_t app_pd_process_event(uint8_t task_id, uint16_t events)
+{
+    if(events & SYS_EVENT_MSG)
+    {
+        uint8_t *pMsg;
+
+        if((pMsg = tmos_msg_receive(task_id)) != NULL)
+        {
+            tmos_msg_deallocate(pMsg);
+        }
+        return (events ^ SYS_EVENT_MSG);
+    }
+
+    if(events & APP_PD_IIC_EVT)
+    {
+        if(USB302_Rx_Busy())
+        {
+            if(USB302_Rx_Continue())
+            {
+                tmos_start_task(app_pd_task_id, APP_PD_IIC_TIMEOUT_EVT, APP_PD_IIC_TIMEOUT_TICKS);
+            }
+            else
+            {
+                app_pd_rx_end();
+            }
+        }
+        return (events ^ APP_PD_IIC_EVT);
+    }
+
+    if(events & APP_PD_IIC_TIMEOUT_EVT)
+    {
+        if(USB302_Rx_Busy())
+        {
+            PRINT("[PD] IIC timeout\n");
+            USB302_Rx_Abort();
+            app_pd_iic_flag = 0;
+            app_pd_rx_end();
+        }
+        return (events ^ APP_PD_IIC_TIMEOUT_EVT);
+    }
+
+    // 收包期间IIC被占用，访问芯片的事件等收包结束后再处理
+    if(USB302_Rx_Busy() && (events & APP_PD_IIC_EVENTS))
+    {
+        app_pd_deferred |= events & APP_PD_IIC_EVENTS;
+        return (events & ~APP_PD_IIC_EVENTS);
+    }
+
+    if(events & APP_PD_INT_EVT)
+    {
+        app_pd_service();
+        return (events ^ APP_PD_INT_EVT);
+    }
+
+    if(events & APP_PD_REQUEST_EVT)
+    {
+        if((app_pd_cur_state == APP_PD_STATE_ATTACHED) && (PD_STEP == 2))
+        {
+            USB302_Get_Data();
+            PRINT("[PD] request sent\n");
+            if(app_pd_pps_active())
+            {
+                tmos_start_task(app_pd_task_id, APP_PD_PPS_EVT, APP_PD_PPS_REFRESH_TICKS);
+            }
+        }
+        return (events ^ APP_PD_REQUEST_EVT);
+    }
+
+    if(events & APP_PD_PPS_EVT)
+    {
+        app_pd_pps_refresh();
+        return (events ^ APP_PD_PPS_EVT);
+    }
+
+    if(events & APP_PD_STEP_EVT)
+    {
+        app_pd_step();
+        return (events ^ APP_PD_STEP_EVT);
+    }
+
+    return 0;
+}
+
+/*********************************************************************
+ * @fn      app_pd_init
+ *
+ * @brief   初始化PD任务
+ *
+ * @return  none
+ */
+void app_pd_init(void)
+{
+    app_pd_task_id = TMOS_ProcessEventRegister(app_pd_process_event);
+
+    GPIOB_ModeCfg(FUSB30Xint_GPIO, GPIO_ModeIN_PU);
+    GPIOB_ITModeCfg(FUSB30Xint_GPIO, GPIO_ITMode_FallEdge);
+    PFIC_EnableIRQ(GPIO_B_IRQn);
+
+    fusb302_iic_set_done_callback(app_pd_iic_done);
+
+    app_pd_cur_state = APP_PD_STATE_DETACHED;
+    tmos_set_event(app_pd_task_id, APP_PD_STEP_EVT);
+}
+
+/*********************************************************************
+ * @fn      app_pd_process
+ *
+ * @brief   主循环中把INT脚中断和IIC读取结束转为任务事件
+ *
+ * @return  none
+ */
+void app_pd_process(void)
+{
+    if(app_pd_int_flag)
+    {
+        app_pd_int_flag = 0;
+        tmos_set_event(app_pd_task_id, APP_PD_INT_EVT);
+    }
+    if(app_pd_iic_flag)
+    {
+        app_pd_iic_flag = 0;
+        tmos_set_event(app_pd_task_id, APP_PD_IIC_EVT);
+    }
+}
+
+/*********************************************************************
+ * @fn      app_pd_state
+ *
+ * @brief   获取任务状态
+ *
+ * @return  APP_PD_STATE_xxx
+ */
+uint8_t app_pd_state(void)
+{
+    return app_pd_cur_state;
+}
+
+/*********************************************************************
+ * @fn      GPIOB_IRQHandler
+ *
+ * @brief   GPIOB中断，FUSB302 INT脚(PB5)下降沿
+ *
+ * @return  none
+ */
+__INTERRUPT
+__HIGH_CODE
+void GPIOB_IRQHandler(void)
+{
+    if(GPIOB_ReadITFlagBit(FUSB30Xint_GPIO))
+    {
+        GPIOB_ClearITFlagBit(FUSB30Xint_GPIO);
+        app_pd_int_flag = 1;
+    }
+}
@@ -17,38 +17,61 @@
 #include "devinfoservice.h"
 #include "peripheral.h"
 #include "app_uart.h"
+#include "app_log.h"
+#include <stddef.h>
 
 /*********************************************************************
  * MACROS
  */
 //The buffer length should be a power of 2
-#define APP_UART_TX_BUFFER_LENGTH    512U
+#define APP_UART_TX_BUFFER_LENGTH    1024U
 #define APP_UART_RX_BUFFER_LENGTH    2048U
 
+//ble -> uart credits: a credit is notified when the tx fifo fills past HIGH,
+//and again once the uart has drained it back to LOW
+#define APP_UART_TX_CREDIT_HIGH      (APP_UART_TX_BUFFER_LENGTH / 2)
+#define APP_UART_TX_CREDIT_LOW       (APP_UART_TX_BUFFER_LENGTH / 4)
+
+#if(APP_UART_FLOW_CTRL)
+  #define APP_UART_CTS_READY()    (GPIOA_ReadPortPin(APP_UART_CTS_PIN) == 0)
+#else
+  #define APP_UART_CTS_READY()    (1)
+#endif
+
 /*********************************************************************
  * CONSTANTS
  */
 
+#define APP_UART_CFG_MAGIC    0x5A
+
 /*********************************************************************
  * TYPEDEFS
  */
 
+//uart configuration as saved in data flash
+typedef struct
+{
+    uint32_t baud;
+    uint8_t  parity;    //APP_UART_PARITY_xxx
+    uint8_t  stop_bits; //1 or 2
+    uint8_t  magic;
+    uint8_t  check;     //~sum of the bytes before it
+} app_uart_cfg_t;
+
 /*********************************************************************
  * GLOBAL VARIABLES
  */
-uint8_t to_test_buffer[BLE_BUFF_MAX_LEN - 4 - 3];
-
 app_drv_fifo_t app_uart_tx_fifo;
 app_drv_fifo_t app_uart_rx_fifo;
 
 //interupt uart rx flag ,clear at main loop
-bool uart_rx_flag = false;
+volatile bool uart_rx_flag = false;
 
 //for interrupt rx blcak hole ,when uart rx fifo full
 uint8_t for_uart_rx_black_hole = 0;
 
-//fifo length less that MTU-3, retry times
-uint32_t uart_to_ble_send_evt_cnt = 0;
+//interupt uart rx idle flag (RECV_TOUT), clear by the uart to ble flush
+volatile bool uart_rx_idle_flag = false;
 
 /*********************************************************************
  * EXTERNAL VARIABLES
@@ -64,15 +87,277 @@ uint32_t uart_to_ble_send_evt_cnt = 0;
 //
 
 //The tx buffer and rx buffer for app_drv_fifo
-//length should be a power of 2
-static uint8_t app_uart_tx_buffer[APP_UART_TX_BUFFER_LENGTH] = {0};
-static uint8_t app_uart_rx_buffer[APP_UART_RX_BUFFER_LENGTH] = {0};
+//length should be a power of 2, word aligned so app_drv_fifo can copy by words
+__attribute__((aligned(4))) static uint8_t app_uart_tx_buffer[APP_UART_TX_BUFFER_LENGTH] = {0};
+__attribute__((aligned(4))) static uint8_t app_uart_rx_buffer[APP_UART_RX_BUFFER_LENGTH] = {0};
+
+//tx fifo passed APP_UART_TX_CREDIT_HIGH, the client waits for a new credit
+static volatile bool app_uart_tx_throttled = false;
+
+//set by the interrupt once a throttled tx fifo is down to APP_UART_TX_CREDIT_LOW
+static volatile bool app_uart_tx_resume_flag = false;
+
+//current uart configuration
+static app_uart_cfg_t app_uart_cfg = {APP_UART_BAUD_DEFAULT, APP_UART_PARITY_NONE, 1, 0, 0};
 
+//RTS released by the interrupt, asserted again by app_uart_process
+static volatile bool app_uart_rts_held = false;
+
+//uart -> ble flush state, only used from the ble task
+static bool     app_uart_flush_armed = false; //data is waiting, app_uart_flush_since is valid
+static bool     app_uart_flush_idle = false;  //line went idle, send everything buffered
+static uint8_t  app_uart_flush_reason = APP_UART_FLUSH_FULL;
+static uint32_t app_uart_flush_since = 0;     //when the waiting data was first seen
+
+//flush statistics for the diagnostics record
+static uint16_t app_uart_flush_cnt[APP_UART_FLUSH_REASONS] = {0};
+static uint16_t app_uart_flush_hist[APP_UART_FLUSH_HIST_NUM] = {0};
+static const uint16_t app_uart_flush_hist_bounds[APP_UART_FLUSH_HIST_NUM - 1] = APP_UART_FLUSH_HIST_BOUNDS;
 
 /*********************************************************************
  * LOCAL FUNCTIONS
  */
 
+/*********************************************************************
+ * @fn      app_uart_tx_kick
+ *
+ * @brief   enable the THR empty interrupt, it fires at once while the hardware
+ *          fifo is empty and then drains app_uart_tx_fifo from the interrupt
+ *
+ * @return  NULL
+ */
+static void app_uart_tx_kick(void)
+{
+    if(APP_UART_CTS_READY())
+    {
+        R8_UART3_IER |= RB_IER_THR_EMPTY;
+    }
+}
+
+/*********************************************************************
+ * @fn      app_uart_tx_refill
+ *
+ * @brief   THR empty: top up the hardware fifo from app_uart_tx_fifo (its only
+ *          consumer) and stop the interrupt once nothing is pending
+ *
+ * @return  NULL
+ */
+__HIGH_CODE
+static void app_uart_tx_refill(void)
+{
+    if(APP_UART_CTS_READY())
+    {
+        app_drv_fifo_read_to_same_addr(&app_uart_tx_fifo, (uint8_t *)&R8_UART3_THR, UART_FIFO_SIZE - R8_UART3_TFC);
+        if(app_uart_tx_throttled && !app_uart_tx_resume_flag &&
+           (app_drv_fifo_length(&app_uart_tx_fifo) <= APP_UART_TX_CREDIT_LOW))
+        {
+            app_uart_tx_resume_flag = true;
+        }
+        if(!app_drv_fifo_is_empty(&app_uart_tx_fifo))
+        {
+            return;
+        }
+    }
+    //the bytes still in the hardware fifo go out on their own
+    R8_UART3_IER &= ~RB_IER_THR_EMPTY;
+}
+
+#if(APP_UART_FLOW_CTRL)
+/*********************************************************************
+ * @fn      app_uart_rx_room
+ *
+ * @brief   free bytes in the rx fifo
+ *
+ * @return  free bytes
+ */
+static uint16_t app_uart_rx_room(void)
+{
+    return app_uart_rx_fifo.size - app_drv_fifo_length(&app_uart_rx_fifo);
+}
+
+/*********************************************************************
+ * @fn      app_uart_rts_release
+ *
+ * @brief   assert RTS again once the rx fifo has drained to APP_UART_RTS_GO_ROOM,
+ *          the uart interrupt is masked so it cannot release RTS in between
+ *
+ * @return  NULL
+ */
+static void app_uart_rts_release(void)
+{
+    if(!app_uart_rts_held)
+    {
+        return;
+    }
+    PFIC_DisableIRQ(UART3_IRQn);
+    if(app_uart_rx_room() >= APP_UART_RTS_GO_ROOM)
+    {
+        app_uart_rts_held = false;
+        GPIOA_ResetBits(APP_UART_RTS_PIN);
+    }
+    PFIC_EnableIRQ(UART3_IRQn);
+}
+#endif
+
+/*********************************************************************
+ * @fn      app_uart_cfg_check
+ *
+ * @brief   checksum of a saved configuration
+ *
+ * @return  check byte
+ */
+static uint8_t app_uart_cfg_check(const app_uart_cfg_t *p_cfg)
+{
+    const uint8_t *p = (const uint8_t *)p_cfg;
+    uint8_t        sum = 0;
+    uint8_t        i;
+
+    for(i = 0; i < offsetof(app_uart_cfg_t, check); i++)
+    {
+        sum += p[i];
+    }
+    return (uint8_t)~sum;
+}
+
+/*********************************************************************
+ * @fn      app_uart_cfg_valid
+ *
+ * @brief   check a configuration can be applied
+ *
+ * @return  divisor in *p_dl, false if not supported
+ */
+static bool app_uart_cfg_valid(const app_uart_cfg_t *p_cfg, uint16_t *p_dl)
+{
+    if((p_cfg->parity > APP_UART_PARITY_SPACE) || (p_cfg->stop_bits < 1) || (p_cfg->stop_bits > 2))
+    {
+        return false;
+    }
+    return app_uart_baud_divisor(GetSysClock(), p_cfg->baud, p_dl);
+}
+
+/*********************************************************************
+ * @fn      app_uart_cfg_apply
+ *
+ * @brief   write baud rate and framing to UART3
+ *
+ * @return  NULL
+ */
+static void app_uart_cfg_apply(const app_uart_cfg_t *p_cfg, uint16_t dl)
+{
+    uint8_t lcr = RB_LCR_WORD_SZ;
+
+    if(p_cfg->stop_bits == 2)
+    {
+        lcr |= RB_LCR_STOP_BIT;
+    }
+    if(p_cfg->parity != APP_UART_PARITY_NONE)
+    {
+        //parity mode field: 00-odd, 01-even, 10-mark, 11-space
+        lcr |= RB_LCR_PAR_EN | ((p_cfg->parity - APP_UART_PARITY_ODD) << 4);
+    }
+    R8_UART3_DIV = 1;
+    R16_UART3_DL = dl;
+    R8_UART3_LCR = lcr;
+}
+
+/*********************************************************************
+ * @fn      app_uart_cfg_save
+ *
+ * @brief   save the configuration to data flash
+ *
+ * @return  true if written
+ */
+static bool app_uart_cfg_save(app_uart_cfg_t *p_cfg)
+{
+    p_cfg->magic = APP_UART_CFG_MAGIC;
+    p_cfg->check = app_uart_cfg_check(p_cfg);
+
+    if(EEPROM_ERASE(APP_UART_CFG_EEPROM_ADDR, EEPROM_MIN_ER_SIZE) != 0)
+    {
+        return false;
+    }
+    return (EEPROM_WRITE(APP_UART_CFG_EEPROM_ADDR, p_cfg, sizeof(app_uart_cfg_t)) == 0);
+}
+
+/*********************************************************************
+ * @fn      app_uart_cfg_load
+ *
+ * @brief   load the saved configuration, the default is kept when none is valid
+ *
+ * @return  NULL
+ */
+static void app_uart_cfg_load(void)
+{
+    app_uart_cfg_t cfg;
+    uint16_t       dl;
+
+    EEPROM_READ(APP_UART_CFG_EEPROM_ADDR, &cfg, sizeof(cfg));
+    if((cfg.magic == APP_UART_CFG_MAGIC) && (cfg.check == app_uart_cfg_check(&cfg)) &&
+       app_uart_cfg_valid(&cfg, &dl))
+    {
+        app_uart_cfg = cfg;
+    }
+}
+
+/*********************************************************************
+ * @fn      app_uart_stat_inc
+ *
+ * @brief   saturating counter increment
+ *
+ * @return  NULL
+ */
+static void app_uart_stat_inc(uint16_t *p_cnt)
+{
+    if(*p_cnt != 0xFFFF)
+    {
+        (*p_cnt)++;
+    }
+}
+
+/*********************************************************************
+ * @fn      app_uart_diag_put_u16
+ *
+ * @brief   append 16-bit values to the diagnostics record
+ *
+ * @return  next write position
+ */
+static uint8_t *app_uart_diag_put_u16(uint8_t *p, const uint16_t *p_val, uint8_t num)
+{
+    while(num--)
+    {
+        *p++ = LO_UINT16(*p_val);
+        *p++ = HI_UINT16(*p_val);
+        p_val++;
+    }
+    return p;
+}
+
+/*********************************************************************
+ * @fn      app_uart_diag_put_fifo
+ *
+ * @brief   append one fifo to the diagnostics record
+ *
+ * @return  next write position
+ */
+static uint8_t *app_uart_diag_put_fifo(uint8_t *p, app_drv_fifo_t *fifo)
+{
+    app_drv_fifo_stats_t stats;
+    uint16_t             length = app_drv_fifo_length(fifo);
+
+    app_drv_fifo_get_stats(fifo, &stats);
+    *p++ = BREAK_UINT32(stats.dropped, 0);
+    *p++ = BREAK_UINT32(stats.dropped, 1);
+    *p++ = BREAK_UINT32(stats.dropped, 2);
+    *p++ = BREAK_UINT32(stats.dropped, 3);
+    *p++ = LO_UINT16(stats.overflows);
+    *p++ = HI_UINT16(stats.overflows);
+    *p++ = LO_UINT16(stats.high_water);
+    *p++ = HI_UINT16(stats.high_water);
+    *p++ = LO_UINT16(length);
+    *p++ = HI_UINT16(length);
+    return p;
+}
+
 /*********************************************************************
  * PROFILE CALLBACKS
  */
@@ -90,20 +375,33 @@ static uint8_t app_uart_rx_buffer[APP_UART_RX_BUFFER_LENGTH] = {0};
  */
 void app_uart_process(void)
 {
-    UINT32 irq_status;
-    SYS_DisableAllIrq(&irq_status);
+    //clear before acting: a flag set by the ISR meanwhile is covered by this send event,
+    //the ble task decides whether to send now or wait for the deadline
     if(uart_rx_flag)
     {
-        tmos_start_task(Peripheral_TaskID, UART_TO_BLE_SEND_EVT, 2);
         uart_rx_flag = false;
+        tmos_set_event(Peripheral_TaskID, UART_TO_BLE_SEND_EVT);
     }
-    SYS_RecoverIrq(irq_status);
 
-    //tx process
-    if(R8_UART3_TFC < UART_FIFO_SIZE)
+    //tx fifo drained to the low watermark: hand the client a new credit,
+    //throttled is cleared first so the interrupt cannot raise the flag again meanwhile
+    if(app_uart_tx_resume_flag)
     {
-        app_drv_fifo_read_to_same_addr(&app_uart_tx_fifo, (uint8_t *)&R8_UART3_THR, UART_FIFO_SIZE - R8_UART3_TFC);
+        app_uart_tx_throttled = false;
+        app_uart_tx_resume_flag = false;
+        tmos_set_event(Peripheral_TaskID, UART_CREDIT_EVT);
+    }
+
+#if(APP_UART_FLOW_CTRL)
+    app_uart_rts_release();
+
+    //tx is drained by the THR empty interrupt, which stops while CTS is released;
+    //restart it here once the receiver asserts CTS again
+    if(!app_drv_fifo_is_empty(&app_uart_tx_fifo) && !(R8_UART3_IER & RB_IER_THR_EMPTY))
+    {
+        app_uart_tx_kick();
     }
+#endif
 }
 
 /*********************************************************************
@@ -115,6 +413,8 @@ void app_uart_process(void)
  */
 void app_uart_init()
 {
+    uint16_t dl;
+
     //tx fifo and tx fifo
     //The buffer length should be a power of 2
     app_drv_fifo_init(&app_uart_tx_fifo, app_uart_tx_buffer, APP_UART_TX_BUFFER_LENGTH);
@@ -128,10 +428,25 @@ void app_uart_init()
     GPIOA_SetBits(bRXD3);
     GPIOA_ModeCfg(bRXD3, GPIO_ModeIN_PU);
 
-    //uart3 init
+#if(APP_UART_FLOW_CTRL)
+    //rts io, low: ready to receive
+    app_uart_rts_held = false;
+    GPIOA_ResetBits(APP_UART_RTS_PIN);
+    GPIOA_ModeCfg(APP_UART_RTS_PIN, GPIO_ModeOut_PP_5mA);
+
+    //cts io, pulled up so nothing is sent until the receiver asserts it
+    GPIOA_ModeCfg(APP_UART_CTS_PIN, GPIO_ModeIN_PU);
+#endif
+
+    //uart3 init, then the saved baud rate and framing
     UART3_DefInit();
+    app_uart_cfg_load();
+    if(app_uart_cfg_valid(&app_uart_cfg, &dl))
+    {
+        app_uart_cfg_apply(&app_uart_cfg, dl);
+    }
 
-    //enable interupt
+    //enable interupt, THR empty is enabled by app_uart_tx_kick only while tx data is pending
     UART3_INTCfg(ENABLE, RB_IER_RECV_RDY | RB_IER_LINE_STAT);
     PFIC_EnableIRQ(UART3_IRQn);
 }
@@ -146,7 +461,295 @@ void app_uart_init()
 void app_uart_tx_data(uint8_t *data, uint16_t length)
 {
     uint16_t write_length = length;
-    app_drv_fifo_write(&app_uart_tx_fifo, data, &write_length);
+
+    if(app_drv_fifo_write(&app_uart_tx_fifo, data, &write_length) != APP_DRV_FIFO_RESULT_SUCCESS)
+    {
+        write_length = 0;
+    }
+    if(write_length < length)
+    {
+        app_drv_fifo_drop(&app_uart_tx_fifo, length - write_length);
+    }
+    if(write_length)
+    {
+        app_uart_tx_kick();
+    }
+
+    //high watermark: tell the client how much more it may send
+    if(!app_uart_tx_throttled && (app_drv_fifo_length(&app_uart_tx_fifo) >= APP_UART_TX_CREDIT_HIGH))
+    {
+        app_uart_tx_throttled = true;
+        tmos_set_event(Peripheral_TaskID, UART_CREDIT_EVT);
+    }
+}
+
+/*********************************************************************
+ * @fn      app_uart_tx_room
+ *
+ * @brief   free bytes in the tx fifo, the credit handed to the client
+ *
+ * @return  free bytes
+ */
+uint16_t app_uart_tx_room(void)
+{
+    return app_uart_tx_fifo.size - app_drv_fifo_length(&app_uart_tx_fifo);
+}
+
+/*********************************************************************
+ * @fn      app_uart_diag_read
+ *
+ * @brief   fill the diagnostics record, see APP_UART_DIAG_LEN
+ *
+ * @return  record length, 0 if size is too small
+ */
+uint16_t app_uart_diag_read(uint8_t *buf, uint16_t size)
+{
+    uint8_t *p = buf;
+    uint8_t  flags = 0;
+
+    if(size < APP_UART_DIAG_LEN)
+    {
+        return 0;
+    }
+#if(APP_UART_FLOW_CTRL)
+    flags |= APP_UART_DIAG_FLOW_CTRL;
+    if(app_uart_rts_held)
+    {
+        flags |= APP_UART_DIAG_RTS_HELD;
+    }
+    if(!APP_UART_CTS_READY())
+    {
+        flags |= APP_UART_DIAG_CTS_HELD;
+    }
+#endif
+    *p++ = APP_UART_DIAG_VERSION;
+    *p++ = flags;
+    p = app_uart_diag_put_fifo(p, &app_uart_rx_fifo);
+    p = app_uart_diag_put_fifo(p, &app_uart_tx_fifo);
+    p = app_uart_diag_put_u16(p, app_uart_flush_cnt, APP_UART_FLUSH_REASONS);
+    p = app_uart_diag_put_u16(p, app_uart_flush_hist, APP_UART_FLUSH_HIST_NUM);
+    return (uint16_t)(p - buf);
+}
+
+/*********************************************************************
+ * @fn      app_uart_tx_credit_reset
+ *
+ * @brief   forget the tx throttle state, for a flushed fifo or a new connection
+ *          throttled is cleared first so the interrupt cannot raise the resume flag again
+ *
+ * @return  NULL
+ */
+void app_uart_tx_credit_reset(void)
+{
+    app_uart_tx_throttled = false;
+    app_uart_tx_resume_flag = false;
+}
+
+/*********************************************************************
+ * @fn      app_uart_baud_divisor
+ *
+ * @brief   divisor latch value for a baud rate, baud = fsys / 8 / dl
+ *          the two divisors around fsys / 8 / baud are compared by the
+ *          rate error |fsys / 8 / dl - baud|, rounding the divisor alone
+ *          picks the wrong one near the midpoint
+ *
+ * @param   fsys - system clock
+ * @param   baud - wanted baud rate
+ * @param   p_dl - out, divisor
+ *
+ * @return  false if out of range or the error exceeds APP_UART_BAUD_TOLERANCE
+ */
+bool app_uart_baud_divisor(uint32_t fsys, uint32_t baud, uint16_t *p_dl)
+{
+    uint32_t clk = fsys / 8;
+    uint32_t dl;
+    uint64_t err_lo;
+    uint64_t err_hi;
+
+    if(baud == 0)
+    {
+        return false;
+    }
+    //rate error of dl scaled by dl: |clk - baud * dl|
+    dl = clk / baud;
+    err_lo = clk - (uint64_t)baud * dl;
+    err_hi = (uint64_t)baud * (dl + 1) - clk;
+    if((dl == 0) || (err_hi * dl < err_lo * (dl + 1)))
+    {
+        dl++;
+        err_lo = err_hi;
+    }
+    if(dl > 0xFFFF)
+    {
+        return false;
+    }
+    if(err_lo * 1000 > (uint64_t)baud * dl * APP_UART_BAUD_TOLERANCE)
+    {
+        return false;
+    }
+    *p_dl = (uint16_t)dl;
+    return true;
+}
+
+/*********************************************************************
+ * @fn      app_uart_config
+ *
+ * @brief   reconfigure baud rate and framing at runtime
+ *          data queued in either direction was framed for the old setting,
+ *          so both directions are dropped and the client gets a fresh credit
+ *
+ * @param   baud      - baud rate
+ * @param   parity    - APP_UART_PARITY_xxx
+ * @param   stop_bits - 1 or 2
+ *
+ * @return  false if the setting is not supported
+ */
+bool app_uart_config(uint32_t baud, uint8_t parity, uint8_t stop_bits)
+{
+    app_uart_cfg_t cfg = {baud, parity, stop_bits, 0, 0};
+    uint16_t       dl;
+    bool           saved = false;
+
+    if(!app_uart_cfg_valid(&cfg, &dl))
+    {
+        return false;
+    }
+
+    //with the interrupt masked this task may flush the tx fifo it normally only fills
+    PFIC_DisableIRQ(UART3_IRQn);
+    R8_UART3_IER &= ~RB_IER_THR_EMPTY;
+    R8_UART3_FCR |= RB_FCR_TX_FIFO_CLR | RB_FCR_RX_FIFO_CLR;
+    app_drv_fifo_flush(&app_uart_tx_fifo);
+    app_uart_rx_discard();
+    app_uart_tx_credit_reset();
+    app_uart_cfg_apply(&cfg, dl);
+    (void)R8_UART3_LSR;
+#if(APP_UART_FLOW_CTRL)
+    app_uart_rts_held = false;
+    GPIOA_ResetBits(APP_UART_RTS_PIN);
+#endif
+    PFIC_EnableIRQ(UART3_IRQn);
+
+    if((cfg.baud != app_uart_cfg.baud) || (cfg.parity != app_uart_cfg.parity) ||
+       (cfg.stop_bits != app_uart_cfg.stop_bits))
+    {
+        saved = app_uart_cfg_save(&cfg);
+    }
+    app_uart_cfg = cfg;
+    //the tx fifo is empty now, hand the client a fresh credit
+    tmos_set_event(Peripheral_TaskID, UART_CREDIT_EVT);
+    APP_LOG4(APP_LOG_UART_CFG, baud, parity, stop_bits, saved);
+    (void)saved; //only logged
+    return true;
+}
+
+/*********************************************************************
+ * @fn      app_uart_rx_flush_len
+ *
+ * @brief   decide how much buffered uart data to notify now
+ *
+ * @param   max_len - notification payload size (MTU-3)
+ * @param   p_wait  - out, ticks until the deadline when nothing is due,
+ *                    0 when the fifo is empty
+ *
+ * @return  bytes to send now, 0 if nothing is due
+ */
+uint16_t app_uart_rx_flush_len(uint16_t max_len, uint32_t *p_wait)
+{
+    uint16_t length;
+    uint32_t now;
+    uint32_t waited;
+
+    //clear before reading the length: bytes behind a later timeout raise a new one
+    if(uart_rx_idle_flag)
+    {
+        uart_rx_idle_flag = false;
+        app_uart_flush_idle = true;
+    }
+
+    *p_wait = 0;
+    length = app_drv_fifo_length(&app_uart_rx_fifo);
+    if(length == 0)
+    {
+        app_uart_flush_armed = false;
+        app_uart_flush_idle = false;
+        return 0;
+    }
+
+    now = TMOS_GetSystemClock();
+    if(!app_uart_flush_armed)
+    {
+        app_uart_flush_armed = true;
+        app_uart_flush_since = now;
+    }
+    //a clock wrap only makes this flush early
+    waited = now - app_uart_flush_since;
+
+    if(length >= max_len)
+    {
+        app_uart_flush_reason = APP_UART_FLUSH_FULL;
+        return max_len;
+    }
+    if(app_uart_flush_idle)
+    {
+        app_uart_flush_reason = APP_UART_FLUSH_IDLE;
+        return length;
+    }
+    if(waited >= APP_UART_FLUSH_LATENCY)
+    {
+        app_uart_flush_reason = APP_UART_FLUSH_DEADLINE;
+        return length;
+    }
+    *p_wait = APP_UART_FLUSH_LATENCY - waited;
+    return 0;
+}
+
+/*********************************************************************
+ * @fn      app_uart_rx_flushed
+ *
+ * @brief   drop notified bytes from the rx fifo and account the flush
+ *
+ * @param   length - bytes queued for notification
+ *
+ * @return  NULL
+ */
+void app_uart_rx_flushed(uint16_t length)
+{
+    uint32_t waited = TMOS_GetSystemClock() - app_uart_flush_since;
+    uint8_t  i;
+
+    app_drv_fifo_consume(&app_uart_rx_fifo, length);
+
+    app_uart_stat_inc(&app_uart_flush_cnt[app_uart_flush_reason]);
+    for(i = 0; i < APP_UART_FLUSH_HIST_NUM - 1; i++)
+    {
+        if(waited < app_uart_flush_hist_bounds[i])
+        {
+            break;
+        }
+    }
+    app_uart_stat_inc(&app_uart_flush_hist[i]);
+
+    //left over bytes are not older than the ones just sent, keep their deadline
+    if(app_drv_fifo_is_empty(&app_uart_rx_fifo))
+    {
+        app_uart_flush_armed = false;
+        app_uart_flush_idle = false;
+    }
+}
+
+/*********************************************************************
+ * @fn      app_uart_rx_discard
+ *
+ * @brief   drop buffered uart data and restart the flush policy
+ *
+ * @return  NULL
+ */
+void app_uart_rx_discard(void)
+{
+    app_drv_fifo_flush(&app_uart_rx_fifo);
+    app_uart_flush_armed = false;
+    app_uart_flush_idle = false;
 }
 
 /*********************************************************************
@@ -154,7 +757,8 @@ void app_uart_tx_data(uint8_t *data, uint16_t length)
  *
  * @brief   Not every uart reception will end with a UART_II_RECV_TOUT
  *          UART_II_RECV_TOUT can only be triggered when R8_UARTx_RFC is not 0
- *          Here we cannot rely UART_II_RECV_TOUT as the end of a uart reception
+ *          Here we cannot rely UART_II_RECV_TOUT as the end of a uart reception,
+ *          it only lets a short packet go out early, APP_UART_FLUSH_LATENCY covers the rest
  *
  * @return  NULL
  */
@@ -162,28 +766,69 @@ __INTERRUPT
 __HIGH_CODE
 void UART3_IRQHandler(void)
 {
-    uint16_t error;
-    switch(UART3_GetITFlag())
+    uint8_t *span;
+    uint16_t span_length;
+    uint8_t  rx_count;
+    uint8_t  it = UART3_GetITFlag();
+    uint8_t  i;
+
+    switch(it)
     {
         case UART_II_LINE_STAT:
-            UART3_GetLinSTA();
+            //hardware fifo overrun, at least one byte is gone
+            if(UART3_GetLinSTA() & RB_LSR_OVER_ERR)
+            {
+                app_drv_fifo_drop(&app_uart_rx_fifo, 1);
+            }
             break;
 
         case UART_II_RECV_RDY:
         case UART_II_RECV_TOUT:
-            error = app_drv_fifo_write_from_same_addr(&app_uart_rx_fifo, (uint8_t *)&R8_UART3_RBR, R8_UART3_RFC);
-            if(error != APP_DRV_FIFO_RESULT_SUCCESS)
+            //read the hardware fifo straight into the free span(s) of the ring
+            rx_count = R8_UART3_RFC;
+            while(rx_count)
             {
-                for(uint8_t i = 0; i < R8_UART3_RFC; i++)
+                span_length = app_drv_fifo_reserve_span(&app_uart_rx_fifo, &span);
+                if(span_length == 0)
+                {
+                    break;
+                }
+                span_length = MIN(span_length, rx_count);
+                for(i = 0; i < span_length; i++)
+                {
+                    span[i] = R8_UART3_RBR;
+                }
+                app_drv_fifo_commit(&app_uart_rx_fifo, span_length);
+                rx_count -= span_length;
+            }
+            if(rx_count)
+            {
+                //fifo full, empty the hardware fifo into the black hole and count the loss
+                rx_count = 0;
+                while(R8_UART3_RFC)
                 {
-                    //fifo full,put to fifo black hole
                     for_uart_rx_black_hole = R8_UART3_RBR;
+                    rx_count++;
                 }
+                app_drv_fifo_drop(&app_uart_rx_fifo, rx_count);
+            }
+#if(APP_UART_FLOW_CTRL)
+            if(!app_uart_rts_held && (app_uart_rx_room() < APP_UART_RTS_STOP_ROOM))
+            {
+                app_uart_rts_held = true;
+                GPIOA_SetBits(APP_UART_RTS_PIN);
+            }
+#endif
+            //timeout: the line went quiet, the ble side may send a short packet now
+            if(it == UART_II_RECV_TOUT)
+            {
+                uart_rx_idle_flag = true;
             }
             uart_rx_flag = true;
             break;
 
         case UART_II_THR_EMPTY:
+            app_uart_tx_refill();
             break;
         case UART_II_MODEM_CHG:
             break;
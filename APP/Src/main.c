@@ -23,11 +23,9 @@
 void FUSB302_IIC_GPIO_Init(void)
 {
 
-    GPIOB_ModeCfg(GPIO_Pin_12 | GPIO_Pin_13, GPIO_ModeOut_PP_5mA);
-    GPIOB_SetBits(GPIO_Pin_12 | GPIO_Pin_13);
-
     GPIOB_ModeCfg(GPIO_Pin_5, GPIO_ModeIN_PU);
 
+    // SCL/SDAfusb302_iic_init()ô䷽ʽ
     fusb302_iic_init();
 
     printf("FUSB302 IIC Init\n");
@@ -59,6 +57,10 @@ int main()
     while (1)
     {
         USB302_Data_Service();
+        if (PD_STEP == 2)
+        {
+            DelayMs(10);
+        }
         USB302_Get_Data();
         if (PD_STEP == 3)
         {
@@ -92,6 +94,9 @@ int main()
 #include "CONFIG.h"
 #include "HAL.h"
 #include "PWM.h"
+#include "app_log.h"
+#include "app_pd.h"
+#include "app_uart.h"
 #include "peripheral.h"
 #include "CH58x_common.h"
 #include "FUSB30X.h"
@@ -117,16 +122,16 @@ __attribute__((noinline)) void Main_Circulation()
     while (1)
     {
         TMOS_SystemProcess();
+        app_uart_process();
+        app_pd_process();
     }
 }
 void FUSB302_IIC_GPIO_Init(void)
 {
 
-    GPIOB_ModeCfg(GPIO_Pin_12 | GPIO_Pin_13, GPIO_ModeOut_PP_5mA);
-    GPIOB_SetBits(GPIO_Pin_12 | GPIO_Pin_13);
-
     GPIOB_ModeCfg(GPIO_Pin_5, GPIO_ModeIN_PU);
 
+    // SCL/SDAfusb302_iic_init()ô䷽ʽ
     fusb302_iic_init();
 
     printf("FUSB302 IIC Init\n");
@@ -160,24 +165,6 @@ int main(void)
 
     Check_USB302();
 
-    while (USB302_Init() == 0)
-    {
-        DelayMs(100);
-        printf("WAITTING \n");
-    }
-    printf("connected \n");
-
-    while (1)
-    {
-        USB302_Data_Service();
-        USB302_Get_Data();
-        if (PD_STEP == 3)
-        {
-            printf("handshake OK \n");
-            break;
-        }
-    }
-
     PRINT("%s\n", VER_LIB);
 
     // ʼPWMģ
@@ -191,8 +178,13 @@ int main(void)
     // ʼ
     CH58X_BLEInit();
     HAL_Init();
+    app_log_init();
     GAPRole_PeripheralInit();
     Peripheral_Init();
+    app_uart_init();
+    PWM_FadeInit();
+    // PDЭڶнУPWM
+    app_pd_init();
 
     PRINT("BLE PWM Control System Started\n");
     PRINT("Waiting for BLE connection...\n");
@@ -20,11 +20,22 @@
 #include "app_drv_fifo.h"
 #include "app_uart.h"
 #include "PWM.h"
+#include "app_log.h"
+#include "app_ctrl.h"
 
 /*********************************************************************
  * MACROS
  */
 
+// 控制命令耗时统计，使用CH58X_BLEInit中启动的SysTick自由计数（单位：系统时钟周期）
+#ifdef DEBUG
+  #define BLE_CMD_CYCLE_BEGIN()    uint32_t ble_cmd_cycle_start = SYS_GetSysTickCnt()
+  #define BLE_CMD_CYCLE_END()      ble_cmd_cycle_update(SYS_GetSysTickCnt() - ble_cmd_cycle_start)
+#else
+  #define BLE_CMD_CYCLE_BEGIN()
+  #define BLE_CMD_CYCLE_END()
+#endif
+
 /*********************************************************************
  * CONSTANTS
  */
@@ -60,6 +71,20 @@
 // Company Identifier: WCH
 #define WCH_COMPANY_ID                       0x07D7
 
+// 连接建立后发起MTU交换和2M PHY切换的延时，100ms
+#define SBP_LINK_SETUP_DELAY                 160
+
+// 链路状态记录（FFF5），小端：
+// [版本][已连接][MTU 2B][TX PHY][RX PHY][连接间隔 2B][从机延迟 2B][超时 2B]
+#define PERIPHERAL_STATUS_VERSION            1
+#define PERIPHERAL_STATUS_LEN                12
+
+// 串口->蓝牙最多同时排队、尚未被对端确认的数据包数，留一个缓冲给控制应答
+#define PERIPHERAL_UART_TX_DEPTH             (BLE_BUFF_NUM - 1)
+
+// 吞吐测试模式的统计周期，1s
+#define PERIPHERAL_BENCH_PERIOD              1600
+
 /*********************************************************************
  * TYPEDEFS
  */
@@ -82,15 +107,6 @@ uint8_t Peripheral_TaskID = INVALID_TASK_ID; // Task ID for internal task/event
  * LOCAL VARIABLES
  */
 
-//for send to ble
-typedef enum
-{
-    SEND_TO_BLE_TO_SEND = 1,
-    SEND_TO_BLE_ALLOC_FAILED,
-    SEND_TO_BLE_SEND_FAILED,
-} send_to_ble_state_t;
-send_to_ble_state_t send_to_ble_state = SEND_TO_BLE_TO_SEND;
-
 blePaControlConfig_t pa_lna_ctl;
 
 //static uint8 Peripheral_TaskID = INVALID_TASK_ID;   // Task ID for internal task/event processing
@@ -138,6 +154,20 @@ static uint8 attDeviceName[GAP_DEVICE_NAME_LEN] = "ch583_ble_uart";
 // Connection item list
 static peripheralConnItem_t peripheralConnList;
 
+#ifdef DEBUG
+// 最近一次/最大一次控制命令处理耗时（系统时钟周期）
+static uint32_t ble_cmd_cycles_last = 0;
+static uint32_t ble_cmd_cycles_max = 0;
+#endif
+
+#if (APP_UART_BENCH)
+// 吞吐测试：发送的递增字节序列、统计周期起点及期间发送的字节数
+static uint8_t  peripheral_bench_pattern = 0;
+static uint32_t peripheral_bench_since = 0;
+static uint32_t peripheral_bench_bytes = 0;
+static uint32_t peripheral_bench_rx_bytes = 0;
+#endif
+
 /*********************************************************************
  * LOCAL FUNCTIONS
  */
@@ -148,6 +178,13 @@ static void peripheralParamUpdateCB(uint16 connHandle, uint16 connInterval,
                                     uint16 connSlaveLatency, uint16 connTimeout);
 static void peripheralInitConnItem(peripheralConnItem_t *peripheralConnList);
 static void peripheralRssiCB(uint16 connHandle, int8 rssi);
+static void peripheral_ctrl_ack_schedule(void);
+static void peripheral_ctrl_ack_send(void);
+static void peripheral_ctrl_write(const uint8_t *p_data, uint16_t length);
+static void peripheral_uart_pump(void);
+static void peripheral_uart_credit_send(void);
+static void peripheral_link_setup(void);
+static uint16_t peripheral_status_read(uint8_t *buf, uint16_t size);
 
 /*********************************************************************
  * PROFILE CALLBACKS
@@ -234,6 +271,11 @@ void Peripheral_Init()
     GATTServApp_AddService(GATT_ALL_SERVICES); // GATT attributes
     DevInfo_AddService();                      // Device Information Service
     ble_uart_add_service(on_bleuartServiceEvt);
+    ble_uart_diag_register(app_uart_diag_read);
+    ble_uart_status_register(peripheral_status_read);
+
+    // 作为GATT客户端主动发起MTU交换
+    GATT_InitClient();
 
     // Set the GAP Characteristics
     GGS_SetParameter(GGS_DEVICE_NAME_ATT, sizeof(attDeviceName), attDeviceName);
@@ -263,6 +305,8 @@ static void peripheralInitConnItem(peripheralConnItem_t *peripheralConnList)
     peripheralConnList->connInterval = 0;
     peripheralConnList->connSlaveLatency = 0;
     peripheralConnList->connTimeout = 0;
+    peripheralConnList->connTxPhy = GAP_PHY_VAL_LE_1M;
+    peripheralConnList->connRxPhy = GAP_PHY_VAL_LE_1M;
 }
 
 uint32_t get_fattime(void)
@@ -285,7 +329,6 @@ uint32_t get_fattime(void)
  */
 uint16 Peripheral_ProcessEvent(uint8 task_id, uint16 events)
 {
-    static attHandleValueNoti_t noti;
     //  VOID task_id; // TMOS required parameter that isn't used in this function
 
     if(events & SYS_EVENT_MSG)
@@ -328,116 +371,38 @@ uint16 Peripheral_ProcessEvent(uint8 task_id, uint16 events)
         return (events ^ SBP_PARAM_UPDATE_EVT);
     }
 
-    if(events & UART_TO_BLE_SEND_EVT)
+    if(events & SBP_LINK_SETUP_EVT)
     {
-        static uint16_t read_length = 0;
-        ;
-        uint8_t result = 0xff;
-        switch(send_to_ble_state)
-        {
-            case SEND_TO_BLE_TO_SEND:
-
-                //notify is not enabled
-                if(!ble_uart_notify_is_ready(peripheralConnList.connHandle))
-                {
-                    if(peripheralConnList.connHandle == GAP_CONNHANDLE_INIT)
-                    {
-                        //connection lost, flush rx fifo here
-                        app_drv_fifo_flush(&app_uart_rx_fifo);
-                    }
-                    break;
-                }
-                read_length = ATT_GetMTU(peripheralConnList.connHandle) - 3;
+        peripheral_link_setup();
+        return (events ^ SBP_LINK_SETUP_EVT);
+    }
 
-                if(app_drv_fifo_length(&app_uart_rx_fifo) >= read_length)
-                {
-                    PRINT("FIFO_LEN:%d\r\n", app_drv_fifo_length(&app_uart_rx_fifo));
-                    result = app_drv_fifo_read(&app_uart_rx_fifo, to_test_buffer, &read_length);
-                    uart_to_ble_send_evt_cnt = 0;
-                }
-                else
-                {
-                    if(uart_to_ble_send_evt_cnt > 10)
-                    {
-                        result = app_drv_fifo_read(&app_uart_rx_fifo, to_test_buffer, &read_length);
-                        uart_to_ble_send_evt_cnt = 0;
-                    }
-                    else
-                    {
-                        tmos_start_task(Peripheral_TaskID, UART_TO_BLE_SEND_EVT, 4);
-                        uart_to_ble_send_evt_cnt++;
-                        PRINT("NO TIME OUT\r\n");
-                    }
-                }
+    if(events & CTRL_ACK_EVT)
+    {
+        peripheral_ctrl_ack_send();
+        return (events ^ CTRL_ACK_EVT);
+    }
 
-                if(APP_DRV_FIFO_RESULT_SUCCESS == result)
-                {
-                    noti.len = read_length;
-                    noti.pValue = GATT_bm_alloc(peripheralConnList.connHandle, ATT_HANDLE_VALUE_NOTI, noti.len, NULL, 0);
-                    if(noti.pValue != NULL)
-                    {
-                        tmos_memcpy(noti.pValue, to_test_buffer, noti.len);
-                        result = ble_uart_notify(peripheralConnList.connHandle, &noti, 0);
-                        if(result != SUCCESS)
-                        {
-                            PRINT("R1:%02x\r\n", result);
-                            send_to_ble_state = SEND_TO_BLE_SEND_FAILED;
-                            GATT_bm_free((gattMsg_t *)&noti, ATT_HANDLE_VALUE_NOTI);
-                            tmos_start_task(Peripheral_TaskID, UART_TO_BLE_SEND_EVT, 2);
-                        }
-                        else
-                        {
-                            send_to_ble_state = SEND_TO_BLE_TO_SEND;
-                            //app_fifo_write(&app_uart_tx_fifo,to_test_buffer,&read_length);
-                            //app_drv_fifo_write(&app_uart_tx_fifo,to_test_buffer,&read_length);
-                            read_length = 0;
-                            tmos_start_task(Peripheral_TaskID, UART_TO_BLE_SEND_EVT, 2);
-                        }
-                    }
-                    else
-                    {
-                        send_to_ble_state = SEND_TO_BLE_ALLOC_FAILED;
-                        tmos_start_task(Peripheral_TaskID, UART_TO_BLE_SEND_EVT, 2);
-                    }
-                }
-                else
-                {
-                    //send_to_ble_state = SEND_TO_BLE_FIFO_EMPTY;
-                }
-                break;
-            case SEND_TO_BLE_ALLOC_FAILED:
-            case SEND_TO_BLE_SEND_FAILED:
+    if(events & UART_CREDIT_EVT)
+    {
+        peripheral_uart_credit_send();
+        return (events ^ UART_CREDIT_EVT);
+    }
 
-                noti.len = read_length;
-                noti.pValue = GATT_bm_alloc(peripheralConnList.connHandle, ATT_HANDLE_VALUE_NOTI, noti.len, NULL, 0);
-                if(noti.pValue != NULL)
-                {
-                    tmos_memcpy(noti.pValue, to_test_buffer, noti.len);
-                    result = ble_uart_notify(peripheralConnList.connHandle, &noti, 0);
-                    if(result != SUCCESS)
-                    {
-                        PRINT("R2:%02x\r\n", result);
-                        send_to_ble_state = SEND_TO_BLE_SEND_FAILED;
-                        GATT_bm_free((gattMsg_t *)&noti, ATT_HANDLE_VALUE_NOTI);
-                        tmos_start_task(Peripheral_TaskID, UART_TO_BLE_SEND_EVT, 2);
-                    }
-                    else
-                    {
-                        send_to_ble_state = SEND_TO_BLE_TO_SEND;
-                        //app_drv_fifo_write(&app_uart_tx_fifo,to_test_buffer,&read_length);
-                        read_length = 0;
-                        tmos_start_task(Peripheral_TaskID, UART_TO_BLE_SEND_EVT, 2);
-                    }
-                }
-                else
-                {
-                    send_to_ble_state = SEND_TO_BLE_ALLOC_FAILED;
-                    tmos_start_task(Peripheral_TaskID, UART_TO_BLE_SEND_EVT, 2);
-                }
-                break;
-            default:
-                break;
+    if(events & UART_TO_BLE_SEND_EVT)
+    {
+        //notify is not enabled
+        if(!ble_uart_notify_is_ready(peripheralConnList.connHandle))
+        {
+            if(peripheralConnList.connHandle == GAP_CONNHANDLE_INIT)
+            {
+                //connection lost, flush rx fifo here
+                app_uart_rx_discard();
+            }
+            return (events ^ UART_TO_BLE_SEND_EVT);
         }
+
+        peripheral_uart_pump();
         return (events ^ UART_TO_BLE_SEND_EVT);
     }
     // Discard unknown events
@@ -457,6 +422,33 @@ static void Peripheral_ProcessTMOSMsg(tmos_event_hdr_t *pMsg)
 {
     switch(pMsg->event)
     {
+        case GAP_MSG_EVENT:
+        {
+            gapRoleEvent_t *pEvent = (gapRoleEvent_t *)pMsg;
+
+            if((pEvent->gap.opcode == GAP_PHY_UPDATE_EVENT) &&
+               (pEvent->linkPhyUpdate.connectionHandle == peripheralConnList.connHandle))
+            {
+                peripheralConnList.connTxPhy = pEvent->linkPhyUpdate.connTxPHYS;
+                peripheralConnList.connRxPhy = pEvent->linkPhyUpdate.connRxPHYS;
+                PRINT("Phy update Rx:%x Tx:%x\n", pEvent->linkPhyUpdate.connRxPHYS, pEvent->linkPhyUpdate.connTxPHYS);
+            }
+            break;
+        }
+
+        case GATT_MSG_EVENT:
+        {
+            gattMsgEvent_t *pMsgEvent = (gattMsgEvent_t *)pMsg;
+
+            if(pMsgEvent->method == ATT_MTU_UPDATED_EVENT)
+            {
+                // 串口透传和应答发送时按 ATT_GetMTU()-3 取包长，无需另外保存
+                PRINT("MTU exchange: %d\n", pMsgEvent->msg.mtuEvt.MTU);
+            }
+            GATT_bm_free(&pMsgEvent->msg, pMsgEvent->method);
+            break;
+        }
+
         default:
             break;
     }
@@ -488,9 +480,15 @@ static void Peripheral_LinkEstablished(gapRoleEvent_t *pEvent)
         peripheralConnList.connSlaveLatency = event->connLatency;
         peripheralConnList.connTimeout = event->connTimeout;
 
+        peripheralConnList.connTxPhy = GAP_PHY_VAL_LE_1M;
+        peripheralConnList.connRxPhy = GAP_PHY_VAL_LE_1M;
+
         // Set timer for param update event
         tmos_start_task(Peripheral_TaskID, SBP_PARAM_UPDATE_EVT, SBP_PARAM_UPDATE_DELAY);
 
+        // 稍后协商MTU和PHY，先让主机完成服务发现等初始流程
+        tmos_start_task(Peripheral_TaskID, SBP_LINK_SETUP_EVT, SBP_LINK_SETUP_DELAY);
+
         PRINT("Conn %x - Int %x \n", event->connectionHandle, event->connInterval);
     }
 }
@@ -514,6 +512,16 @@ static void Peripheral_LinkTerminated(gapRoleEvent_t *pEvent)
         peripheralConnList.connInterval = 0;
         peripheralConnList.connSlaveLatency = 0;
         peripheralConnList.connTimeout = 0;
+        peripheralConnList.connTxPhy = GAP_PHY_VAL_LE_1M;
+        peripheralConnList.connRxPhy = GAP_PHY_VAL_LE_1M;
+        tmos_stop_task(Peripheral_TaskID, SBP_LINK_SETUP_EVT);
+
+        // 旧连接的应答不再发送
+        tmos_stop_task(Peripheral_TaskID, CTRL_ACK_EVT);
+        app_ctrl_ack_flush();
+
+        // 流控额度随连接重新开始，新连接在达到高水位时重新收到额度
+        app_uart_tx_credit_reset();
 
         // Restart advertising
         {
@@ -644,14 +652,351 @@ static void peripheralStateNotificationCB(gapRole_States_t newState, gapRoleEven
     }
 }
 
+/*********************************************************************
+ * @fn      peripheral_link_setup
+ *
+ * @brief   连接建立后协商大MTU和2M PHY
+ *          MTU上限为 BLE_BUFF_MAX_LEN-4，主机已发起过交换时不再重复；
+ *          LL数据长度扩展由协议栈按 BLE_BUFF_MAX_LEN 自动协商
+ *
+ * @return  none
+ */
+static void peripheral_link_setup(void)
+{
+    uint16_t conn = peripheralConnList.connHandle;
+
+    if(conn == GAP_CONNHANDLE_INIT)
+    {
+        return;
+    }
+    if(ATT_GetMTU(conn) < (BLE_BUFF_MAX_LEN - 4))
+    {
+        attExchangeMTUReq_t req;
+
+        req.clientRxMTU = BLE_BUFF_MAX_LEN - 4;
+        if(GATT_ExchangeMTU(conn, &req, Peripheral_TaskID) != SUCCESS)
+        {
+            PRINT("MTU exchange not sent\n");
+        }
+    }
+    if(peripheralConnList.connTxPhy != GAP_PHY_VAL_LE_2M)
+    {
+        GAPRole_UpdatePHY(conn, 0, GAP_PHY_BIT_LE_2M, GAP_PHY_BIT_LE_2M, 0);
+    }
+}
+
+/*********************************************************************
+ * @fn      peripheral_status_read
+ *
+ * @brief   生成链路状态记录（FFF5），格式见PERIPHERAL_STATUS_LEN
+ *
+ * @return  记录长度，缓冲区不足时返回0
+ */
+static uint16_t peripheral_status_read(uint8_t *buf, uint16_t size)
+{
+    uint16_t conn = peripheralConnList.connHandle;
+    uint16_t mtu = (conn == GAP_CONNHANDLE_INIT) ? ATT_MTU_SIZE : ATT_GetMTU(conn);
+
+    if(size < PERIPHERAL_STATUS_LEN)
+    {
+        return 0;
+    }
+    buf[0] = PERIPHERAL_STATUS_VERSION;
+    buf[1] = (conn != GAP_CONNHANDLE_INIT);
+    buf[2] = LO_UINT16(mtu);
+    buf[3] = HI_UINT16(mtu);
+    buf[4] = peripheralConnList.connTxPhy;
+    buf[5] = peripheralConnList.connRxPhy;
+    buf[6] = LO_UINT16(peripheralConnList.connInterval);
+    buf[7] = HI_UINT16(peripheralConnList.connInterval);
+    buf[8] = LO_UINT16(peripheralConnList.connSlaveLatency);
+    buf[9] = HI_UINT16(peripheralConnList.connSlaveLatency);
+    buf[10] = LO_UINT16(peripheralConnList.connTimeout);
+    buf[11] = HI_UINT16(peripheralConnList.connTimeout);
+    return PERIPHERAL_STATUS_LEN;
+}
+
+#if (APP_UART_BENCH)
+/*********************************************************************
+ * @fn      peripheral_bench_fill
+ *
+ * @brief   吞吐测试：用递增字节填充一包数据，接收端可据此检查丢包
+ *
+ * @return  none
+ */
+static void peripheral_bench_fill(uint8_t *p, uint16_t length)
+{
+    while(length--)
+    {
+        *p++ = peripheral_bench_pattern++;
+    }
+}
+
+/*********************************************************************
+ * @fn      peripheral_bench_sent
+ *
+ * @brief   吞吐测试：累计发送字节数，每秒通过调试串口输出一次KB/s
+ *
+ * @return  none
+ */
+static void peripheral_bench_sent(uint16_t length)
+{
+    uint32_t now = TMOS_GetSystemClock();
+    uint32_t ticks = now - peripheral_bench_since;
+
+    peripheral_bench_bytes += length;
+    if(ticks >= PERIPHERAL_BENCH_PERIOD)
+    {
+        // bytes / (ticks * 625us) / 1024，保留两位小数
+        uint32_t rate = (uint32_t)((uint64_t)peripheral_bench_bytes * 160000 / 1024 / ticks);
+
+        // 同时统计蓝牙->串口方向接收的透传数据
+        uint32_t rx_rate = (uint32_t)((uint64_t)peripheral_bench_rx_bytes * 160000 / 1024 / ticks);
+
+        PRINT("[BENCH] tx %lu.%02lu KB/s, rx %lu.%02lu KB/s\n", rate / 100, rate % 100, rx_rate / 100, rx_rate % 100);
+        peripheral_bench_since = now;
+        peripheral_bench_bytes = 0;
+        peripheral_bench_rx_bytes = 0;
+    }
+}
+#endif
+
+/*********************************************************************
+ * @fn      peripheral_uart_pump
+ *
+ * @brief   串口->蓝牙发送：在控制器缓冲允许的范围内一次排队多条通知，
+ *          同一连接事件内即可发出多包（BLE_TX_NUM_EVENT）
+ *          - 无数据或未到发送时机时按串口模块给出的截止时间定时，FIFO为空则不再唤醒
+ *          - 未确认包数达到PERIPHERAL_UART_TX_DEPTH或缓冲申请失败时，一个连接间隔后再补充
+ *
+ * @return  none
+ */
+static void peripheral_uart_pump(void)
+{
+    attHandleValueNoti_t noti;
+    uint16_t             conn = peripheralConnList.connHandle;
+    uint16_t             payload = ATT_GetMTU(conn) - 3;
+    uint16_t             delay;
+    uint32_t             wait;
+
+    while(LL_GetNumberOfUnAckPacket(conn) < PERIPHERAL_UART_TX_DEPTH)
+    {
+#if (APP_UART_BENCH)
+        noti.len = payload;
+        (void)wait;
+#else
+        noti.len = app_uart_rx_flush_len(payload, &wait);
+        if(noti.len == 0)
+        {
+            if(wait)
+            {
+                tmos_start_task(Peripheral_TaskID, UART_TO_BLE_SEND_EVT, wait);
+            }
+            return;
+        }
+#endif
+        // 从环形缓冲区直接拷贝到GATT缓冲，通知排队成功后数据才离开FIFO
+        noti.pValue = GATT_bm_alloc(conn, ATT_HANDLE_VALUE_NOTI, noti.len, NULL, 0);
+        if(noti.pValue == NULL)
+        {
+            break;
+        }
+#if (APP_UART_BENCH)
+        peripheral_bench_fill(noti.pValue, noti.len);
+#else
+        app_drv_fifo_peek(&app_uart_rx_fifo, noti.pValue, noti.len);
+#endif
+        if(ble_uart_notify(conn, &noti, 0) != SUCCESS)
+        {
+            GATT_bm_free((gattMsg_t *)&noti, ATT_HANDLE_VALUE_NOTI);
+            break;
+        }
+#if (APP_UART_BENCH)
+        peripheral_bench_sent(noti.len);
+#else
+        app_uart_rx_flushed(noti.len);
+#endif
+    }
+
+    // 缓冲已满，等已发出的包被确认后再补充：连接间隔单位为1.25ms，TMOS定时单位为625us
+    delay = peripheralConnList.connInterval * 2;
+    if(delay < 2)
+    {
+        delay = 2;
+    }
+    tmos_start_task(Peripheral_TaskID, UART_TO_BLE_SEND_EVT, delay);
+}
+
+/*********************************************************************
+ * @fn      peripheral_uart_credit_send
+ *
+ * @brief   通过控制特征值(FFF3)通知当前流控额度（串口发送FIFO剩余字节）
+ *          额度帧不会混入FFF1的透传数据，未订阅FFF3的上位机不参与流控
+ *          发送失败时稍后重试，重试时取最新的剩余字节数
+ *
+ * @return  none
+ */
+static void peripheral_uart_credit_send(void)
+{
+    attHandleValueNoti_t noti;
+    uint16_t             conn = peripheralConnList.connHandle;
+
+    if((conn == GAP_CONNHANDLE_INIT) || !ble_uart_ctrl_notify_is_ready(conn))
+    {
+        return;
+    }
+    noti.pValue = GATT_bm_alloc(conn, ATT_HANDLE_VALUE_NOTI, APP_CTRL_HDR_LEN + APP_CTRL_TLV_HDR_LEN + 2, NULL, 0);
+    if(noti.pValue != NULL)
+    {
+        noti.len = app_ctrl_credit_build(noti.pValue, APP_CTRL_HDR_LEN + APP_CTRL_TLV_HDR_LEN + 2, app_uart_tx_room());
+        if(ble_uart_ctrl_notify(conn, &noti) == SUCCESS)
+        {
+            return;
+        }
+        GATT_bm_free((gattMsg_t *)&noti, ATT_HANDLE_VALUE_NOTI);
+    }
+    tmos_start_task(Peripheral_TaskID, UART_CREDIT_EVT, 2);
+}
+
+/*********************************************************************
+ * @fn      peripheral_ctrl_ack_schedule
+ *
+ * @brief   有待发送应答时启动CTRL_ACK_EVT
+ *          延时取半个连接间隔（connInterval单位1.25ms，正好是625us tick数的一半），
+ *          同一连接事件内收到的多个写入的应答会合并，并在下一个连接事件发出
+ *
+ * @return  none
+ */
+static void peripheral_ctrl_ack_schedule(void)
+{
+    uint16_t delay = peripheralConnList.connInterval;
+
+    if((app_ctrl_ack_pending() == 0) || tmos_get_task_timer(Peripheral_TaskID, CTRL_ACK_EVT))
+    {
+        return;
+    }
+    if(delay < 2)
+    {
+        delay = 2;
+    }
+    tmos_start_task(Peripheral_TaskID, CTRL_ACK_EVT, delay);
+}
+
+/*********************************************************************
+ * @fn      peripheral_ctrl_ack_send
+ *
+ * @brief   把待发送应答组成一条TX通知发出，MTU放不下的部分随后再发
+ *          发送失败时应答保留，稍后重试
+ *
+ * @return  none
+ */
+static void peripheral_ctrl_ack_send(void)
+{
+    attHandleValueNoti_t noti;
+    uint16_t             size;
+    uint8_t              on_ctrl = ble_uart_ctrl_notify_is_ready(peripheralConnList.connHandle);
+    bStatus_t            result;
+
+    // 优先从控制特征值(FFF3)发送，未订阅时退回到TX特征值(FFF1)
+    if(!on_ctrl && !ble_uart_notify_is_ready(peripheralConnList.connHandle))
+    {
+        // 未订阅通知或已断开，应答无处可发
+        app_ctrl_ack_flush();
+        return;
+    }
+
+    size = ATT_GetMTU(peripheralConnList.connHandle) - 3;
+    noti.pValue = GATT_bm_alloc(peripheralConnList.connHandle, ATT_HANDLE_VALUE_NOTI, size, NULL, 0);
+    if(noti.pValue == NULL)
+    {
+        tmos_start_task(Peripheral_TaskID, CTRL_ACK_EVT, 2);
+        return;
+    }
+
+    noti.len = app_ctrl_ack_build(noti.pValue, size);
+    if(noti.len == 0)
+    {
+        GATT_bm_free((gattMsg_t *)&noti, ATT_HANDLE_VALUE_NOTI);
+        return;
+    }
+
+    result = on_ctrl ? ble_uart_ctrl_notify(peripheralConnList.connHandle, &noti)
+                     : ble_uart_notify(peripheralConnList.connHandle, &noti, 0);
+    if(result != SUCCESS)
+    {
+        GATT_bm_free((gattMsg_t *)&noti, ATT_HANDLE_VALUE_NOTI);
+        tmos_start_task(Peripheral_TaskID, CTRL_ACK_EVT, 2);
+        return;
+    }
+
+    app_ctrl_ack_release(noti.len);
+    if(app_ctrl_ack_pending())
+    {
+        tmos_start_task(Peripheral_TaskID, CTRL_ACK_EVT, 2);
+    }
+}
+
+#ifdef DEBUG
+/*********************************************************************
+ * @fn      ble_cmd_cycle_update
+ *
+ * @brief   记录一次控制命令的处理耗时并输出
+ *
+ * @param   cycles - 本次命令消耗的系统时钟周期数
+ *
+ * @return  none
+ */
+static void ble_cmd_cycle_update(uint32_t cycles)
+{
+    ble_cmd_cycles_last = cycles;
+    if(cycles > ble_cmd_cycles_max)
+    {
+        ble_cmd_cycles_max = cycles;
+    }
+    APP_LOG2(APP_LOG_BLE_CMD_COST, ble_cmd_cycles_last, ble_cmd_cycles_max);
+}
+#endif
+
+/*********************************************************************
+ * @fn      peripheral_ble_write
+ *
+ * @brief   处理一次FFF2/FFF3写入，控制命令执行后为带序号的帧安排应答
+ *
+ * @param   char_id - APP_CTRL_CHAR_RX 或 APP_CTRL_CHAR_CTRL
+ * @param   p_data  - 写入的数据
+ * @param   length  - 数据长度
+ *
+ * @return  none
+ */
+static void peripheral_ble_write(uint8_t char_id, const uint8_t *p_data, uint16_t length)
+{
+    BLE_CMD_CYCLE_BEGIN();
+
+    // 旧的2/4字节格式和 0xA5 帧格式的批量命令统一由 app_ctrl 解析执行，其余写入透传到串口
+    if(app_ctrl_dispatch(char_id, p_data, length) != APP_CTRL_PASSTHROUGH)
+    {
+        // 带序号的帧产生应答，延后合并为一条通知发送
+        peripheral_ctrl_ack_schedule();
+        BLE_CMD_CYCLE_END();
+    }
+#if (APP_UART_BENCH)
+    else
+    {
+        peripheral_bench_rx_bytes += length;
+    }
+#endif
+}
+
 /*********************************************************************
  * @fn      on_bleuartServiceEvt
  *
  * @brief   蓝牙串口服务事件回调函数
  *          接收蓝牙数据并控制PWM输出
- *          数据格式：2个字节
- *          - 第1个字节：总占空比 (0-100)
- *          - 第2个字节：PWM4占总占空比的百分比 (0-100)
+ *          - 控制特征值(FFF3)：全部按控制协议解析
+ *          - RX特征值(FFF2)：串口透传；APP_CTRL_LEGACY_ON_RX为1（默认）时2/4字节写入按旧格式命令处理
+ *          数据格式见 app_ctrl.h：
+ *          - 旧格式2个或4个字节：总占空比、PWM4百分比、（可选）小端渐变时长ms
+ *          - 帧格式：[0xA5][版本][TLV]...，一次写入可携带多条命令
  *
  * @param   connection_handle - 连接句柄
  * @param   p_evt - 事件指针
@@ -668,68 +1013,21 @@ void on_bleuartServiceEvt(uint16 connection_handle, ble_uart_evt_t *p_evt)
 
         case BLE_UART_EVT_TX_NOTI_ENABLED:
             PRINT("BLE UART TX notification enabled\n");
+#if (APP_UART_BENCH)
+            peripheral_bench_since = TMOS_GetSystemClock();
+            peripheral_bench_bytes = 0;
+            peripheral_bench_rx_bytes = 0;
+#endif
             tmos_start_task(Peripheral_TaskID, UART_TO_BLE_SEND_EVT, 200);
             break;
 
+        case BLE_UART_EVT_CTRL_DATA_RECIEVED:
+            peripheral_ble_write(APP_CTRL_CHAR_CTRL, p_evt->data.p_data, p_evt->data.length);
+            break;
+
         case BLE_UART_EVT_BLE_DATA_RECIEVED:
-        {
-            PRINT("BLE Data Received: len=%d\n", p_evt->data.length);
-            
-            // 检查数据长度是否为2字节
-            if(p_evt->data.length == 2)
-            {
-                uint8_t total_duty = p_evt->data.p_data[0];  // 总占空比 (0-100)
-                uint8_t pwm4_ratio = p_evt->data.p_data[1];  // PWM4占总占空比的百分比 (0-100)
-                
-                // 限制范围
-                if(total_duty > 100) total_duty = 100;
-                if(pwm4_ratio > 100) pwm4_ratio = 100;
-                
-                // 计算PWM4和PWM5的实际占空比
-                // PWM4 = total_duty * pwm4_ratio / 100
-                // PWM5 = total_duty - PWM4
-                uint8_t pwm4_duty = (total_duty * pwm4_ratio) / 100;
-                uint8_t pwm5_duty = total_duty - pwm4_duty;
-                
-                PRINT("[BLE PWM] Total=%d%%, PWM4_ratio=%d%%\n", total_duty, pwm4_ratio);
-                PRINT("[BLE PWM] PWM4=%d%%, PWM5=%d%%\n", pwm4_duty, pwm5_duty);
-                
-                // 计算balance值
-                // balance = (PWM4 - PWM5) * 100 / total_duty
-                // 当total_duty=0时，balance=0
-                int8_t balance = 0;
-                if(total_duty > 0)
-                {
-                    // balance范围：-100到+100
-                    // PWM4=total, PWM5=0 -> balance=+100
-                    // PWM4=0, PWM5=total -> balance=-100
-                    // PWM4=PWM5 -> balance=0
-                    int16_t diff = (int16_t)pwm4_duty - (int16_t)pwm5_duty;
-                    balance = (diff * 100) / total_duty;
-                    
-                    // 限制范围
-                    if(balance > 100) balance = 100;
-                    if(balance < -100) balance = -100;
-                }
-                
-                PRINT("[BLE PWM] Calculated balance=%d\n", balance);
-                
-                // 设置PWM输出
-                PWM_SetDutyAndBalance(total_duty, balance);
-                
-                // 回显确认信息（可选）
-                // 可以通过蓝牙发送确认消息回手机端
-            }
-            else
-            {
-                PRINT("[BLE PWM] Error: Invalid data length (expected 2, got %d)\n", p_evt->data.length);
-            }
-            
-            // 将接收到的数据写入FIFO（原有功能保留）
-            uint16_t write_length = p_evt->data.length;
-            app_drv_fifo_write(&app_uart_rx_fifo, (uint8_t *)p_evt->data.p_data, &write_length);
+            peripheral_ble_write(APP_CTRL_CHAR_RX, p_evt->data.p_data, p_evt->data.length);
             break;
-        }
 
         default:
             break;
@@ -12,12 +12,71 @@
 
 #include "app_drv_fifo.h"
 
+//word type allowed to alias the byte buffers
+typedef uint32_t __attribute__((__may_alias__)) fifo_word_t;
+
+/*
+ * Orders buffer accesses against index updates. The producer publishes
+ * `end` only after the data is stored, the consumer reads the data only
+ * after loading `end` and releases the room by storing `begin` last.
+ */
+#define FIFO_BARRIER()    __sync_synchronize()
+
 static __inline uint16_t fifo_length(app_drv_fifo_t *fifo)
 {
     uint16_t tmp = fifo->begin;
     return fifo->end - tmp;
 }
 
+//producer: track the deepest fill level once new bytes are published
+static __inline void fifo_note_level(app_drv_fifo_t *fifo, uint16_t length)
+{
+    if(length > fifo->stats.high_water)
+    {
+        fifo->stats.high_water = length;
+    }
+}
+
+/*
+ * Copy one contiguous span. When source and destination share the same
+ * alignment the bulk is moved as 32-bit words (four per loop), otherwise
+ * byte by byte so no unaligned word access is ever made.
+ */
+static void fifo_span_copy(uint8_t *dst, const uint8_t *src, uint16_t len)
+{
+    if(((((uintptr_t)dst) ^ ((uintptr_t)src)) & 3) == 0)
+    {
+        while((((uintptr_t)dst) & 3) && len)
+        {
+            *dst++ = *src++;
+            len--;
+        }
+        fifo_word_t       *wd = (fifo_word_t *)dst;
+        const fifo_word_t *ws = (const fifo_word_t *)src;
+        while(len >= 16)
+        {
+            wd[0] = ws[0];
+            wd[1] = ws[1];
+            wd[2] = ws[2];
+            wd[3] = ws[3];
+            wd += 4;
+            ws += 4;
+            len -= 16;
+        }
+        while(len >= 4)
+        {
+            *wd++ = *ws++;
+            len -= 4;
+        }
+        dst = (uint8_t *)wd;
+        src = (const uint8_t *)ws;
+    }
+    while(len--)
+    {
+        *dst++ = *src++;
+    }
+}
+
 uint16_t app_drv_fifo_length(app_drv_fifo_t *fifo)
 {
     return fifo_length(fifo);
@@ -39,26 +98,41 @@ app_drv_fifo_init(app_drv_fifo_t *fifo, uint8_t *buffer, uint16_t buffer_size)
     fifo->data = buffer;
     fifo->size = buffer_size;
     fifo->size_mask = buffer_size - 1;
+    fifo->stats.dropped = 0;
+    fifo->stats.overflows = 0;
+    fifo->stats.high_water = 0;
     return APP_DRV_FIFO_RESULT_SUCCESS;
 }
 
+//producer
 void app_drv_fifo_push(app_drv_fifo_t *fifo, uint8_t data)
 {
-    fifo->data[fifo->end & fifo->size_mask] = data;
-    fifo->end++;
+    uint16_t end = fifo->end;
+
+    fifo->data[end & fifo->size_mask] = data;
+    FIFO_BARRIER();
+    fifo->end = end + 1;
+    fifo_note_level(fifo, end + 1 - fifo->begin);
 }
 
+//consumer
 uint8_t app_drv_fifo_pop(app_drv_fifo_t *fifo)
 {
-    uint8_t data = fifo->data[fifo->begin & fifo->size_mask];
-    fifo->begin++;
+    uint16_t begin = fifo->begin;
+    uint8_t  data;
+
+    FIFO_BARRIER();
+    data = fifo->data[begin & fifo->size_mask];
+    FIFO_BARRIER();
+    fifo->begin = begin + 1;
     return data;
 }
 
+//consumer: drop everything stored so far, the producer may keep writing
 void app_drv_fifo_flush(app_drv_fifo_t *fifo)
 {
-    fifo->begin = 0;
-    fifo->end = 0;
+    FIFO_BARRIER();
+    fifo->begin = fifo->end;
 }
 
 bool app_drv_fifo_is_empty(app_drv_fifo_t *fifo)
@@ -71,6 +145,7 @@ bool app_drv_fifo_is_full(app_drv_fifo_t *fifo)
     return (fifo_length(fifo) == fifo->size);
 }
 
+//producer
 app_drv_fifo_result_t
 app_drv_fifo_write(app_drv_fifo_t *fifo, uint8_t *data, uint16_t *p_write_length)
 {
@@ -83,9 +158,11 @@ app_drv_fifo_write(app_drv_fifo_t *fifo, uint8_t *data, uint16_t *p_write_length
         return APP_DRV_FIFO_RESULT_NULL;
     }
     //PRINT("fifo_length = %d\r\n",fifo_length(fifo));
-    const uint16_t available_count = fifo->size - fifo_length(fifo);
+    const uint16_t end = fifo->end;
+    const uint16_t available_count = fifo->size - (uint16_t)(end - fifo->begin);
     const uint16_t requested_len = (*p_write_length);
     uint16_t       index = 0;
+    uint16_t       first;
     uint16_t       write_size = MIN(requested_len, available_count);
     //PRINT("available_count %d\r\n",available_count);
     // Check if the FIFO is FULL.
@@ -100,16 +177,19 @@ app_drv_fifo_write(app_drv_fifo_t *fifo, uint8_t *data, uint16_t *p_write_length
         return APP_DRV_FIFO_RESULT_SUCCESS;
     }
 
-    for(index = 0; index < write_size; index++)
-    {
-        //push
-        fifo->data[fifo->end & fifo->size_mask] = data[index];
-        fifo->end++;
-    }
+    //at most two spans: up to the end of the buffer, then from its start
+    index = end & fifo->size_mask;
+    first = MIN(write_size, fifo->size - index);
+    fifo_span_copy(&fifo->data[index], data, first);
+    fifo_span_copy(fifo->data, &data[first], write_size - first);
+    FIFO_BARRIER();
+    fifo->end = end + write_size;
+    fifo_note_level(fifo, fifo->size - available_count + write_size);
     (*p_write_length) = write_size;
     return APP_DRV_FIFO_RESULT_SUCCESS;
 }
 
+//producer
 app_drv_fifo_result_t
 app_drv_fifo_write_from_same_addr(app_drv_fifo_t *fifo, uint8_t *data, uint16_t write_length)
 {
@@ -117,7 +197,8 @@ app_drv_fifo_write_from_same_addr(app_drv_fifo_t *fifo, uint8_t *data, uint16_t
     {
         return APP_DRV_FIFO_RESULT_NULL;
     }
-    const uint16_t available_count = fifo->size_mask - fifo_length(fifo) + 1;
+    const uint16_t end = fifo->end;
+    const uint16_t available_count = fifo->size - (uint16_t)(end - fifo->begin);
     const uint16_t requested_len = (write_length);
     uint16_t       index = 0;
     uint16_t       write_size = MIN(requested_len, available_count);
@@ -128,15 +209,20 @@ app_drv_fifo_write_from_same_addr(app_drv_fifo_t *fifo, uint8_t *data, uint16_t
         return APP_DRV_FIFO_RESULT_NOT_MEM;
     }
 
+    uint16_t pos = end & fifo->size_mask;
     for(index = 0; index < write_size; index++)
     {
         //push
-        fifo->data[fifo->end & fifo->size_mask] = data[0];
-        fifo->end++;
+        fifo->data[pos] = data[0];
+        pos = (pos + 1) & fifo->size_mask;
     }
+    FIFO_BARRIER();
+    fifo->end = end + write_size;
+    fifo_note_level(fifo, fifo->size - available_count + write_size);
     return APP_DRV_FIFO_RESULT_SUCCESS;
 }
 
+//consumer
 app_drv_fifo_result_t
 app_drv_fifo_read(app_drv_fifo_t *fifo, uint8_t *data, uint16_t *p_read_length)
 {
@@ -148,27 +234,32 @@ app_drv_fifo_read(app_drv_fifo_t *fifo, uint8_t *data, uint16_t *p_read_length)
     {
         return APP_DRV_FIFO_RESULT_NULL;
     }
-    const uint16_t byte_count = fifo_length(fifo);
+    const uint16_t begin = fifo->begin;
+    const uint16_t byte_count = fifo->end - begin;
     const uint16_t requested_len = (*p_read_length);
-    uint32_t       index = 0;
-    uint32_t       read_size = MIN(requested_len, byte_count);
+    uint16_t       index = 0;
+    uint16_t       first;
+    uint16_t       read_size = MIN(requested_len, byte_count);
 
     if(byte_count == 0)
     {
         return APP_DRV_FIFO_RESULT_NOT_FOUND;
     }
     //PRINT("read size = %d,byte_count = %d\r\n",read_size,byte_count);
-    for(index = 0; index < read_size; index++)
-    {
-        //pop
-        data[index] = fifo->data[fifo->begin & fifo->size_mask];
-        fifo->begin++;
-    }
+    FIFO_BARRIER();
+    //at most two spans: up to the end of the buffer, then from its start
+    index = begin & fifo->size_mask;
+    first = MIN(read_size, fifo->size - index);
+    fifo_span_copy(data, &fifo->data[index], first);
+    fifo_span_copy(&data[first], fifo->data, read_size - first);
+    FIFO_BARRIER();
+    fifo->begin = begin + read_size;
 
     (*p_read_length) = read_size;
     return APP_DRV_FIFO_RESULT_SUCCESS;
 }
 
+//consumer
 app_drv_fifo_result_t
 app_drv_fifo_read_to_same_addr(app_drv_fifo_t *fifo, uint8_t *data, uint16_t read_length)
 {
@@ -176,16 +267,105 @@ app_drv_fifo_read_to_same_addr(app_drv_fifo_t *fifo, uint8_t *data, uint16_t rea
     {
         return APP_DRV_FIFO_RESULT_NULL;
     }
-    const uint16_t byte_count = fifo_length(fifo);
+    const uint16_t begin = fifo->begin;
+    const uint16_t byte_count = fifo->end - begin;
     const uint16_t requested_len = (read_length);
     uint32_t       index = 0;
     uint32_t       read_size = MIN(requested_len, byte_count);
 
+    FIFO_BARRIER();
+    uint16_t pos = begin & fifo->size_mask;
     for(index = 0; index < read_size; index++)
     {
         //pop
-        data[0] = fifo->data[fifo->begin & fifo->size_mask];
-        fifo->begin++;
+        data[0] = fifo->data[pos];
+        pos = (pos + 1) & fifo->size_mask;
     }
+    FIFO_BARRIER();
+    fifo->begin = begin + read_size;
     return APP_DRV_FIFO_RESULT_SUCCESS;
 }
+
+//consumer
+uint16_t app_drv_fifo_peek(app_drv_fifo_t *fifo, uint8_t *data, uint16_t length)
+{
+    const uint16_t begin = fifo->begin;
+    uint16_t       index = begin & fifo->size_mask;
+    uint16_t       first;
+
+    length = MIN(length, (uint16_t)(fifo->end - begin));
+    FIFO_BARRIER();
+    first = MIN(length, fifo->size - index);
+    fifo_span_copy(data, &fifo->data[index], first);
+    fifo_span_copy(&data[first], fifo->data, length - first);
+    return length;
+}
+
+//consumer
+uint16_t app_drv_fifo_peek_span(app_drv_fifo_t *fifo, uint16_t offset, uint8_t **p_span)
+{
+    const uint16_t begin = fifo->begin;
+    const uint16_t byte_count = fifo->end - begin;
+    uint16_t       index;
+
+    if(offset >= byte_count)
+    {
+        return 0;
+    }
+    FIFO_BARRIER();
+    index = (begin + offset) & fifo->size_mask;
+    *p_span = &fifo->data[index];
+    return MIN(byte_count - offset, fifo->size - index);
+}
+
+//consumer
+void app_drv_fifo_consume(app_drv_fifo_t *fifo, uint16_t length)
+{
+    const uint16_t begin = fifo->begin;
+
+    length = MIN(length, (uint16_t)(fifo->end - begin));
+    FIFO_BARRIER();
+    fifo->begin = begin + length;
+}
+
+//producer
+uint16_t app_drv_fifo_reserve_span(app_drv_fifo_t *fifo, uint8_t **p_span)
+{
+    const uint16_t end = fifo->end;
+    uint16_t       index = end & fifo->size_mask;
+    uint16_t       available_count = fifo->size - (uint16_t)(end - fifo->begin);
+
+    //room released by the consumer must not be overwritten before its reads are done
+    FIFO_BARRIER();
+    *p_span = &fifo->data[index];
+    return MIN(available_count, fifo->size - index);
+}
+
+//producer
+void app_drv_fifo_commit(app_drv_fifo_t *fifo, uint16_t length)
+{
+    const uint16_t end = fifo->end;
+    const uint16_t used = end - fifo->begin;
+
+    length = MIN(length, fifo->size - used);
+    FIFO_BARRIER();
+    fifo->end = end + length;
+    fifo_note_level(fifo, used + length);
+}
+
+//producer
+void app_drv_fifo_drop(app_drv_fifo_t *fifo, uint16_t length)
+{
+    fifo->stats.dropped += length;
+    if(fifo->stats.overflows != 0xFFFF)
+    {
+        fifo->stats.overflows++;
+    }
+}
+
+void app_drv_fifo_get_stats(app_drv_fifo_t *fifo, app_drv_fifo_stats_t *p_stats)
+{
+    p_stats->dropped = fifo->stats.dropped;
+    p_stats->overflows = fifo->stats.overflows;
+    p_stats->high_water = fifo->stats.high_water;
+}
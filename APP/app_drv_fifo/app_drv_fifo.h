@@ -50,16 +50,34 @@ typedef enum
   #define NULL    0
 #endif
 
+/*!
+ * FIFO statistics, written by the producer only
+ */
+typedef struct
+{
+    uint32_t dropped;     //bytes the producer could not store
+    uint16_t overflows;   //number of times bytes were dropped
+    uint16_t high_water;  //highest length seen after a write
+} app_drv_fifo_stats_t;
+
 /*!
  * FIFO structure
+ *
+ * Single producer / single consumer, lock free: one context (e.g. an ISR)
+ * only writes (push, write*, reserve_span/commit) and only stores `end`,
+ * the other only reads (pop, read*, peek*, consume, flush) and only stores
+ * `begin`. Each side loads the other's index once per call and publishes
+ * its own index after a barrier, so no interrupt masking is needed.
+ * Calls from a third context, or two producers, still need a lock.
  */
 typedef struct Fifo_s
 {
-    uint16_t begin;
-    uint16_t end;
+    volatile uint16_t begin;  //consumer owned
+    volatile uint16_t end;    //producer owned
     uint8_t *data;
     uint16_t size;
     uint16_t size_mask;
+    app_drv_fifo_stats_t stats; //producer owned
 } app_drv_fifo_t;
 
 //__inline uint16_t app_drv_fifo_length(app_drv_fifo_t *fifo);
@@ -93,7 +111,8 @@ void app_drv_fifo_push(app_drv_fifo_t *fifo, uint8_t data);
 uint8_t app_drv_fifo_pop(app_drv_fifo_t *fifo);
 
 /*!
- * Flushes the FIFO
+ * Flushes the FIFO, consumer side only: drops the stored bytes by moving
+ * begin up to end, the producer may keep writing meanwhile
  *
  * \param [IN] fifo   Pointer to the FIFO object
  */
@@ -130,4 +149,67 @@ app_drv_fifo_result_t
 app_drv_fifo_read_to_same_addr(app_drv_fifo_t *fifo, uint8_t *data,
                                uint16_t read_length);
 
+/*!
+ * Copies data out of the FIFO without removing it
+ *
+ * \param [IN] fifo   Pointer to the FIFO object
+ * \param [OUT] data  Destination buffer
+ * \param [IN] length Number of bytes wanted
+ * \retval            Number of bytes copied (limited by the FIFO length)
+ */
+uint16_t app_drv_fifo_peek(app_drv_fifo_t *fifo, uint8_t *data, uint16_t length);
+
+/*!
+ * Gets the contiguous readable span starting offset bytes after the oldest
+ * byte. Call again with offset += returned length for the wrapped part.
+ *
+ * \param [IN] fifo    Pointer to the FIFO object
+ * \param [IN] offset  Offset from the oldest byte
+ * \param [OUT] p_span Start of the span inside the FIFO buffer
+ * \retval             Span length, 0 when nothing is stored past offset
+ */
+uint16_t app_drv_fifo_peek_span(app_drv_fifo_t *fifo, uint16_t offset, uint8_t **p_span);
+
+/*!
+ * Removes bytes already handled through peek/peek_span
+ *
+ * \param [IN] fifo   Pointer to the FIFO object
+ * \param [IN] length Number of bytes to drop, must not exceed the FIFO length
+ */
+void app_drv_fifo_consume(app_drv_fifo_t *fifo, uint16_t length);
+
+/*!
+ * Gets the contiguous free span after the newest byte, to be filled in place
+ *
+ * \param [IN] fifo    Pointer to the FIFO object
+ * \param [OUT] p_span Start of the free span inside the FIFO buffer
+ * \retval             Span length, 0 when the FIFO is full
+ */
+uint16_t app_drv_fifo_reserve_span(app_drv_fifo_t *fifo, uint8_t **p_span);
+
+/*!
+ * Publishes bytes written in place after app_drv_fifo_reserve_span
+ *
+ * \param [IN] fifo   Pointer to the FIFO object
+ * \param [IN] length Number of bytes written, must not exceed the reserved span
+ */
+void app_drv_fifo_commit(app_drv_fifo_t *fifo, uint16_t length);
+
+/*!
+ * Records bytes the producer had to throw away, counted as one overflow
+ *
+ * \param [IN] fifo   Pointer to the FIFO object
+ * \param [IN] length Number of bytes lost
+ */
+void app_drv_fifo_drop(app_drv_fifo_t *fifo, uint16_t length);
+
+/*!
+ * Copies the FIFO statistics. Each field is read in one access, so a
+ * snapshot taken outside the producer is consistent per field only.
+ *
+ * \param [IN] fifo     Pointer to the FIFO object
+ * \param [OUT] p_stats Destination
+ */
+void app_drv_fifo_get_stats(app_drv_fifo_t *fifo, app_drv_fifo_stats_t *p_stats);
+
 #endif // __APP_DRV_FIFO_H__
@@ -27,6 +27,7 @@ typedef enum
     BLE_UART_EVT_TX_NOTI_DISABLED = 1,
     BLE_UART_EVT_TX_NOTI_ENABLED,
     BLE_UART_EVT_BLE_DATA_RECIEVED,
+    BLE_UART_EVT_CTRL_DATA_RECIEVED,
 } ble_uart_evt_type_t;
 
 typedef struct
@@ -43,6 +44,12 @@ typedef struct
 
 typedef void (*ble_uart_ProfileChangeCB_t)(uint16_t connection_handle, ble_uart_evt_t *p_evt);
 
+//largest diagnostics/status value, the callback fills at most this many bytes
+#define BLE_UART_DIAG_MAX_LEN    48
+
+//fills p_value with the current diagnostics/status value, returns its length
+typedef uint16_t (*ble_uart_DiagReadCB_t)(uint8_t *p_value, uint16_t max_len);
+
 /*********************************************************************
  * API FUNCTIONS
  */
@@ -60,6 +67,25 @@ extern bStatus_t ble_uart_add_service(ble_uart_ProfileChangeCB_t cb);
 extern uint8 ble_uart_notify_is_ready(uint16 connHandle);
 
 extern bStatus_t ble_uart_notify(uint16 connHandle, attHandleValueNoti_t *pNoti, uint8 taskId);
+
+/*
+ * Control characteristic (0xFFF3): writes are reported as BLE_UART_EVT_CTRL_DATA_RECIEVED
+ * and never reach the uart bridge, notifications carry control replies.
+ */
+extern uint8 ble_uart_ctrl_notify_is_ready(uint16 connHandle);
+
+extern bStatus_t ble_uart_ctrl_notify(uint16 connHandle, attHandleValueNoti_t *pNoti);
+
+/*
+ * Diagnostics characteristic (0xFFF4): read only, the value is built by cb
+ * on every read so it always shows the current counters.
+ */
+extern void ble_uart_diag_register(ble_uart_DiagReadCB_t cb);
+
+/*
+ * Link status characteristic (0xFFF5): read only, built by cb on every read.
+ */
+extern void ble_uart_status_register(ble_uart_DiagReadCB_t cb);
 /*********************************************************************
 *********************************************************************/
 
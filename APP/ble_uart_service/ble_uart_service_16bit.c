@@ -27,10 +27,13 @@
  * CONSTANTS
  */
 
-#define SERVAPP_NUM_ATTR_SUPPORTED    7
+#define SERVAPP_NUM_ATTR_SUPPORTED    13
 
 #define RAWPASS_TX_VALUE_HANDLE       2
 #define RAWPASS_RX_VALUE_HANDLE       5
+#define RAWPASS_CTRL_VALUE_HANDLE     7
+#define RAWPASS_DIAG_VALUE_HANDLE     10
+#define RAWPASS_STATUS_VALUE_HANDLE   12
 /*********************************************************************
  * TYPEDEFS
  */
@@ -51,6 +54,18 @@ const uint8_t ble_uart_RxCharUUID[ATT_BT_UUID_SIZE] =
 const uint8_t ble_uart_TxCharUUID[ATT_BT_UUID_SIZE] =
     {0xf1, 0xff};
 
+// Characteristic ctrl uuid
+const uint8_t ble_uart_CtrlCharUUID[ATT_BT_UUID_SIZE] =
+    {0xf3, 0xff};
+
+// Characteristic diag uuid
+const uint8_t ble_uart_DiagCharUUID[ATT_BT_UUID_SIZE] =
+    {0xf4, 0xff};
+
+// Characteristic status uuid
+const uint8_t ble_uart_StatusCharUUID[ATT_BT_UUID_SIZE] =
+    {0xf5, 0xff};
+
 /*********************************************************************
  * EXTERNAL VARIABLES
  */
@@ -65,6 +80,10 @@ const uint8_t ble_uart_TxCharUUID[ATT_BT_UUID_SIZE] =
 
 static ble_uart_ProfileChangeCB_t ble_uart_AppCBs = NULL;
 
+static ble_uart_DiagReadCB_t ble_uart_DiagCB = NULL;
+
+static ble_uart_DiagReadCB_t ble_uart_StatusCB = NULL;
+
 /*********************************************************************
  * Profile Attributes - variables
  */
@@ -90,6 +109,27 @@ static uint8 ble_uart_TxCharValue = 0;
 // Simple Profile Characteristic 2 User Description
 static gattCharCfg_t ble_uart_TxCCCD[4];
 
+// Profile Characteristic 3 Properties
+static uint8 ble_uart_CtrlCharProps = GATT_PROP_WRITE_NO_RSP | GATT_PROP_WRITE | GATT_PROP_NOTIFY;
+
+// Characteristic 3 Value
+static uint8 ble_uart_CtrlCharValue[BLE_UART_RX_BUFF_SIZE];
+
+// Characteristic 3 Client Characteristic Configuration
+static gattCharCfg_t ble_uart_CtrlCCCD[4];
+
+// Profile Characteristic 4 Properties
+static uint8 ble_uart_DiagCharProps = GATT_PROP_READ;
+
+// Characteristic 4 Value, built by ble_uart_DiagCB on read
+static uint8 ble_uart_DiagCharValue = 0;
+
+// Profile Characteristic 5 Properties
+static uint8 ble_uart_StatusCharProps = GATT_PROP_READ;
+
+// Characteristic 5 Value, built by ble_uart_StatusCB on read
+static uint8 ble_uart_StatusCharValue = 0;
+
 /*********************************************************************
  * Profile Attributes - Table
  */
@@ -138,6 +178,55 @@ static gattAttribute_t ble_uart_ProfileAttrTbl[] = {
         0,
         &ble_uart_RxCharValue[0]},
 
+    // Characteristic 3 Declaration
+    {
+        {ATT_BT_UUID_SIZE, characterUUID},
+        GATT_PERMIT_READ,
+        0,
+        &ble_uart_CtrlCharProps},
+
+    // Characteristic Value 3
+    {
+        {ATT_BT_UUID_SIZE, ble_uart_CtrlCharUUID},
+        GATT_PERMIT_WRITE,
+        0,
+        &ble_uart_CtrlCharValue[0]},
+
+    // Characteristic 3 Client Characteristic Configuration
+    {
+        {ATT_BT_UUID_SIZE, clientCharCfgUUID},
+        GATT_PERMIT_READ | GATT_PERMIT_WRITE,
+        0,
+        (uint8 *)ble_uart_CtrlCCCD},
+
+    // Characteristic 4 Declaration
+    {
+        {ATT_BT_UUID_SIZE, characterUUID},
+        GATT_PERMIT_READ,
+        0,
+        &ble_uart_DiagCharProps},
+
+    // Characteristic Value 4
+    {
+        {ATT_BT_UUID_SIZE, ble_uart_DiagCharUUID},
+        GATT_PERMIT_READ,
+        0,
+        &ble_uart_DiagCharValue},
+
+    // Characteristic 5 Declaration
+    {
+        {ATT_BT_UUID_SIZE, characterUUID},
+        GATT_PERMIT_READ,
+        0,
+        &ble_uart_StatusCharProps},
+
+    // Characteristic Value 5
+    {
+        {ATT_BT_UUID_SIZE, ble_uart_StatusCharUUID},
+        GATT_PERMIT_READ,
+        0,
+        &ble_uart_StatusCharValue},
+
 };
 
 /*********************************************************************
@@ -148,6 +237,9 @@ static bStatus_t ble_uart_ReadAttrCB(uint16 connHandle, gattAttribute_t *pAttr,
 static bStatus_t ble_uart_WriteAttrCB(uint16 connHandle, gattAttribute_t *pAttr,
                                       uint8 *pValue, uint16 len, uint16 offset, uint8 method);
 
+static bStatus_t ble_uart_ReadBuilt(ble_uart_DiagReadCB_t cb, uint8 *pValue, uint16 *pLen,
+                                    uint16 offset, uint16 maxLen);
+
 static void ble_uart_HandleConnStatusCB(uint16 connHandle, uint8 changeType);
 
 /*********************************************************************
@@ -180,6 +272,7 @@ bStatus_t ble_uart_add_service(ble_uart_ProfileChangeCB_t cb)
     uint8 status = SUCCESS;
 
     GATTServApp_InitCharCfg(INVALID_CONNHANDLE, ble_uart_TxCCCD);
+    GATTServApp_InitCharCfg(INVALID_CONNHANDLE, ble_uart_CtrlCCCD);
     // Register with Link DB to receive link status change callback
     linkDB_Register(ble_uart_HandleConnStatusCB);
 
@@ -197,6 +290,63 @@ bStatus_t ble_uart_add_service(ble_uart_ProfileChangeCB_t cb)
     return (status);
 }
 
+/*********************************************************************
+ * @fn      ble_uart_diag_register
+ *
+ * @brief   Set the callback that builds the diagnostics value.
+ *
+ * @param   cb - diagnostics read callback, NULL reads as empty
+ *
+ * @return  none
+ */
+void ble_uart_diag_register(ble_uart_DiagReadCB_t cb)
+{
+    ble_uart_DiagCB = cb;
+}
+
+/*********************************************************************
+ * @fn      ble_uart_status_register
+ *
+ * @brief   Set the callback that builds the link status value.
+ *
+ * @param   cb - status read callback, NULL reads as empty
+ *
+ * @return  none
+ */
+void ble_uart_status_register(ble_uart_DiagReadCB_t cb)
+{
+    ble_uart_StatusCB = cb;
+}
+
+/*********************************************************************
+ * @fn          ble_uart_ReadBuilt
+ *
+ * @brief       Read a value built by cb, rebuilt on every read so blob
+ *              reads continue from offset of a fresh copy.
+ *
+ * @param       cb - value builder, may be NULL
+ * @param       pValue - pointer to data to be read
+ * @param       pLen - length of data to be read
+ * @param       offset - offset of the first octet to be read
+ * @param       maxLen - maximum length of data to be read
+ *
+ * @return      Success or Failure
+ */
+static bStatus_t ble_uart_ReadBuilt(ble_uart_DiagReadCB_t cb, uint8 *pValue, uint16 *pLen,
+                                    uint16 offset, uint16 maxLen)
+{
+    uint8  value[BLE_UART_DIAG_MAX_LEN];
+    uint16 len = cb ? cb(value, sizeof(value)) : 0;
+
+    if(offset > len)
+    {
+        return ATT_ERR_INVALID_OFFSET;
+    }
+    *pLen = ((len - offset) < maxLen) ? (len - offset) : maxLen;
+    tmos_memcpy(pValue, &value[offset], *pLen);
+    return SUCCESS;
+}
+
 /*********************************************************************
  * @fn          ble_uart_ReadAttrCB
  *
@@ -227,6 +377,14 @@ static bStatus_t ble_uart_ReadAttrCB(uint16 connHandle, gattAttribute_t *pAttr,
             *pLen = 2;
             tmos_memcpy(pValue, pAttr->pValue, 2);
         }
+        else if(pAttr->handle == ble_uart_ProfileAttrTbl[RAWPASS_DIAG_VALUE_HANDLE].handle)
+        {
+            status = ble_uart_ReadBuilt(ble_uart_DiagCB, pValue, pLen, offset, maxLen);
+        }
+        else if(pAttr->handle == ble_uart_ProfileAttrTbl[RAWPASS_STATUS_VALUE_HANDLE].handle)
+        {
+            status = ble_uart_ReadBuilt(ble_uart_StatusCB, pValue, pLen, offset, maxLen);
+        }
     }
     //    else
     //    {
@@ -278,7 +436,8 @@ static bStatus_t ble_uart_WriteAttrCB(uint16 connHandle, gattAttribute_t *pAttr,
         {
             status = GATTServApp_ProcessCCCWriteReq(connHandle, pAttr, pValue, len,
                                                     offset, GATT_CLIENT_CFG_NOTIFY);
-            if(status == SUCCESS && ble_uart_AppCBs)
+            //only the tx characteristic drives the uart bridge
+            if(status == SUCCESS && ble_uart_AppCBs && (pAttr->pValue == (uint8 *)ble_uart_TxCCCD))
             {
                 uint16         charCfg = BUILD_UINT16(pValue[0], pValue[1]);
                 ble_uart_evt_t evt;
@@ -301,6 +460,17 @@ static bStatus_t ble_uart_WriteAttrCB(uint16 connHandle, gattAttribute_t *pAttr,
                 ble_uart_AppCBs(connHandle, &evt);
             }
         }
+        else if(pAttr->handle == ble_uart_ProfileAttrTbl[RAWPASS_CTRL_VALUE_HANDLE].handle)
+        {
+            if(ble_uart_AppCBs)
+            {
+                ble_uart_evt_t evt;
+                evt.type = BLE_UART_EVT_CTRL_DATA_RECIEVED;
+                evt.data.length = (uint16_t)len;
+                evt.data.p_data = pValue;
+                ble_uart_AppCBs(connHandle, &evt);
+            }
+        }
     }
     //    else
     //    {
@@ -341,6 +511,7 @@ static void ble_uart_HandleConnStatusCB(uint16 connHandle, uint8 changeType)
         {
             //ble_uart_TxCCCD[0].value = 0;
             GATTServApp_InitCharCfg(connHandle, ble_uart_TxCCCD);
+            GATTServApp_InitCharCfg(connHandle, ble_uart_CtrlCCCD);
             //PRINT("clear client configuration\n");
         }
     }
@@ -377,5 +548,34 @@ bStatus_t ble_uart_notify(uint16 connHandle, attHandleValueNoti_t *pNoti, uint8
     return bleIncorrectMode;
 }
 
+uint8 ble_uart_ctrl_notify_is_ready(uint16 connHandle)
+{
+    return (GATT_CLIENT_CFG_NOTIFY == GATTServApp_ReadCharCfg(connHandle, ble_uart_CtrlCCCD));
+}
+
+/*********************************************************************
+ * @fn          ble_uart_ctrl_notify
+ *
+ * @brief       Send a notification on the control characteristic.
+ *
+ * @param       connHandle - connection handle
+ * @param       pNoti - pointer to notification structure
+ *
+ * @return      Success or Failure
+ */
+bStatus_t ble_uart_ctrl_notify(uint16 connHandle, attHandleValueNoti_t *pNoti)
+{
+    uint16 value = GATTServApp_ReadCharCfg(connHandle, ble_uart_CtrlCCCD);
+    // If notifications enabled
+    if(value & GATT_CLIENT_CFG_NOTIFY)
+    {
+        // Set the handle
+        pNoti->handle = ble_uart_ProfileAttrTbl[RAWPASS_CTRL_VALUE_HANDLE].handle;
+
+        return GATT_Notification(connHandle, pNoti, FALSE);
+    }
+    return bleIncorrectMode;
+}
+
 /*********************************************************************
 *********************************************************************/
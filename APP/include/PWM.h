@@ -3,12 +3,12 @@
  * Author             : 
  * Version            : V2.0
  * Date               : 2025/12/01
- * Description        : 互补PWM控制模块头文件（基于TMR0定时器中断实现）
- *                      实现真正的互补PWM输出（不重叠，顺序输出）
- *                      - PWM频率：约80kHz (实际78.43kHz)
- *                      - 分辨率：100步
- *                      - PWM1在0到duty1时间段输出高电平
- *                      - PWM2在duty1到duty1+duty2时间段输出高电平
+ * Description        : 互补PWM控制模块头文件（基于PWMX的PWM4/PWM5实现）
+ *                      - PWM频率：约80kHz (实际78.1kHz)
+ *                      - 分辨率：256步（Q8定点，百分比接口为其包装）
+ *                      - 对齐模式：PWM1、PWM2均在周期起点输出高电平
+ *                      - 顺序模式：PWM1在周期起点输出duty1宽的高电平，
+ *                        PWM2在周期末尾输出duty2宽的高电平，两路不重叠
  *                      - 总占空比可调，两个PWM之间的分配比例可调
  *******************************************************************************/
 
@@ -32,6 +32,42 @@ extern "C" {
  */
 #define PWM_CYCLE_MAX    256        // PWM周期最大值
 
+/**
+ * @brief  输出模式定义
+ */
+#define PWM_OUTPUT_ALIGNED       0  // 两路均在周期起点变高（默认）
+#define PWM_OUTPUT_SEQUENTIAL    1  // 先A后B：PWM4在周期起点变高，PWM5在周期末尾变高
+
+/**
+ * @brief  渐变引擎定义
+ */
+#define PWM_FADE_EVT       0x0001   // PWM任务事件：推进一次渐变
+#define PWM_FADE_TICK_MS   10       // 渐变插值周期(ms)
+
+/**
+ * @brief  Q8定点宽度定义
+ *         宽度以PWM周期的1/256为单位，PWM_Q8_ONE表示100%
+ *         百分比与Q8之间的换算使用预先算好的倒数常数（乘法+移位），避免除法：
+ *         256/100 ≈ 2622/1024，256/200 ≈ 328/256
+ */
+#define PWM_Q8_ONE               256U
+#define PWM_PCT_TO_Q8(pct)       ((uint16_t)(((uint32_t)(pct) * 2622U + 512U) >> 10))        // 0-100 -> 0-256
+#define PWM_BALANCE_TO_Q8(bal)   ((uint16_t)(((uint32_t)(100 + (bal)) * 328U + 128U) >> 8))   // -100..+100 -> 0-256
+#define PWM_Q8_TO_PCT(q8)        ((uint8_t)(((uint32_t)(q8) * 100U + 128U) >> 8))             // 0-256 -> 0-100
+
+/**
+ * @brief  感知亮度(gamma)校正
+ *         使能后总占空比先经 PWM_GammaLUT 查表再分配到两路，调光在人眼看来呈线性
+ *         查找表由 tools/gen_pwm_gamma.py 生成到 PWM_Gamma.c，修改指数需重新生成
+ */
+#ifndef PWM_GAMMA_ENABLE
+#define PWM_GAMMA_ENABLE         1
+#endif
+
+#if (PWM_GAMMA_ENABLE)
+extern const uint16_t PWM_GammaLUT[PWM_Q8_ONE + 1];
+#endif
+
 /**
  * @brief  初始化互补PWM控制
  *         使用PWM4和PWM5作为两个独立可调的PWM输出
@@ -75,9 +111,86 @@ void PWM_SetBalance(int8_t balance);
  */
 void PWM_SetDutyAndBalance(uint8_t total_duty, int8_t balance);
 
-// 使用DelayUs软件延时方式，在A高电平结束后开启B通道的版本
+// 先A后B版本：切换到PWM_OUTPUT_SEQUENTIAL后设置，相位由硬件保证
 void PWM_SetDutyAndBalance_DelayMode(uint8_t total_duty, int8_t balance);
 
+/**
+ * @brief  以Q8定点格式设置总占空比和分配比例并更新输出
+ *         width1 = total_q8 * ratio_q8 / 256，width2 = total_q8 - width1
+ *
+ * @param  total_q8 - 总占空比，范围0-256 (256表示100%)
+ * @param  ratio_q8 - PWM1占总占空比的比例，范围0-256 (128表示完全平衡)
+ *
+ * @return  None
+ */
+void PWM_SetWidthsQ8(uint16_t total_q8, uint16_t ratio_q8);
+
+/**
+ * @brief  切换PWM4/PWM5的输出模式
+ *         顺序模式下PWM5改为低电平有效，在周期末尾输出，相位关系由同一个PWMX计数器保证，
+ *         无需定时器中断或软件延时
+ *
+ * @param  mode - PWM_OUTPUT_ALIGNED / PWM_OUTPUT_SEQUENTIAL
+ *
+ * @return  None
+ */
+void PWM_SetOutputMode(uint8_t mode);
+
+/**
+ * @brief  获取当前PWM4/PWM5的输出模式
+ *
+ * @return  PWM_OUTPUT_ALIGNED / PWM_OUTPUT_SEQUENTIAL
+ */
+uint8_t PWM_GetOutputMode(void);
+
+/**
+ * @brief  获取当前PWM1和PWM2的Q8宽度
+ *
+ * @param  width1 - 输出PWM1的宽度 (0-256)
+ * @param  width2 - 输出PWM2的宽度 (0-256)
+ *
+ * @return  None
+ */
+void PWM_GetWidthsQ8(uint16_t *width1, uint16_t *width2);
+
+/**
+ * @brief  注册PWM渐变引擎的TMOS任务
+ *         需在CH58X_BLEInit()之后调用，未调用时渐变接口退化为立即设置
+ *
+ * @return  None
+ */
+void PWM_FadeInit(void);
+
+/**
+ * @brief  从当前输出线性渐变到目标值（Q8格式）
+ *         由TMOS重装载任务每PWM_FADE_TICK_MS插值一次，期间直接设置会打断渐变
+ *
+ * @param  total_q8    - 目标总占空比，范围0-256
+ * @param  ratio_q8    - 目标PWM1分配比例，范围0-256
+ * @param  duration_ms - 渐变时长(ms)，小于PWM_FADE_TICK_MS时立即生效
+ *
+ * @return  None
+ */
+void PWM_FadeToQ8(uint16_t total_q8, uint16_t ratio_q8, uint16_t duration_ms);
+
+/**
+ * @brief  从当前输出线性渐变到目标值（百分比格式）
+ *
+ * @param  total_duty  - 目标总占空比，范围0-100 (%)
+ * @param  balance     - 目标平衡度，范围-100到+100
+ * @param  duration_ms - 渐变时长(ms)
+ *
+ * @return  None
+ */
+void PWM_FadeTo(uint8_t total_duty, int8_t balance, uint16_t duration_ms);
+
+/**
+ * @brief  查询是否有渐变正在进行
+ *
+ * @return  非0 - 渐变中，0 - 空闲
+ */
+uint8_t PWM_FadeIsActive(void);
+
 /**
  * @brief  获取当前PWM1和PWM2的实际占空比
  *         
@@ -0,0 +1,159 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : app_ctrl.h
+ * Author             :
+ * Version            : V1.0
+ * Date               : 2026/01/12
+ * Description        : 蓝牙PWM控制协议解析
+ *                      - 旧格式：2字节(总占空比, PWM4百分比) 或 4字节(再加小端渐变时长)
+ *                      - 帧格式：[0xA5][版本][TLV]...，一次写入可携带多条命令，解析完后统一执行
+ *                        每条TLV为 [类型][长度][值...]，未知类型按长度跳过
+ *                      - 带SEQ的帧执行后由设备通过TX通知回复 [0xA5][版本][ACK][2n][序号,结果]...，
+ *                        同一连接事件内的多个应答合并为一条通知
+ *******************************************************************************/
+
+#ifndef __APP_CTRL_H__
+#define __APP_CTRL_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "CONFIG.h"
+
+/**
+ * @brief  帧头定义
+ *         旧格式的第1个字节为总占空比(0-100)，不会等于帧头，据此区分两种格式
+ */
+#define APP_CTRL_MAGIC           0xA5
+#define APP_CTRL_VERSION         0x01     // 当前支持的最高协议版本
+#define APP_CTRL_HDR_LEN         2        // 帧头 + 版本
+#define APP_CTRL_TLV_HDR_LEN     2        // 类型 + 长度
+
+/**
+ * @brief  TLV类型定义（多字节数值均为小端）
+ */
+#define APP_CTRL_TLV_SET         0x01     // [总占空比 0-100][PWM4百分比 0-100]
+#define APP_CTRL_TLV_FADE        0x02     // [总占空比][PWM4百分比][渐变时长ms 2B]
+#define APP_CTRL_TLV_SET_Q8      0x03     // [总占空比Q8 2B][PWM4比例Q8 2B]([渐变时长ms 2B]可选)
+#define APP_CTRL_TLV_MODE        0x04     // [输出模式] PWM_OUTPUT_ALIGNED / PWM_OUTPUT_SEQUENTIAL
+#define APP_CTRL_TLV_SEQ         0x05     // [序号] 帧序号，带此TLV的帧执行后回复应答
+#define APP_CTRL_TLV_UART        0x06     // [波特率 4B][校验 0无/1奇/2偶/3mark/4space][停止位 1/2] 透传串口配置，断电保存
+#define APP_CTRL_TLV_ACK         0x81     // 设备->上位机：[序号][结果]... 每帧2字节
+#define APP_CTRL_TLV_CREDIT      0x82     // 设备->上位机：[串口发送FIFO剩余字节 2B]，流控额度
+
+/**
+ * @brief  应答缓存定义
+ */
+#define APP_CTRL_ACK_MAX         16       // 最多缓存的未发送应答数，必须为2的幂
+
+/**
+ * @brief  RX特征值(FFF2)上是否仍把2/4字节写入当作旧格式控制命令
+ *         为1时兼容只会向FFF2写2/4字节的旧上位机，但长度恰为2或4字节的透传数据会被当作命令；
+ *         新上位机应把控制命令写入控制特征值(FFF3)，所有上位机都改用FFF3后可置0，FFF2只做透传
+ */
+#ifndef APP_CTRL_LEGACY_ON_RX
+#define APP_CTRL_LEGACY_ON_RX    1
+#endif
+
+/**
+ * @brief  解析结果
+ */
+#define APP_CTRL_OK              0x00
+#define APP_CTRL_ERR_LENGTH      0x01     // 旧格式长度不是2或4，或帧长度不足帧头
+#define APP_CTRL_ERR_VERSION     0x02     // 帧版本高于APP_CTRL_VERSION，整帧不执行
+#define APP_CTRL_ERR_TRUNCATED   0x03     // TLV长度超出帧尾，之后的命令不再执行
+#define APP_CTRL_ERR_VALUE       0x04     // 已知类型的长度或取值非法（含误差超限的波特率），跳过该条继续
+#define APP_CTRL_PASSTHROUGH     0xFF     // app_ctrl_dispatch()：不是控制命令，已写入串口透传
+
+/**
+ * @brief  写入的特征值
+ */
+#define APP_CTRL_CHAR_RX         0        // RX特征值(FFF2)：串口透传
+#define APP_CTRL_CHAR_CTRL       1        // 控制特征值(FFF3)：控制协议
+
+/**
+ * @brief  解析并执行一次写入的控制数据
+ *         帧内各条命令依次执行，遇到非法命令记录错误后继续（截断除外），
+ *         返回值为遇到的第一个错误
+ *
+ * @param  p_data - 写入的数据
+ * @param  length - 数据长度
+ *
+ * @return APP_CTRL_OK 或 APP_CTRL_ERR_xxx
+ */
+uint8_t app_ctrl_process(const uint8_t *p_data, uint16_t length);
+
+/**
+ * @brief  判断RX特征值(FFF2)上的一次写入是否为旧格式控制命令
+ *         只有APP_CTRL_LEGACY_ON_RX为1（默认）时的2/4字节写入才算，0xA5开头的透传数据照常透传
+ *
+ * @param  p_data - 写入的数据
+ * @param  length - 数据长度
+ *
+ * @return 1 - 控制命令，0 - 串口透传数据
+ */
+uint8_t app_ctrl_match(const uint8_t *p_data, uint16_t length);
+
+/**
+ * @brief  分发一次蓝牙写入：FFF3的写入和app_ctrl_match()认定的FFF2写入交给app_ctrl_process()，
+ *         其余FFF2写入交给app_uart_tx_data()透传
+ *
+ * @param  char_id - APP_CTRL_CHAR_RX 或 APP_CTRL_CHAR_CTRL
+ * @param  p_data  - 写入的数据
+ * @param  length  - 数据长度
+ *
+ * @return app_ctrl_process()的结果，透传时为APP_CTRL_PASSTHROUGH
+ */
+uint8_t app_ctrl_dispatch(uint8_t char_id, const uint8_t *p_data, uint16_t length);
+
+/**
+ * @brief  获取等待发送的应答数
+ *
+ * @return 应答数
+ */
+uint8_t app_ctrl_ack_pending(void);
+
+/**
+ * @brief  把等待发送的应答组成一条ACK帧（能放下多少放多少），应答仍保留在缓存中，
+ *         发送成功后再调用app_ctrl_ack_release()释放
+ *
+ * @param  buf  - 输出缓冲区
+ * @param  size - 缓冲区大小（通常为 MTU-3）
+ *
+ * @return 帧长度，无应答或缓冲区放不下一条应答时返回0
+ */
+uint16_t app_ctrl_ack_build(uint8_t *buf, uint16_t size);
+
+/**
+ * @brief  释放已随ACK帧发送成功的应答
+ *
+ * @param  frame_len - app_ctrl_ack_build()返回的帧长度
+ *
+ * @return None
+ */
+void app_ctrl_ack_release(uint16_t frame_len);
+
+/**
+ * @brief  组一条流控额度帧：[0xA5][版本][CREDIT][2][剩余字节 2B]
+ *         上位机收到后，在下一条额度帧之前向FFF2写入的透传数据总量不应超过该值
+ *
+ * @param  buf  - 输出缓冲区
+ * @param  size - 缓冲区大小
+ * @param  room - 串口发送FIFO剩余字节数
+ *
+ * @return 帧长度，缓冲区不足时返回0
+ */
+uint16_t app_ctrl_credit_build(uint8_t *buf, uint16_t size, uint16_t room);
+
+/**
+ * @brief  丢弃所有未发送的应答（连接断开时调用）
+ *
+ * @return None
+ */
+void app_ctrl_ack_flush(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __APP_CTRL_H__
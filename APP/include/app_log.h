@@ -0,0 +1,113 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : app_log.h
+ * Author             :
+ * Version            : V1.0
+ * Date               : 2026/01/10
+ * Description        : Deferred binary log.
+ *                      APP_LOGx() only stores a format id and up to 4 integer
+ *                      arguments in a RAM ring; the ring is drained to UART1 from
+ *                      the log TMOS task, one record per pass, as lines of the form
+ *                      "#L <time> <id> <lost> [args...]" (hex fields).
+ *                      tools/app_log_decode.py turns those lines back into text
+ *                      using APP_LOG_FMT_TABLE below.
+ *******************************************************************************/
+
+#ifndef app_log_H
+#define app_log_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*********************************************************************
+ * INCLUDES
+ */
+
+#include "CONFIG.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+//Log task events
+#define APP_LOG_DRAIN_EVT      0x0001
+
+//Number of records in the ring, must be a power of 2
+#define APP_LOG_RING_LEN       16U
+
+//Maximum integer arguments per record
+#define APP_LOG_MAX_ARGS       4U
+
+/*
+ * Format table: X(id, "printf format").
+ * The format strings are never linked into the firmware, they are only
+ * read by tools/app_log_decode.py. Append new entries at the end so ids
+ * of existing entries stay stable for old captures.
+ */
+#define APP_LOG_FMT_TABLE(X)                                                                 \
+    X(APP_LOG_BLE_RX,        "BLE Data Received: len=%d")                                    \
+    X(APP_LOG_BLE_PWM,       "[BLE PWM] Total=%d%%, PWM4_ratio=%d%%, fade=%dms")             \
+    X(APP_LOG_BLE_PWM_LEN,   "[BLE PWM] Error: Invalid data length (expected 2 or 4, got %d)") \
+    X(APP_LOG_BLE_CMD_COST,  "[BLE PWM] cost=%lu cycles (max=%lu)")                          \
+    X(APP_LOG_PWM_SET,       "[PWM] Set: Total=%d%%, Balance=%d, width1=%d, width2=%d")      \
+    X(APP_LOG_PWM_SET_DELAY, "[PWM][Delay] Set: Total=%d%%, Balance=%d, width1=%d, width2=%d") \
+    X(APP_LOG_CTRL_ERR,      "[CTRL] Error %d at offset %d")                                 \
+    X(APP_LOG_CTRL_ACK_DROP, "[CTRL] Ack queue full, seq %d dropped")                      \
+    X(APP_LOG_UART_CFG,      "[UART] baud=%lu parity=%d stop=%d saved=%d")
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+
+#define APP_LOG_ENUM_ENTRY(id, fmt)    id,
+typedef enum
+{
+    APP_LOG_FMT_TABLE(APP_LOG_ENUM_ENTRY)
+    APP_LOG_ID_NUM
+} app_log_id_t;
+#undef APP_LOG_ENUM_ENTRY
+
+/*********************************************************************
+ * MACROS
+ */
+
+//Record a log entry; cheap enough for GATT callbacks, not for use in interrupts
+#ifdef DEBUG
+  #define APP_LOG0(id)                  app_log_push((id), 0, 0, 0, 0, 0)
+  #define APP_LOG1(id, a)               app_log_push((id), 1, (uint32_t)(a), 0, 0, 0)
+  #define APP_LOG2(id, a, b)            app_log_push((id), 2, (uint32_t)(a), (uint32_t)(b), 0, 0)
+  #define APP_LOG3(id, a, b, c)         app_log_push((id), 3, (uint32_t)(a), (uint32_t)(b), (uint32_t)(c), 0)
+  #define APP_LOG4(id, a, b, c, d)      app_log_push((id), 4, (uint32_t)(a), (uint32_t)(b), (uint32_t)(c), (uint32_t)(d))
+#else
+  #define APP_LOG0(id)
+  #define APP_LOG1(id, a)
+  #define APP_LOG2(id, a, b)
+  #define APP_LOG3(id, a, b, c)
+  #define APP_LOG4(id, a, b, c, d)
+#endif
+
+/*********************************************************************
+ * FUNCTIONS
+ */
+
+/**
+ * @brief   Register the log drain task, call after CH58X_BLEInit().
+ *          Records pushed before this are kept and drained afterwards.
+ */
+extern void app_log_init(void);
+
+/**
+ * @brief   Store one record in the ring, use the APP_LOGx() macros instead.
+ *          When the ring is full the record is dropped and counted; the count
+ *          is reported in the next record that fits.
+ */
+extern void app_log_push(uint8_t id, uint8_t argc, uint32_t a0, uint32_t a1, uint32_t a2, uint32_t a3);
+
+/*********************************************************************
+*********************************************************************/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,91 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : app_pd.h
+ * Author             :
+ * Version            : V1.0
+ * Date               : 2026/01/20
+ * Description        : FUSB302 PD受电端任务
+ *                      - 独立的TMOS任务，蓝牙和PWM启动不再等待PD协商
+ *                      - 未连接时每100ms检测一次CC脚，连接后由INT(PB5)下降沿中断驱动收包
+ *                      - 硬件IIC时状态寄存器和FIFO由IIC中断读取，每次读取结束回到任务继续
+ *                      - 电源端重发档位（重新协商）、硬复位和拔出都在任务中处理
+ *                      - 使用PPS档位时定时刷新请求，请求电压固定（PWM调光，不跟随亮度）
+ *******************************************************************************/
+
+#ifndef __APP_PD_H__
+#define __APP_PD_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "CONFIG.h"
+
+/**
+ * @brief  任务事件
+ */
+#define APP_PD_STEP_EVT          0x0001   // 检测/连接步骤定时，连接后用于检测拔出
+#define APP_PD_INT_EVT           0x0002   // INT脚拉低，读取收到的消息
+#define APP_PD_REQUEST_EVT       0x0004   // 收到档位后延时发送请求
+#define APP_PD_PPS_EVT           0x0008   // PPS定时刷新请求
+#define APP_PD_IIC_EVT           0x0010   // IIC中断方式读取结束，继续收包
+#define APP_PD_IIC_TIMEOUT_EVT   0x0020   // IIC中断方式读取超时
+
+/**
+ * @brief  时间参数（单位625us）
+ */
+#define APP_PD_DETECT_PERIOD     160      // 未连接时CC检测周期 100ms
+#define APP_PD_RESET_TICKS       8        // 芯片复位等待 5ms
+#define APP_PD_MEAS_TICKS        4        // CC测量等待 2.5ms
+#define APP_PD_REQUEST_TICKS     16       // 收到档位到发送请求 10ms
+#define APP_PD_DETACH_PERIOD     320      // 连接后CC检测周期 200ms
+#define APP_PD_DETACH_COUNT      3        // 连续几次无电压判定为拔出
+#define APP_PD_PPS_REFRESH_TICKS 12800    // PPS刷新周期 8s（电源要求10s内）
+#define APP_PD_IIC_TIMEOUT_TICKS 16       // 一次IIC中断方式读取的超时 10ms（400kHz下最长约1ms）
+
+/**
+ * @brief  任务状态
+ */
+#define APP_PD_STATE_DETACHED    0        // 未连接，等待下次检测
+#define APP_PD_STATE_RESET       1        // 芯片复位中
+#define APP_PD_STATE_MEAS_CC1    2        // 测量CC1
+#define APP_PD_STATE_MEAS_CC2    3        // 测量CC2
+#define APP_PD_STATE_ATTACHING   4        // 已发硬件复位包，等待芯片复位
+#define APP_PD_STATE_ATTACHED    5        // 已连接，协商进度见PD_STEP（3=已请求档位）
+
+/**
+ * @brief  INT脚中断标志，中断中置位，app_pd_process()中清除
+ */
+extern volatile uint8_t app_pd_int_flag;
+
+/**
+ * @brief  IIC中断方式读取结束标志，读取结束回调中置位，app_pd_process()中清除
+ */
+extern volatile uint8_t app_pd_iic_flag;
+
+/**
+ * @brief  初始化PD任务：注册TMOS任务，配置INT脚下降沿中断，开始检测CC脚
+ *         需在CH58X_BLEInit()之后、FUSB302 IIC引脚初始化之后调用
+ *
+ * @return None
+ */
+void app_pd_init(void);
+
+/**
+ * @brief  主循环中调用，把INT脚中断和IIC读取结束转为任务事件
+ *
+ * @return None
+ */
+void app_pd_process(void);
+
+/**
+ * @brief  获取任务状态
+ *
+ * @return APP_PD_STATE_xxx
+ */
+uint8_t app_pd_state(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __APP_PD_H__
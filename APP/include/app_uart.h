@@ -28,24 +28,89 @@ extern "C" {
  * CONSTANTS
  */
 
-extern uint8_t to_test_buffer[BLE_BUFF_MAX_LEN - 4 - 3];
-
 extern app_drv_fifo_t app_uart_tx_fifo;
 extern app_drv_fifo_t app_uart_rx_fifo;
 
 //interupt uart rx flag ,clear at main loop
-extern bool uart_rx_flag;
+extern volatile bool uart_rx_flag;
 
 //for interrupt rx blcak hole ,when uart rx fifo full
 extern uint8_t for_uart_rx_black_hole;
 
-//fifo length less that MTU-3, retry times
-extern uint32_t uart_to_ble_send_evt_cnt;
+//interupt uart rx idle flag (RECV_TOUT), clear by the uart to ble flush
+extern volatile bool uart_rx_idle_flag;
 
 /*********************************************************************
  * MACROS
  */
 
+//UART3 has no modem lines, set to 1 to run RTS/CTS on two GPIOs (active low)
+#ifndef APP_UART_FLOW_CTRL
+  #define APP_UART_FLOW_CTRL       0
+#endif
+
+//flow control pins on port A, adjust to the board
+#ifndef APP_UART_RTS_PIN
+  #define APP_UART_RTS_PIN         GPIO_Pin_6
+#endif
+#ifndef APP_UART_CTS_PIN
+  #define APP_UART_CTS_PIN         GPIO_Pin_7
+#endif
+
+//throughput benchmark: 1 streams a counting byte pattern on the TX characteristic
+//instead of uart data and prints KB/s on the debug uart every second
+#ifndef APP_UART_BENCH
+  #define APP_UART_BENCH           0
+#endif
+
+//RTS is released when the rx fifo room drops below STOP and asserted again
+//once it is back to GO, STOP leaves room for what the sender still has in flight
+#define APP_UART_RTS_STOP_ROOM     64U
+#define APP_UART_RTS_GO_ROOM       512U
+
+//uart bridge framing, 8 data bits; parity values match APP_CTRL_TLV_UART
+#define APP_UART_PARITY_NONE       0
+#define APP_UART_PARITY_ODD        1
+#define APP_UART_PARITY_EVEN       2
+#define APP_UART_PARITY_MARK       3
+#define APP_UART_PARITY_SPACE      4
+
+#define APP_UART_BAUD_DEFAULT      115200U
+
+//largest accepted baud rate error, per mille: baud = Fsys / 8 / divisor
+#define APP_UART_BAUD_TOLERANCE    20U
+
+//data flash offset of the saved uart configuration, one erase page, below the SNV area
+#ifndef APP_UART_CFG_EEPROM_ADDR
+  #define APP_UART_CFG_EEPROM_ADDR 0x7C00
+#endif
+
+//uart -> ble flush: a notification goes out once MTU-3 bytes are buffered, when the
+//uart line goes idle (RECV_TOUT), or when buffered data has waited this long (625us unit)
+#ifndef APP_UART_FLUSH_LATENCY
+  #define APP_UART_FLUSH_LATENCY   MS1_TO_SYSTEM_TIME(5)
+#endif
+
+//flush reasons, index of the flush counters in the diagnostics record
+#define APP_UART_FLUSH_FULL        0
+#define APP_UART_FLUSH_IDLE        1
+#define APP_UART_FLUSH_DEADLINE    2
+#define APP_UART_FLUSH_REASONS     3
+
+//flush latency histogram, upper bounds of the buckets in 625us ticks, the last one is open
+#define APP_UART_FLUSH_HIST_BOUNDS {2, 8, 32}
+#define APP_UART_FLUSH_HIST_NUM    4
+
+//diagnostics record returned by app_uart_diag_read(), little endian:
+//[version][flags] then rx and tx fifo as [dropped 4B][overflows 2B][high water 2B][length 2B],
+//then the flush counters [full 2B][idle 2B][deadline 2B] and the latency histogram [4 x 2B]
+#define APP_UART_DIAG_VERSION      2
+#define APP_UART_DIAG_LEN          36
+
+#define APP_UART_DIAG_FLOW_CTRL    0x01 //flow control compiled in
+#define APP_UART_DIAG_RTS_HELD     0x02 //we asked the sender to pause
+#define APP_UART_DIAG_CTS_HELD     0x04 //the receiver asked us to pause
+
 /*********************************************************************
  * FUNCTIONS
  */
@@ -54,6 +119,51 @@ extern void app_uart_process(void);
 
 extern void app_uart_init(void);
 
+/*
+ * Queue ble data for the uart. Bytes that do not fit are dropped and counted;
+ * crossing the high watermark raises UART_CREDIT_EVT on the peripheral task.
+ */
+extern void app_uart_tx_data(uint8_t *data, uint16_t length);
+
+//free bytes in the tx fifo, sent to the client as its credit
+extern uint16_t app_uart_tx_room(void);
+
+//clear the tx throttle state, the next high watermark crossing raises UART_CREDIT_EVT again
+extern void app_uart_tx_credit_reset(void);
+
+/*
+ * Divisor latch value for baud at system clock fsys (UART3 pre-divisor 1).
+ * Returns false when the rate is out of range or off by more than APP_UART_BAUD_TOLERANCE.
+ */
+extern bool app_uart_baud_divisor(uint32_t fsys, uint32_t baud, uint16_t *p_dl);
+
+/*
+ * Reconfigure the bridge: both directions are flushed (hardware and software fifos),
+ * the new setting is applied and saved to data flash when it changed. The tx throttle
+ * is cleared and UART_CREDIT_EVT raised so the client gets a fresh credit.
+ * Returns false, leaving the uart untouched, for an unsupported setting.
+ */
+extern bool app_uart_config(uint32_t baud, uint8_t parity, uint8_t stop_bits);
+
+/*
+ * uart -> ble flush policy, called from the ble task.
+ * app_uart_rx_flush_len() returns the number of bytes to notify now (at most max_len);
+ * when it returns 0, *p_wait is the delay until the deadline, or 0 if the fifo is empty.
+ * After the notification is queued, app_uart_rx_flushed() drops the bytes from the fifo.
+ */
+extern uint16_t app_uart_rx_flush_len(uint16_t max_len, uint32_t *p_wait);
+
+extern void app_uart_rx_flushed(uint16_t length);
+
+//drop buffered uart data and restart the flush policy, e.g. on disconnect
+extern void app_uart_rx_discard(void);
+
+/*
+ * Fills the diagnostics record, returns APP_UART_DIAG_LEN or 0 when size
+ * is too small. Registered as the ble_uart diagnostics read callback.
+ */
+extern uint16_t app_uart_diag_read(uint8_t *buf, uint16_t size);
+
 extern void on_bleuartServiceEvt(uint16_t connection_handle, ble_uart_evt_t *p_evt);
 
 /*********************************************************************
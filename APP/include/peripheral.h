@@ -31,6 +31,9 @@ extern "C" {
 #define SBP_READ_RSSI_EVT       0x0004
 #define SBP_PARAM_UPDATE_EVT    0x0008
 #define UART_TO_BLE_SEND_EVT    0x0010
+#define CTRL_ACK_EVT            0x0020
+#define SBP_LINK_SETUP_EVT      0x0040
+#define UART_CREDIT_EVT         0x0080
 
 // Simple Profile Service UUID
 #define SIMPLEPROFILE_SERV_UUID     0xFFE0
@@ -43,6 +46,8 @@ typedef struct
     uint16 connInterval;
     uint16 connSlaveLatency;
     uint16 connTimeout;
+    uint8  connTxPhy;  // GAP_PHY_VAL_TYPE
+    uint8  connRxPhy;
 } peripheralConnItem_t;
 
 extern uint8_t Peripheral_TaskID;
@@ -6,11 +6,13 @@ uint8_t USB302_TX_Buff[20];
 uint8_t USB302_RX_Buff[40];
 uint8_t RX_Length = 0;
 uint8_t PD_STEP = 0;
+uint8_t USB302_Status[FUSB302_STATUS_NUM]; // 0x3C~0x42缓存，中断寄存器读后芯片内已清零
 
 uint8_t PD_MSG_ID = 0;
 uint8_t PD_Version = 2;
 PD_Source_Capabilities_TypeDef PD_Source_Capabilities_Inf[7];
 uint8_t PD_Source_Capabilities_Inf_num = 0;
+USB302_Request_TypeDef PD_Request_Inf;
 
 /**
  * @brief       IIC接口延时函数，用于控制IIC读写速度
@@ -177,81 +179,731 @@ static uint8_t fusb302_iic_recv_byte(uint8_t ack)
     return dat;
 }
 
+/**
+ * @brief       GPIO模拟IIC：初始化引脚
+ * @param       无
+ * @retval      无
+ */
+static void fusb302_soft_init(void)
+{
+    GPIOB_ModeCfg(GPIO_Pin_12 | GPIO_Pin_13, GPIO_ModeOut_PP_5mA);
+    GPIOB_SetBits(GPIO_Pin_12 | GPIO_Pin_13);
+    fusb302_iic_stop();
+}
+
+/**
+ * @brief       GPIO模拟IIC：发送器件地址和寄存器地址
+ * @param       reg: 寄存器地址
+ * @retval      0: 成功, 其他: 未应答次数
+ */
+static uint8_t fusb302_soft_addr(uint8_t reg)
+{
+    uint8_t nack;
+
+    fusb302_iic_start();
+    fusb302_iic_send_byte((FUSB302_I2C_ADDR << 1) | FUSB302_IIC_WRITE);
+    nack = fusb302_iic_wait_ack();
+    fusb302_iic_send_byte(reg);
+    nack += fusb302_iic_wait_ack();
+
+    return nack;
+}
+
+/**
+ * @brief       GPIO模拟IIC：从reg开始连续写
+ * @param       reg: 寄存器地址
+ * @param       data: 数据
+ * @param       len: 数据长度
+ * @retval      0: 成功, 1: 失败
+ */
+static uint8_t fusb302_soft_write(uint8_t reg, const uint8_t *data, uint8_t len)
+{
+    uint8_t nack;
+    uint8_t i;
+
+    nack = fusb302_soft_addr(reg);
+    for (i = 0; i < len; i++)
+    {
+        fusb302_iic_send_byte(data[i]);
+        nack += fusb302_iic_wait_ack();
+    }
+    fusb302_iic_stop();
+
+    return nack ? 1 : 0;
+}
+
+/**
+ * @brief       GPIO模拟IIC：从reg开始连续读
+ * @param       reg: 寄存器地址
+ * @param       data: 接收缓冲区
+ * @param       len: 读取长度，不能为0
+ * @retval      0: 成功, 1: 失败
+ */
+static uint8_t fusb302_soft_read(uint8_t reg, uint8_t *data, uint8_t len)
+{
+    uint8_t nack;
+    uint8_t i;
+
+    nack = fusb302_soft_addr(reg);
+
+    fusb302_iic_start(); // Repeated START
+    fusb302_iic_send_byte((FUSB302_I2C_ADDR << 1) | FUSB302_IIC_READ);
+    nack += fusb302_iic_wait_ack();
+
+    for (i = 0; i < len - 1; i++)
+    {
+        data[i] = fusb302_iic_recv_byte(1); // ACK
+    }
+    data[i] = fusb302_iic_recv_byte(0); // NACK for last byte
+
+    fusb302_iic_stop();
+
+    return nack ? 1 : 0;
+}
+
+const fusb302_iic_ops_t fusb302_iic_soft_ops =
+    {
+        fusb302_soft_init,
+        fusb302_soft_write,
+        fusb302_soft_read,
+        NULL, // GPIO模拟只能阻塞传输
+};
+
+/* 硬件IIC中断传输的步骤 */
+#define FUSB302_HW_XFER_IDLE    0
+#define FUSB302_HW_XFER_ADDR_W  1   // 等待START，发送器件地址(写)
+#define FUSB302_HW_XFER_REG     2   // 等待地址应答，发送寄存器地址
+#define FUSB302_HW_XFER_RESTART 3   // 等待寄存器地址发完，重复START
+#define FUSB302_HW_XFER_ADDR_R  4   // 等待重复START，发送器件地址(读)
+#define FUSB302_HW_XFER_ADDR_OK 5   // 等待地址应答，按长度设置ACK/STOP
+#define FUSB302_HW_XFER_RECV    6   // 接收数据
+
+/* 硬件IIC中断传输状态，只在fusb302_hw_read_start()和I2C_IRQHandler中修改 */
+static struct
+{
+    uint8_t *data;
+    uint8_t reg;
+    uint8_t len;                    // 尚未读出的字节数
+    volatile uint8_t step;          // FUSB302_HW_XFER_xxx
+} fusb302_hw_xfer;
+
+/**
+ * @brief       硬件IIC：等待事件，超时后发STOP并复位IIC控制器
+ * @param       event: I2C_EVENT_xxx
+ * @retval      0: 成功, 1: 超时或未应答
+ */
+static uint8_t fusb302_hw_wait(uint32_t event)
+{
+    uint16_t timeout = FUSB302_IIC_HW_TIMEOUT;
+
+    while (!I2C_CheckEvent(event))
+    {
+        if (I2C_GetFlagStatus(I2C_FLAG_AF) || (--timeout == 0))
+        {
+            I2C_ClearFlag(I2C_FLAG_AF);
+            I2C_GenerateSTOP(ENABLE);
+            I2C_AcknowledgeConfig(ENABLE);
+            I2C_NACKPositionConfig(I2C_NACKPosition_Current);
+            if (timeout == 0)
+            {
+                // 总线卡死时重新初始化，下次传输从空闲状态开始
+                I2C_Init(I2C_Mode_I2C, FUSB302_IIC_SPEED, I2C_DutyCycle_2, I2C_Ack_Enable, I2C_AckAddr_7bit, 0);
+                I2C_Cmd(ENABLE);
+            }
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief       硬件IIC：初始化，SCL/SDA使用默认引脚PB13/PB12
+ * @param       无
+ * @retval      无
+ */
+static void fusb302_hw_init(void)
+{
+    // I2C_Init()先软件复位控制器，同时关闭中断，未完成的中断传输就此中止
+    fusb302_hw_xfer.step = FUSB302_HW_XFER_IDLE;
+    GPIOB_ModeCfg(GPIO_Pin_12 | GPIO_Pin_13, GPIO_ModeIN_PU);
+    R16_PIN_ALTERNATE &= ~RB_PIN_I2C;
+    I2C_Init(I2C_Mode_I2C, FUSB302_IIC_SPEED, I2C_DutyCycle_2, I2C_Ack_Enable, I2C_AckAddr_7bit, 0);
+    I2C_Cmd(ENABLE);
+    PFIC_EnableIRQ(I2C_IRQn);
+}
+
+/**
+ * @brief       硬件IIC：起始信号+器件地址(写)+寄存器地址
+ * @param       reg: 寄存器地址
+ * @retval      0: 成功, 1: 失败
+ */
+static uint8_t fusb302_hw_addr(uint8_t reg)
+{
+    I2C_GenerateSTART(ENABLE);
+    if (fusb302_hw_wait(I2C_EVENT_MASTER_MODE_SELECT))
+        return 1;
+    I2C_Send7bitAddress(FUSB302_I2C_ADDR << 1, I2C_Direction_Transmitter);
+    if (fusb302_hw_wait(I2C_EVENT_MASTER_TRANSMITTER_MODE_SELECTED))
+        return 1;
+    I2C_SendData(reg);
+    return fusb302_hw_wait(I2C_EVENT_MASTER_BYTE_TRANSMITTING);
+}
+
+/**
+ * @brief       硬件IIC：从reg开始连续写
+ * @param       reg: 寄存器地址
+ * @param       data: 数据
+ * @param       len: 数据长度
+ * @retval      0: 成功, 1: 失败
+ */
+static uint8_t fusb302_hw_write(uint8_t reg, const uint8_t *data, uint8_t len)
+{
+    uint8_t i;
+
+    if (fusb302_hw_addr(reg))
+        return 1;
+    for (i = 0; i < len; i++)
+    {
+        I2C_SendData(data[i]);
+        if (fusb302_hw_wait(I2C_EVENT_MASTER_BYTE_TRANSMITTING))
+            return 1;
+    }
+    if (fusb302_hw_wait(I2C_EVENT_MASTER_BYTE_TRANSMITTED))
+        return 1;
+    I2C_GenerateSTOP(ENABLE);
+
+    return 0;
+}
+
+/**
+ * @brief       硬件IIC：从reg开始连续读
+ *              最后两字节用BTF等待（时钟被拉低），保证在收到最后一字节前关闭ACK、发出STOP，
+ *              不依赖中断延迟；1字节和2字节读取按手册的特殊流程处理
+ * @param       reg: 寄存器地址
+ * @param       data: 接收缓冲区
+ * @param       len: 读取长度，不能为0
+ * @retval      0: 成功, 1: 失败
+ */
+static uint8_t fusb302_hw_read(uint8_t reg, uint8_t *data, uint8_t len)
+{
+    if (fusb302_hw_addr(reg))
+        return 1;
+
+    I2C_GenerateSTART(ENABLE); // Repeated START
+    if (fusb302_hw_wait(I2C_EVENT_MASTER_MODE_SELECT))
+        return 1;
+    if (len == 2)
+    {
+        I2C_NACKPositionConfig(I2C_NACKPosition_Next);
+    }
+    I2C_Send7bitAddress(FUSB302_I2C_ADDR << 1, I2C_Direction_Receiver);
+
+    if (len == 1)
+    {
+        I2C_AcknowledgeConfig(DISABLE);
+        if (fusb302_hw_wait(I2C_EVENT_MASTER_RECEIVER_MODE_SELECTED))
+            return 1;
+        I2C_GenerateSTOP(ENABLE);
+        if (fusb302_hw_wait(I2C_EVENT_MASTER_BYTE_RECEIVED))
+            return 1;
+        data[0] = I2C_ReceiveData();
+    }
+    else
+    {
+        if (fusb302_hw_wait(I2C_EVENT_MASTER_RECEIVER_MODE_SELECTED))
+            return 1;
+        if (len == 2)
+        {
+            I2C_AcknowledgeConfig(DISABLE); // 作用于第2字节
+        }
+        while (len > 3)
+        {
+            if (fusb302_hw_wait(I2C_EVENT_MASTER_BYTE_RECEIVED))
+                return 1;
+            *data++ = I2C_ReceiveData();
+            len--;
+        }
+        if (len == 3)
+        {
+            if (fusb302_hw_wait(I2C_FLAG_BTF & FLAG_Mask))
+                return 1;
+            I2C_AcknowledgeConfig(DISABLE);
+            *data++ = I2C_ReceiveData();
+        }
+        if (fusb302_hw_wait(I2C_FLAG_BTF & FLAG_Mask))
+            return 1;
+        I2C_GenerateSTOP(ENABLE);
+        data[0] = I2C_ReceiveData();
+        data[1] = I2C_ReceiveData();
+        I2C_NACKPositionConfig(I2C_NACKPosition_Current);
+    }
+    I2C_AcknowledgeConfig(ENABLE);
+
+    return 0;
+}
+
+/**
+ * @brief       硬件IIC：启动中断方式的连续读，各步骤在I2C_IRQHandler中完成
+ *              与阻塞读取相同，最后两字节用BTF中断（时钟被拉低）关闭ACK、发出STOP，不依赖中断延迟
+ * @param       reg: 寄存器地址
+ * @param       data: 接收缓冲区，传输结束前不能使用
+ * @param       len: 读取长度，不能为0
+ * @retval      0: 已启动, 1: 总线忙或上一次传输未结束
+ */
+static uint8_t fusb302_hw_read_start(uint8_t reg, uint8_t *data, uint8_t len)
+{
+    if ((len == 0) || (fusb302_hw_xfer.step != FUSB302_HW_XFER_IDLE) || I2C_GetFlagStatus(I2C_FLAG_BUSY))
+        return 1;
+
+    fusb302_hw_xfer.data = data;
+    fusb302_hw_xfer.reg = reg;
+    fusb302_hw_xfer.len = len;
+    fusb302_hw_xfer.step = FUSB302_HW_XFER_ADDR_W;
+    I2C_ITConfig(I2C_IT_EVT | I2C_IT_ERR, ENABLE);
+    I2C_GenerateSTART(ENABLE);
+
+    return 0;
+}
+
+/**
+ * @brief       硬件IIC：结束中断传输，关闭中断并恢复ACK设置
+ * @param       status: 0=成功, 1=失败
+ * @retval      无
+ */
+__HIGH_CODE
+static void fusb302_hw_xfer_end(uint8_t status)
+{
+    I2C_ITConfig(I2C_IT_BUF | I2C_IT_EVT | I2C_IT_ERR, DISABLE);
+    if (status)
+    {
+        I2C_GenerateSTOP(ENABLE);
+    }
+    I2C_AcknowledgeConfig(ENABLE);
+    I2C_NACKPositionConfig(I2C_NACKPosition_Current);
+    fusb302_hw_xfer.step = FUSB302_HW_XFER_IDLE;
+    fusb302_iic_xfer_done(status);
+}
+
+/**
+ * @brief       IIC中断：推进fusb302_hw_read_start()启动的读取
+ *              事件标志按步骤检查，不属于当前步骤的标志留给下一次中断
+ * @param       无
+ * @retval      无
+ */
+__INTERRUPT
+__HIGH_CODE
+void I2C_IRQHandler(void)
+{
+    uint16_t sr1 = R16_I2C_STAR1;
+
+    if (sr1 & (RB_I2C_AF | RB_I2C_BERR | RB_I2C_ARLO | RB_I2C_OVR))
+    {
+        I2C_ClearFlag(I2C_FLAG_AF | I2C_FLAG_BERR | I2C_FLAG_ARLO | I2C_FLAG_OVR);
+        if (fusb302_hw_xfer.step != FUSB302_HW_XFER_IDLE)
+        {
+            fusb302_hw_xfer_end(1);
+        }
+        return;
+    }
+
+    switch (fusb302_hw_xfer.step)
+    {
+    case FUSB302_HW_XFER_ADDR_W:
+        if (sr1 & RB_I2C_SB)
+        {
+            I2C_Send7bitAddress(FUSB302_I2C_ADDR << 1, I2C_Direction_Transmitter);
+            fusb302_hw_xfer.step = FUSB302_HW_XFER_REG;
+        }
+        break;
+
+    case FUSB302_HW_XFER_REG:
+        if (sr1 & RB_I2C_ADDR)
+        {
+            (void)R16_I2C_STAR2; // 读STAR1后读STAR2清ADDR
+            I2C_SendData(fusb302_hw_xfer.reg);
+            fusb302_hw_xfer.step = FUSB302_HW_XFER_RESTART;
+        }
+        break;
+
+    case FUSB302_HW_XFER_RESTART:
+        if (sr1 & RB_I2C_BTF)
+        {
+            I2C_GenerateSTART(ENABLE); // Repeated START
+            fusb302_hw_xfer.step = FUSB302_HW_XFER_ADDR_R;
+        }
+        break;
+
+    case FUSB302_HW_XFER_ADDR_R:
+        if (sr1 & RB_I2C_SB)
+        {
+            if (fusb302_hw_xfer.len == 2)
+            {
+                I2C_NACKPositionConfig(I2C_NACKPosition_Next);
+            }
+            I2C_Send7bitAddress(FUSB302_I2C_ADDR << 1, I2C_Direction_Receiver);
+            fusb302_hw_xfer.step = FUSB302_HW_XFER_ADDR_OK;
+        }
+        break;
+
+    case FUSB302_HW_XFER_ADDR_OK:
+        if (sr1 & RB_I2C_ADDR)
+        {
+            if (fusb302_hw_xfer.len == 1)
+            {
+                I2C_AcknowledgeConfig(DISABLE);
+                (void)R16_I2C_STAR2;
+                I2C_GenerateSTOP(ENABLE);
+            }
+            else
+            {
+                (void)R16_I2C_STAR2;
+                if (fusb302_hw_xfer.len == 2)
+                {
+                    I2C_AcknowledgeConfig(DISABLE); // 作用于第2字节
+                }
+            }
+            // 1字节和多于3字节时逐字节用RXNE中断读取，最后3字节改用BTF
+            if ((fusb302_hw_xfer.len == 1) || (fusb302_hw_xfer.len > 3))
+            {
+                I2C_ITConfig(I2C_IT_BUF, ENABLE);
+            }
+            fusb302_hw_xfer.step = FUSB302_HW_XFER_RECV;
+        }
+        break;
+
+    case FUSB302_HW_XFER_RECV:
+        if (fusb302_hw_xfer.len == 1)
+        {
+            if (sr1 & RB_I2C_RxNE)
+            {
+                fusb302_hw_xfer.data[0] = I2C_ReceiveData();
+                fusb302_hw_xfer_end(0);
+            }
+        }
+        else if (fusb302_hw_xfer.len > 3)
+        {
+            if (sr1 & RB_I2C_RxNE)
+            {
+                *fusb302_hw_xfer.data++ = I2C_ReceiveData();
+                if (--fusb302_hw_xfer.len == 3)
+                {
+                    I2C_ITConfig(I2C_IT_BUF, DISABLE);
+                }
+            }
+        }
+        else if (sr1 & RB_I2C_BTF)
+        {
+            if (fusb302_hw_xfer.len == 3)
+            {
+                I2C_AcknowledgeConfig(DISABLE);
+                *fusb302_hw_xfer.data++ = I2C_ReceiveData();
+                fusb302_hw_xfer.len = 2;
+            }
+            else
+            {
+                I2C_GenerateSTOP(ENABLE);
+                fusb302_hw_xfer.data[0] = I2C_ReceiveData();
+                fusb302_hw_xfer.data[1] = I2C_ReceiveData();
+                fusb302_hw_xfer_end(0);
+            }
+        }
+        break;
+
+    default:
+        // 没有传输时不应有中断，关闭以免反复进入
+        I2C_ITConfig(I2C_IT_BUF | I2C_IT_EVT | I2C_IT_ERR, DISABLE);
+        break;
+    }
+}
+
+const fusb302_iic_ops_t fusb302_iic_hw_ops =
+    {
+        fusb302_hw_init,
+        fusb302_hw_write,
+        fusb302_hw_read,
+        fusb302_hw_read_start,
+};
+
+#if FUSB302_IIC_HW
+static const fusb302_iic_ops_t *fusb302_iic = &fusb302_iic_hw_ops;
+#else
+static const fusb302_iic_ops_t *fusb302_iic = &fusb302_iic_soft_ops;
+#endif
+
+/**
+ * @brief       切换IIC传输方式并初始化
+ * @param       ops: fusb302_iic_hw_ops / fusb302_iic_soft_ops 或其他实现
+ * @retval      无
+ */
+void fusb302_iic_set_ops(const fusb302_iic_ops_t *ops)
+{
+    if (fusb302_iic == &fusb302_iic_hw_ops)
+    {
+        PFIC_DisableIRQ(I2C_IRQn);
+        I2C_Cmd(DISABLE);
+    }
+    fusb302_iic = ops;
+    fusb302_iic->init();
+}
+
+static void (*fusb302_iic_done_cb)(void) = NULL;
+static volatile uint8_t fusb302_iic_xfer_status = 0;
+
+/**
+ * @brief       中断方式读取结束，由传输实现在中断上下文中调用
+ * @param       status: 0=成功, 1=失败
+ * @retval      无
+ */
+__HIGH_CODE
+void fusb302_iic_xfer_done(uint8_t status)
+{
+    fusb302_iic_xfer_status = status;
+    if (fusb302_iic_done_cb)
+    {
+        fusb302_iic_done_cb();
+    }
+}
+
+/**
+ * @brief       设置中断方式读取结束回调，回调在中断上下文中调用，应只置标志
+ * @param       cb: 回调函数，NULL表示取消
+ * @retval      无
+ */
+void fusb302_iic_set_done_callback(void (*cb)(void))
+{
+    fusb302_iic_done_cb = cb;
+}
+
 /**
  * @brief       初始化IIC接口
+ *              使用硬件IIC时先读一次芯片ID，读取失败则退回GPIO模拟
  * @param       无
  * @retval      无
  */
 void fusb302_iic_init(void)
 {
-    fusb302_iic_stop();
+    uint8_t id;
+
+    fusb302_iic->init();
+    if ((fusb302_iic == &fusb302_iic_hw_ops) && fusb302_iic->read(0x01, &id, 1))
+    {
+        printf("FUSB302 hardware IIC failed, use GPIO IIC\n");
+        fusb302_iic_set_ops(&fusb302_iic_soft_ops);
+    }
 }
 
 /**
- * @brief   解析PD档位信息
+ * @brief   解码PD档位（固定、电池、可变电源和PPS）
+ *          固定电源 min_mv=max_mv；电池型只给出功率，max_ma按最高电压折算；
+ *          PPS的电压单位为100mV、电流单位为50mA
+ * @param   index: 档位索引(0~6)
+ * @param   pdo: 解码结果
+ * @return  0=成功, 1=无效索引或不支持的APDO
+ */
+uint8_t USB302_Decode_PDO(uint8_t index, USB302_PDO_TypeDef *pdo)
+{
+    uint8_t *pdc;
+    uint32_t raw;
+
+    if (index >= PD_Source_Capabilities_Inf_num || index >= 7)
+    {
+        return 1; // 无效索引
+    }
+
+    pdc = PD_Source_Capabilities_Inf[index].PDC_INF;
+    raw = pdc[0] | ((uint32_t)pdc[1] << 8) | ((uint32_t)pdc[2] << 16) | ((uint32_t)pdc[3] << 24);
+    pdo->type = raw >> 30; // bit30-31表示电源类型
+
+    switch (pdo->type)
+    {
+    case USB302_PDO_FIXED:
+        pdo->max_mv = ((raw >> 10) & 0x3FF) * 50;
+        pdo->min_mv = pdo->max_mv;
+        pdo->max_ma = (raw & 0x3FF) * 10;
+        pdo->max_mw = (uint32_t)pdo->max_mv * pdo->max_ma / 1000;
+        break;
+
+    case USB302_PDO_BATTERY:
+        pdo->max_mv = ((raw >> 20) & 0x3FF) * 50;
+        pdo->min_mv = ((raw >> 10) & 0x3FF) * 50;
+        pdo->max_mw = (raw & 0x3FF) * 250;
+        pdo->max_ma = pdo->max_mv ? (uint16_t)(pdo->max_mw * 1000 / pdo->max_mv) : 0;
+        break;
+
+    case USB302_PDO_VARIABLE:
+        pdo->max_mv = ((raw >> 20) & 0x3FF) * 50;
+        pdo->min_mv = ((raw >> 10) & 0x3FF) * 50;
+        pdo->max_ma = (raw & 0x3FF) * 10;
+        pdo->max_mw = (uint32_t)pdo->min_mv * pdo->max_ma / 1000;
+        break;
+
+    default: // APDO
+        if ((raw >> 28) & 0x03)
+        {
+            return 1; // 只支持SPR PPS
+        }
+        pdo->max_mv = ((raw >> 17) & 0xFF) * 100;
+        pdo->min_mv = ((raw >> 8) & 0xFF) * 100;
+        pdo->max_ma = (raw & 0x7F) * 50;
+        pdo->max_mw = (uint32_t)pdo->max_mv * pdo->max_ma / 1000;
+        break;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief   解析PD档位信息（仅固定电源）
  * @param   index: 档位索引(0~6)
  * @param   voltage_mv: 输出电压(mV)
  * @param   current_ma: 输出电流(mA)
- * @return  0=成功, 1=无效索引
+ * @return  0=成功, 1=无效索引或非固定电源
  */
 uint8_t USB302_Parse_PDO(uint8_t index, uint16_t *voltage_mv, uint16_t *current_ma)
 {
-    if (index >= PD_Source_Capabilities_Inf_num || index >= 7)
+    USB302_PDO_TypeDef pdo;
+
+    if (USB302_Decode_PDO(index, &pdo) || (pdo.type != USB302_PDO_FIXED))
     {
-        return 1; // 无效索引
+        return 1;
+    }
+    *voltage_mv = pdo.max_mv;
+    *current_ma = pdo.max_ma;
+
+    return 0;
+}
+
+/**
+ * @brief   计算PPS请求电压：正向电压 + 余量，限制在档位范围内并对齐到20mV
+ * @param   pdo: PPS档位
+ * @return  请求电压(mV)
+ */
+uint16_t USB302_PPS_Voltage(const USB302_PDO_TypeDef *pdo)
+{
+    uint32_t mv = USB302_PPS_VF_MV + USB302_PPS_HEADROOM_MV;
+
+    if (mv < pdo->min_mv)
+        mv = pdo->min_mv;
+    if (mv > pdo->max_mv)
+        mv = pdo->max_mv;
+
+    return (uint16_t)(mv / USB302_PPS_STEP_MV * USB302_PPS_STEP_MV);
+}
+
+/**
+ * @brief   按LED负载要求选择档位：电压窗口USB302_LOAD_MIN_MV~USB302_LOAD_MAX_MV，
+ *          电流不小于USB302_LOAD_MIN_MA，在满足条件的档位中选可用功率最大的
+ *          - PPS（USB302_PPS_ENABLE=1）：输出范围覆盖LED所需电压（正向电压+余量）时优先选择，
+ *            多个时取电流大的，请求电压固定，不随亮度变化
+ *          - 固定电源：电压在窗口内
+ *          - 可变/电池：整个输出范围都在窗口内（电压由电源决定），功率按最不利的一端计算
+ *          功率相同时取序号小的；都不满足时请求第1档(5V)并置Capability Mismatch
+ * @param   req: 选择结果
+ * @return  0=找到满足要求的档位, 1=没有
+ */
+uint8_t USB302_Select_PDO(USB302_Request_TypeDef *req)
+{
+    USB302_PDO_TypeDef pdo;
+    uint32_t best_mw = 0;
+    uint8_t i;
+
+    req->position = 0;
+#if USB302_PPS_ENABLE
+    for (i = 0; i < PD_Source_Capabilities_Inf_num; i++)
+    {
+        if (USB302_Decode_PDO(i, &pdo) || (pdo.type != USB302_PDO_APDO))
+            continue;
+        if ((pdo.min_mv > USB302_PPS_VF_MV + USB302_PPS_HEADROOM_MV) ||
+            (pdo.max_mv < USB302_PPS_VF_MV + USB302_PPS_HEADROOM_MV))
+            continue;
+        if ((pdo.max_ma < USB302_LOAD_MIN_MA) || (req->position && (pdo.max_ma <= req->current_ma)))
+            continue;
+        req->position = i + 1;
+        req->type = pdo.type;
+        req->voltage_mv = USB302_PPS_Voltage(&pdo);
+        req->current_ma = pdo.max_ma;
+        req->power_mw = (uint32_t)req->voltage_mv * pdo.max_ma / 1000;
+    }
+    if (req->position)
+    {
+        req->mismatch = 0;
+        return 0;
+    }
+#endif
+    for (i = 0; i < PD_Source_Capabilities_Inf_num; i++)
+    {
+        if (USB302_Decode_PDO(i, &pdo) || (pdo.type == USB302_PDO_APDO))
+            continue;
+        if ((pdo.min_mv < USB302_LOAD_MIN_MV) || (pdo.max_mv > USB302_LOAD_MAX_MV))
+            continue;
+        if (pdo.max_ma < USB302_LOAD_MIN_MA)
+            continue;
+        if (pdo.max_mw > best_mw)
+        {
+            best_mw = pdo.max_mw;
+            req->position = i + 1;
+            req->type = pdo.type;
+            req->voltage_mv = pdo.min_mv;
+            req->current_ma = pdo.max_ma;
+            req->power_mw = pdo.max_mw;
+        }
+    }
+    req->mismatch = 0;
+    if (req->position)
+    {
+        return 0;
     }
 
-    uint8_t *pdc = PD_Source_Capabilities_Inf[index].PDC_INF;
-
-    /* 检查是否为FIXED电源类型 (bit30-31 == 0) */
-    if ((pdc[3] & 0xC0) != 0)
+    req->mismatch = 1;
+    if (USB302_Decode_PDO(0, &pdo))
     {
-        return 1; // 非FIXED类型
+        return 1;
     }
-
-    /* 解析电压 (50mV单位) */
-    uint16_t vol = ((pdc[2] & 0x0F) << 8) | (pdc[1] & 0xFC);
-    vol >>= 2;
-    *voltage_mv = vol * 50;
-
-    /* 解析电流 (10mA单位) */
-    uint16_t cur = ((pdc[1] & 0x03) << 8) | pdc[0];
-    *current_ma = cur * 10;
-
-    return 0;
+    req->position = 1; // 第1档总是vSafe5V固定电源
+    req->type = pdo.type;
+    req->voltage_mv = pdo.max_mv;
+    req->current_ma = pdo.max_ma;
+    req->power_mw = pdo.max_mw;
+    return 1;
 }
 
 const uint8_t PD_Resq[14] =
     {
         TokenTx_SOP1, TokenTx_SOP1, TokenTx_SOP1, TokenTx_SOP2, TokenTx_PACKSYM + 6,
-        0x42, 0x14,
+        0x42, 0x10,
         0x00, 0x00, 0x00, 0x03,
         0xff, 0x14, 0xA1};
 
 /**
  * @brief       读FUSB302寄存器
  * @param       reg: 寄存器地址
- * @retval      读取到的寄存器值
+ * @retval      读取到的寄存器值，通信失败时为0xFF
  */
 uint8_t fusb302_iic_read_reg(uint8_t reg)
 {
     uint8_t val;
 
-    fusb302_iic_start();
-    fusb302_iic_send_byte((FUSB302_I2C_ADDR << 1) | FUSB302_IIC_WRITE);
-    fusb302_iic_wait_ack();
-    fusb302_iic_send_byte(reg);
-    fusb302_iic_wait_ack();
-
-    fusb302_iic_start(); // Repeated START
-    fusb302_iic_send_byte((FUSB302_I2C_ADDR << 1) | FUSB302_IIC_READ);
-    fusb302_iic_wait_ack();
+    if (fusb302_iic->read(reg, &val, 1))
+    {
+        val = 0xFF;
+    }
 
-    val = fusb302_iic_recv_byte(0); // NACK for last byte
+    return val;
+}
 
-    fusb302_iic_stop();
+/**
+ * @brief       从reg开始连续读多个寄存器（地址自动递增，0x43 FIFO除外）
+ * @param       reg: 起始寄存器地址
+ * @param       buf: 接收缓冲区
+ * @param       len: 读取长度
+ * @retval      0: 成功, 1: 失败
+ */
+uint8_t fusb302_iic_read_regs(uint8_t reg, uint8_t *buf, uint8_t len)
+{
+    if (len == 0)
+        return 0;
 
-    return val;
+    return fusb302_iic->read(reg, buf, len);
 }
 
 /* 兼容旧函数名 */
@@ -268,18 +920,7 @@ uint8_t USB302_Read_Reg(uint8_t REG_ADDR)
  */
 uint8_t fusb302_iic_write_reg(uint8_t reg, uint8_t val)
 {
-    uint8_t ret;
-
-    fusb302_iic_start();
-    fusb302_iic_send_byte((FUSB302_I2C_ADDR << 1) | FUSB302_IIC_WRITE);
-    fusb302_iic_wait_ack();
-    fusb302_iic_send_byte(reg);
-    fusb302_iic_wait_ack();
-    fusb302_iic_send_byte(val);
-    ret = fusb302_iic_wait_ack();
-    fusb302_iic_stop();
-
-    return ret;
+    return fusb302_iic->write(reg, &val, 1);
 }
 
 /* 兼容旧函数名 */
@@ -296,27 +937,10 @@ void USB302_Wite_Reg(uint8_t addr, uint8_t val)
  */
 void fusb302_iic_read_fifo(uint8_t *pBuf, uint8_t len)
 {
-    uint8_t buf_index;
-    const uint8_t FIFO_ADDR = 0x43;
-
-    fusb302_iic_start();
-    fusb302_iic_send_byte((FUSB302_I2C_ADDR << 1) | FUSB302_IIC_WRITE);
-    fusb302_iic_wait_ack();
-    fusb302_iic_send_byte(FIFO_ADDR);
-    fusb302_iic_wait_ack();
-
-    fusb302_iic_start(); // Repeated START
-    fusb302_iic_send_byte((FUSB302_I2C_ADDR << 1) | FUSB302_IIC_READ);
-    fusb302_iic_wait_ack();
-
-    for (buf_index = 0; buf_index < len - 1; buf_index++)
-    {
-        pBuf[buf_index] = fusb302_iic_recv_byte(1); // ACK
-    }
-
-    pBuf[buf_index] = fusb302_iic_recv_byte(0); // NACK for last byte
+    if (len == 0)
+        return;
 
-    fusb302_iic_stop();
+    fusb302_iic->read(0x43, pBuf, len);
 }
 
 /* 兼容旧函数名 */
@@ -333,25 +957,10 @@ void USB302_Read_FIFO(uint8_t *pBuf, uint8_t len)
  */
 void fusb302_iic_write_fifo(uint8_t *data, uint8_t length)
 {
-    uint8_t i;
-    const uint8_t FIFO_ADDR = 0x43;
-
     if (length == 0)
         return;
 
-    fusb302_iic_start();
-    fusb302_iic_send_byte((FUSB302_I2C_ADDR << 1) | FUSB302_IIC_WRITE);
-    fusb302_iic_wait_ack();
-    fusb302_iic_send_byte(FIFO_ADDR);
-    fusb302_iic_wait_ack();
-
-    for (i = 0; i < length; i++)
-    {
-        fusb302_iic_send_byte(data[i]);
-        fusb302_iic_wait_ack();
-    }
-
-    fusb302_iic_stop();
+    fusb302_iic->write(0x43, data, length);
 }
 
 /* 兼容旧函数名 */
@@ -397,32 +1006,58 @@ void Check_USB302(void)
     printf("=======================================\n\n");
 }
 
-// 检测cc脚上是否有连接
-// 返回 0 失败， 1 成功
-uint8_t USB302_Chech_CCx(void)
+/**
+ * @brief       复位FUSB302（PD逻辑和全部寄存器），之后需等待5ms再访问
+ * @param       无
+ * @retval      无
+ */
+void USB302_Reset(void)
 {
-    uint8_t Read_State;
     USB302_Wite_Reg(0x0C, 0x02); // PD Reset
     USB302_Wite_Reg(0x0C, 0x03); // Reset FUSB302
-    DelayMs(5);
-    USB302_Wite_Reg(0x0B, 0x0F); // FULL POWER!
-    USB302_Wite_Reg(0x02, 0x07); // Switch on MEAS_CC1
-    DelayMs(2);
+}
+
+/**
+ * @brief       开始测量CC脚电压，等待2ms后调用USB302_Meas_CC_Read()取结果
+ * @param       cc: 1=CC1, 2=CC2
+ * @retval      无
+ */
+void USB302_Meas_CC_Start(uint8_t cc)
+{
+    USB302_Wite_Reg(0x0B, 0x0F);                    // FULL POWER!
+    USB302_Wite_Reg(0x02, (cc == 1) ? 0x07 : 0x0B); // Switch on MEAS_CC1 / MEAS_CC2
+}
+
+/**
+ * @brief       读取CC脚测量结果并恢复初始状态
+ * @param       无
+ * @retval      1: 主机在该CC脚上有电压, 0: 无
+ */
+uint8_t USB302_Meas_CC_Read(void)
+{
+    uint8_t Read_State;
     Read_State = USB302_Read_Reg(0x40); // 读状态
     USB302_Wite_Reg(0x02, 0x03);        // 切换到初始状态
     Read_State &= 0x03;                 // 只看低2位 看主机有没有电压
-    if (Read_State > 0)
+    return (Read_State > 0) ? 1 : 0;
+}
+
+// 检测cc脚上是否有连接
+// 返回 0 失败， 1 成功
+uint8_t USB302_Chech_CCx(void)
+{
+    USB302_Reset();
+    DelayMs(5);
+    USB302_Meas_CC_Start(1);
+    DelayMs(2);
+    if (USB302_Meas_CC_Read())
     {
         CCx_PIN_Useful = 1;
         return 1;
     }
-    USB302_Wite_Reg(0x02, 0x0B); // Switch on MEAS_CC2
+    USB302_Meas_CC_Start(2);
     DelayMs(2);
-    Read_State = USB302_Read_Reg(0x40); // 读状态
-    USB302_Wite_Reg(0x02, 0x03);        // 切换到初始状态
-    Read_State &= 0x03;                 // 只看低2位 看主机有没有电压
-
-    if (Read_State > 0)
+    if (USB302_Meas_CC_Read())
     {
         CCx_PIN_Useful = 2;
         return 1;
@@ -430,15 +1065,26 @@ uint8_t USB302_Chech_CCx(void)
     return 0;
 }
 
-// 返回 0 失败， 1 成功
-uint8_t USB302_Init(void)
+/**
+ * @brief       在检测到的CC脚上开始连接：发送硬件复位包并复位芯片，
+ *              等待5ms后调用USB302_Attach_Config()
+ * @param       cc: 1=CC1, 2=CC2
+ * @retval      无
+ */
+void USB302_Attach_Start(uint8_t cc)
 {
-    printf("Checking PD UFP..\n");
-    if (USB302_Chech_CCx() == 0)
-        return 0;                // 检查有没有接着设备
+    CCx_PIN_Useful = cc;
     USB302_Wite_Reg(0x09, 0x40); // 发送硬件复位包
     USB302_Wite_Reg(0x0C, 0x03); // Reset FUSB302
-    DelayMs(5);
+}
+
+/**
+ * @brief       连接配置：中断、CC脚测量和BMC发送，清空协商状态等待Source_Capabilities
+ * @param       无
+ * @retval      无
+ */
+void USB302_Attach_Config(void)
+{
     USB302_Wite_Reg(0x09, 0x07); // 使能自动重试 3次自动重试
     USB302_Wite_Reg(0x0E, 0xFC); // 使能各种中断
     // USB302_Wite_Reg(0x0F, 0xFF);
@@ -461,32 +1107,89 @@ uint8_t USB302_Init(void)
                                      // USB302_Wite_Reg(0x03, 0x46); // Enable BMC Tx on_CC1 PD3.0 AutoCRC
     }
     USB302_Wite_Reg(0x0B, 0x0F); // 全电源
-    USB302_Read_Reg(0x3E);
-    USB302_Read_Reg(0x3F);
-    USB302_Read_Reg(0x42);
+    FUSB30XRefreshStatusRegister();
     RX_Length = 0;
     PD_STEP = 0;
+    PD_MSG_ID = 0;
     PD_Source_Capabilities_Inf_num = 0;
     /*  USB302_Wite_Reg(0x07, 0x04); // Flush RX*/
+}
+
+/**
+ * @brief       连接后检查CC脚是否仍有电压（连接配置后芯片持续测量所用CC脚）
+ * @param       无
+ * @retval      1: 仍连接, 0: CC脚电压消失
+ */
+uint8_t USB302_CC_Attached(void)
+{
+    // 只读STATUS0，不读中断寄存器，以免清掉INT脚上待处理的消息中断
+    return (USB302_Read_Reg(FUSB302_REG_STATUS0) & 0x03) ? 1 : 0; // STATUS0.BC_LVL
+}
+
+// 返回 0 失败， 1 成功
+uint8_t USB302_Init(void)
+{
+    printf("Checking PD UFP..\n");
+    if (USB302_Chech_CCx() == 0)
+        return 0; // 检查有没有接着设备
+    USB302_Attach_Start(CCx_PIN_Useful);
+    DelayMs(5);
+    USB302_Attach_Config();
     return 1;
 }
 
+/**
+ * @brief       一次读出0x3C~0x42全部状态/中断寄存器存入USB302_Status（同时清中断）
+ *              通信失败时缓存清零，按无中断、无消息处理
+ * @param       无
+ * @retval      无
+ */
+static void USB302_Status_Failed(void)
+{
+    memset(USB302_Status, 0, sizeof(USB302_Status));
+    USB302_STATUS(FUSB302_REG_STATUS1) = 0x20; // RX_EMPTY
+}
+
 void FUSB30XRefreshStatusRegister(void)
 {
-    USB302_Read_Reg(0x3E);
-    USB302_Read_Reg(0x3F);
-    USB302_Read_Reg(0x42); // 清中断
+    if (fusb302_iic_read_regs(FUSB302_REG_STATUS0A, USB302_Status, FUSB302_STATUS_NUM))
+    {
+        USB302_Status_Failed();
+    }
 }
-void USB302_Read_Service(void) // 读取服务
+
+/**
+ * @brief       检查已读出的令牌 + header，计算之后的数据对象和CRC字节数
+ * @param       无
+ * @retval      剩余字节数，令牌无效时为0
+ */
+static uint8_t USB302_Rx_Size(void)
 {
     uint8_t readSize;
-    FUSB30XRefreshStatusRegister(); // 清中断
-    USB302_RX_Buff[0] = USB302_Read_Reg(0x43) & 0xe0;
+
+    USB302_RX_Buff[0] &= 0xe0;
     if (USB302_RX_Buff[0] > 0x40)                   // E0 C0 A0 80 60 都是允许的值
     {                                               // 小端 高8位后来
-        USB302_Read_FIFO(USB302_RX_Buff + 1, 2);    // read header
         readSize = USB302_RX_Buff[2] & 0x70;        // 取数量位 报告了有几组电压的意思
         readSize = ((readSize >> 4) & 0x7) * 4 + 4; // 每个电压报告组有4字节 32bit
+        return readSize;
+    }
+    return 0;
+}
+
+void USB302_Read_Service(void) // 读取服务
+{
+    uint8_t readSize;
+    FUSB30XRefreshStatusRegister(); // 清中断
+    if (USB302_STATUS(FUSB302_REG_STATUS1) & 0x20) // STATUS1.RX_EMPTY：没有收到消息，不必读FIFO
+    {
+        RX_Length = 0;
+        return;
+    }
+    USB302_Read_FIFO(USB302_RX_Buff, 3); // 令牌 + header，FIFO地址不递增
+    readSize = USB302_Rx_Size();
+    if (readSize)
+    {
         RX_Length = readSize + 3;
         USB302_Read_FIFO(USB302_RX_Buff + 3, readSize);
     }
@@ -501,106 +1204,284 @@ void PD_Msg_ID_ADD(void) // 成功通讯多少次，也就是收到goodcrc的次
     if (PD_MSG_ID > 7)
         PD_MSG_ID = 0;
 }
-void USB302_Data_Service(void) // 数据服务
+/**
+ * @brief       处理USB302_Read_Service()或中断方式收包读出的状态和消息
+ * @param       无
+ * @retval      无
+ */
+static void USB302_Rx_Process(void)
 {
     uint8_t i;
-    uint8_t j = 0;
-    if (READ_FUSB30X_INT == 0)
+    if (USB302_STATUS(FUSB302_REG_INTERRUPTA) & 0x01) // I_HARDRST：电源端硬复位，重新等待Source_Capabilities
     {
-        USB302_Read_Service();
-        if (RX_Length >= 5) // 至少要读得5个包
+        printf("HRST\n");
+        PD_STEP = 0;
+        PD_MSG_ID = 0;
+        PD_Source_Capabilities_Inf_num = 0;
+        USB302_Wite_Reg(0x0C, 0x02); // Reset PD
+        return;
+    }
+    if (RX_Length >= 5) // 至少要读得5个包
+    {
+        PD_Msg_ID_ADD();
+        i = USB302_RX_Buff[2] & 0x70; // bit14~12表示控制消息还是数据消息，控制消息为0，非零为数据消息，表示包含的电压种类
+        if (i == 0)                   // 控制消息
         {
-            PD_Msg_ID_ADD();
-            i = USB302_RX_Buff[2] & 0x70; // bit14~12表示控制消息还是数据消息，控制消息为0，非零为数据消息，表示包含的电压种类
-            if (i == 0)                   // 控制消息
+            // printf("control message\r\n");
+            i = (USB302_RX_Buff[1] & 0x07); // 获取包类型
+            switch (i)
             {
-                // printf("control message\r\n");
-                i = (USB302_RX_Buff[1] & 0x07); // 获取包类型
-                switch (i)
-                {
-                case 1:              // GoodCRC
-                    printf("CRC\n"); // GoodCRCGoodCRC
-                    break;
-                case 3:              // Accept
-                    printf("ASK\n"); // Accept
-                    break;
-                case 4:              // Reject
-                    printf("NAK\n"); // Reject
-                    break;
-                case 6:              // PS_RDY
-                    printf("RDY\n"); // PS_RDY
-                    break;
-                case 8: // Get_Sink_Cap  必须回复点东西
-                    DelayMs(1);
-                    break;
-                default:
-                    break;
-                }
+            case 1:              // GoodCRC
+                printf("CRC\n"); // GoodCRCGoodCRC
+                break;
+            case 3:              // Accept
+                printf("ASK\n"); // Accept
+                break;
+            case 4:              // Reject
+                printf("NAK\n"); // Reject
+                break;
+            case 6:              // PS_RDY
+                printf("RDY\n"); // PS_RDY
+                break;
+            case 8: // Get_Sink_Cap  必须回复点东西
+                DelayMs(1);
+                break;
+            default:
+                break;
             }
-            else // 数据消息
+        }
+        else // 数据消息
+        {
+            // printf("data message\r\n");
+            if ((USB302_RX_Buff[1] & 0x07) == 0x01) // Source_Capabilities
             {
-                // printf("data message\r\n");
-                if ((USB302_RX_Buff[1] & 0x07) == 0x01) // Source_Capabilities
+                if (PD_STEP == 0)
                 {
-                    if (PD_STEP == 0)
+                    i = USB302_RX_Buff[1] & 0xC0; // bit7~6表示PD的版本
+                    i >>= 1;
+                    if (CCx_PIN_Useful == 1) // 调整PD版本
                     {
-                        i = USB302_RX_Buff[1] & 0xC0; // bit7~6表示PD的版本
-                        i >>= 1;
-                        if (CCx_PIN_Useful == 1) // 调整PD版本
-                        {
-                            i |= 0x05;
-                        }
-                        else if (CCx_PIN_Useful == 2)
-                        {
-                            i |= 0x06;
-                        }
-
-                        USB302_Wite_Reg(0x03, i);
-                        USB302_Wite_Reg(0x0C, 0x02); // Reset PD
-                        USB302_Wite_Reg(0x07, 0x04);
-                        PD_STEP = 1;
-                        PD_MSG_ID = 0; // 现在开始正式从0开始记录
-                        return;
+                        i |= 0x05;
                     }
-                    i = USB302_RX_Buff[2] & 0x70; // bit14~12表示控制消息还是数据消息，控制消息为0，非零为数据消息，表示包含的电压种类
-                    i >>= 4;
-                    PD_Source_Capabilities_Inf_num = i;
-
-                    for (i = 0; i < PD_Source_Capabilities_Inf_num; i++)
+                    else if (CCx_PIN_Useful == 2)
                     {
-                        PD_Source_Capabilities_Inf[i].PDC_INF[0] = USB302_RX_Buff[4 * i + 3];
-                        PD_Source_Capabilities_Inf[i].PDC_INF[1] = USB302_RX_Buff[4 * i + 4];
-                        PD_Source_Capabilities_Inf[i].PDC_INF[2] = USB302_RX_Buff[4 * i + 5];
-                        PD_Source_Capabilities_Inf[i].PDC_INF[3] = USB302_RX_Buff[4 * i + 6];
-                        if ((PD_Source_Capabilities_Inf[i].PDC_INF[3] & 0xc0) == 0) // bit30-31表示电源类型，0表示FIXED电源，1表示电池，2表示可变电源，3表示PPS
-                            j++;
+                        i |= 0x06;
                     }
-                    PD_Source_Capabilities_Inf_num = j;
-                    printf("Adapter supports %d outputs\n", PD_Source_Capabilities_Inf_num);
-                    PD_STEP = 2;
+
+                    USB302_Wite_Reg(0x03, i);
+                    USB302_Wite_Reg(0x0C, 0x02); // Reset PD
+                    USB302_Wite_Reg(0x07, 0x04);
+                    PD_STEP = 1;
+                    PD_MSG_ID = 0; // 现在开始正式从0开始记录
+                    return;
+                }
+                i = USB302_RX_Buff[2] & 0x70; // bit14~12表示控制消息还是数据消息，控制消息为0，非零为数据消息，表示包含的电压种类
+                i >>= 4;
+                PD_Source_Capabilities_Inf_num = i; // 档位序号即请求中的object position，全部保存
+
+                for (i = 0; i < PD_Source_Capabilities_Inf_num; i++)
+                {
+                    PD_Source_Capabilities_Inf[i].PDC_INF[0] = USB302_RX_Buff[4 * i + 3];
+                    PD_Source_Capabilities_Inf[i].PDC_INF[1] = USB302_RX_Buff[4 * i + 4];
+                    PD_Source_Capabilities_Inf[i].PDC_INF[2] = USB302_RX_Buff[4 * i + 5];
+                    PD_Source_Capabilities_Inf[i].PDC_INF[3] = USB302_RX_Buff[4 * i + 6];
                 }
+                printf("Adapter supports %d outputs\n", PD_Source_Capabilities_Inf_num);
+                PD_STEP = 2;
             }
         }
     }
 }
 
-// 发送请求 要有objects 号
-void USB302_Send_Requse(uint8_t objects)
+void USB302_Data_Service(void) // 数据服务
+{
+    if (READ_FUSB30X_INT == 0)
+    {
+        USB302_Read_Service();
+        USB302_Rx_Process();
+    }
+}
+
+/* 中断方式收包的步骤 */
+#define USB302_RX_IDLE          0
+#define USB302_RX_STATUS        1   // 读0x3C~0x42
+#define USB302_RX_HEADER        2   // 读FIFO中的令牌 + header
+#define USB302_RX_PAYLOAD       3   // 读FIFO中的数据对象和CRC
+
+static uint8_t USB302_Rx_Step = USB302_RX_IDLE;
+
+/**
+ * @brief       启动收包的一次中断方式读取
+ * @param       step: 读取结束后的步骤
+ * @param       reg: 寄存器地址
+ * @param       buf: 接收缓冲区
+ * @param       len: 读取长度
+ * @retval      0: 已启动, 1: 启动失败
+ */
+static uint8_t USB302_Rx_Read(uint8_t step, uint8_t reg, uint8_t *buf, uint8_t len)
+{
+    if (fusb302_iic->read_start(reg, buf, len))
+        return 1;
+    USB302_Rx_Step = step;
+    return 0;
+}
+
+/**
+ * @brief       开始中断方式收包：启动状态寄存器的读取（同时清中断）
+ *              每次读取结束时调用fusb302_iic_set_done_callback()设置的回调，
+ *              之后在任务中调用USB302_Rx_Continue()
+ * @param       无
+ * @retval      0: 已启动, 1: 传输不支持中断方式、启动失败或上一次收包未结束，由调用者改用USB302_Data_Service()
+ */
+uint8_t USB302_Rx_Start(void)
+{
+    if ((fusb302_iic->read_start == NULL) || (USB302_Rx_Step != USB302_RX_IDLE))
+        return 1;
+
+    return USB302_Rx_Read(USB302_RX_STATUS, FUSB302_REG_STATUS0A, USB302_Status, FUSB302_STATUS_NUM);
+}
+
+/**
+ * @brief       中断方式收包：一次读取结束后继续，与USB302_Read_Service()的步骤相同
+ *              消息读完（或没有消息、通信失败）后清空RX FIFO并处理，与USB302_Data_Service()结果一致
+ * @param       无
+ * @retval      1: 已启动下一次读取, 0: 本次收包已处理完（或没有进行中的收包）
+ */
+uint8_t USB302_Rx_Continue(void)
+{
+    uint8_t failed = fusb302_iic_xfer_status;
+    uint8_t readSize;
+
+    switch (USB302_Rx_Step)
+    {
+    case USB302_RX_STATUS:
+        RX_Length = 0;
+        if (failed)
+        {
+            USB302_Status_Failed();
+        }
+        if (USB302_STATUS(FUSB302_REG_STATUS1) & 0x20) // STATUS1.RX_EMPTY
+            break;
+        if (USB302_Rx_Read(USB302_RX_HEADER, 0x43, USB302_RX_Buff, 3) == 0)
+            return 1;
+        USB302_Wite_Reg(0x07, 0x04);
+        break;
+
+    case USB302_RX_HEADER:
+        readSize = failed ? 0 : USB302_Rx_Size();
+        if (readSize)
+        {
+            RX_Length = readSize + 3;
+            if (USB302_Rx_Read(USB302_RX_PAYLOAD, 0x43, USB302_RX_Buff + 3, readSize) == 0)
+                return 1;
+            RX_Length = 0;
+        }
+        USB302_Wite_Reg(0x07, 0x04);
+        break;
+
+    case USB302_RX_PAYLOAD:
+        if (failed)
+        {
+            RX_Length = 0;
+        }
+        USB302_Wite_Reg(0x07, 0x04);
+        break;
+
+    default:
+        return 0;
+    }
+
+    USB302_Rx_Step = USB302_RX_IDLE;
+    USB302_Rx_Process();
+    return 0;
+}
+
+/**
+ * @brief       中断方式收包超时：重新初始化IIC接口（中止传输），按通信失败结束本次收包
+ * @param       无
+ * @retval      无
+ */
+void USB302_Rx_Abort(void)
+{
+    if (USB302_Rx_Step == USB302_RX_IDLE)
+        return;
+
+    fusb302_iic->init();
+    fusb302_iic_xfer_status = 1;
+    USB302_Rx_Continue();
+}
+
+/**
+ * @brief       是否正在中断方式收包，期间不能访问芯片
+ * @param       无
+ * @retval      1: 是, 0: 否
+ */
+uint8_t USB302_Rx_Busy(void)
+{
+    return (USB302_Rx_Step != USB302_RX_IDLE) ? 1 : 0;
+}
+
+/**
+ * @brief   发送Request消息
+ *          固定/可变电源：工作电流和最大电流均为req->current_ma（10mA单位）
+ *          电池：工作功率和最大功率均为req->power_mw（250mW单位）
+ *          PPS：输出电压req->voltage_mv（20mV单位）、工作电流req->current_ma（50mA单位），
+ *               消息头按PD3.0发送，需在10s内重复请求，否则电源会硬复位
+ *          收到Source_Capabilities后需间隔约10ms再发送，由调用者延时
+ * @param   req: 请求的档位，通常来自USB302_Select_PDO()
+ * @return  无
+ */
+void USB302_Send_Request(const USB302_Request_TypeDef *req)
 {
+    uint32_t rdo;
+    uint16_t op;
     uint8_t i;
-    DelayMs(10);
-    if (objects > PD_Source_Capabilities_Inf_num)
+
+    if ((req->position == 0) || (req->position > PD_Source_Capabilities_Inf_num))
         return;
+    if (req->type == USB302_PDO_APDO)
+    {
+        op = req->current_ma / 50;
+        if (op > 0x7F)
+            op = 0x7F;
+        rdo = ((uint32_t)req->position << 28) | ((uint32_t)((req->voltage_mv / USB302_PPS_STEP_MV) & 0x7FF) << 9) | op;
+    }
+    else
+    {
+        if (req->type == USB302_PDO_BATTERY)
+        {
+            op = req->power_mw / 250;
+        }
+        else
+        {
+            op = req->current_ma / 10;
+        }
+        if (op > 0x3FF)
+            op = 0x3FF;
+        rdo = ((uint32_t)req->position << 28) | ((uint32_t)op << 10) | op;
+    }
+    rdo |= (1UL << 25) | (1UL << 24); // USB Communications Capable, No USB Suspend
+    if (req->mismatch)
+    {
+        rdo |= 1UL << 26; // Capability Mismatch
+    }
+
     for (i = 0; i < 14; i++) // 装填发送buff
     {
         USB302_TX_Buff[i] = PD_Resq[i];
     }
-    // USB302_TX_Buff[0]~USB302_TX_Buff[5]为FUSB302内部寄存器发送
-    USB302_TX_Buff[6] |= PD_MSG_ID << 1;
+    // USB302_TX_Buff[0]~USB302_TX_Buff[4]为FUSB302内部寄存器发送
+    USB302_TX_Buff[6] |= (PD_MSG_ID & 0x07) << 1;
     USB302_TX_Buff[5] |= PD_Version;
+    if (req->type == USB302_PDO_APDO)
+    {
+        USB302_TX_Buff[5] = (USB302_TX_Buff[5] & 0x3F) | 0x80; // Spec Revision 3.0
+    }
 
-    USB302_TX_Buff[10] |= objects << 4;
-    // pps
+    USB302_TX_Buff[7] = rdo;
+    USB302_TX_Buff[8] = rdo >> 8;
+    USB302_TX_Buff[9] = rdo >> 16;
+    USB302_TX_Buff[10] = rdo >> 24;
 
     USB302_Wite_Reg(0x06, 0x40); // 清发送
     USB302_Wite_FIFO(USB302_TX_Buff, 14);
@@ -608,6 +1489,24 @@ void USB302_Send_Requse(uint8_t objects)
     PD_Msg_ID_ADD();             // 加包
 }
 
+// 发送请求 要有objects 号，按该档位的最大电流（电池为最大功率）请求
+// 收到Source_Capabilities后需间隔约10ms再发送，由调用者延时
+void USB302_Send_Requse(uint8_t objects)
+{
+    USB302_PDO_TypeDef pdo;
+    USB302_Request_TypeDef req;
+
+    if ((objects == 0) || USB302_Decode_PDO(objects - 1, &pdo) || (pdo.type == USB302_PDO_APDO))
+        return;
+    req.position = objects;
+    req.type = pdo.type;
+    req.mismatch = 0;
+    req.voltage_mv = pdo.min_mv;
+    req.current_ma = pdo.max_ma;
+    req.power_mw = pdo.max_mw;
+    USB302_Send_Request(&req);
+}
+
 void USB302_Send_Min_Request(void)
 {
     uint8_t pd_buf[6];
@@ -630,8 +1529,11 @@ void USB302_Send_Min_Request(void)
 
 void USB302_Check_TX_Result(void)
 {
-    uint8_t intA = USB302_Read_Reg(0x3E);
-    uint8_t intB = USB302_Read_Reg(0x3F);
+    uint8_t intA, intB;
+
+    FUSB30XRefreshStatusRegister();
+    intA = USB302_STATUS(FUSB302_REG_INTERRUPTA);
+    intB = USB302_STATUS(FUSB302_REG_INTERRUPTB);
 
     printf("INT_A=%02X INT_B=%02X\r\n", intA, intB);
 
@@ -644,24 +1546,26 @@ void USB302_Check_TX_Result(void)
 
 void USB302_Get_Data(void)
 {
-    uint8_t i = 0;
-    uint16_t cachevol = 0, cachecur = 0;
+    static const char *const type_name[4] = {"Fixed", "Battery", "Variable", "PPS"};
+    USB302_PDO_TypeDef pdo;
+    uint8_t i;
+
     if (PD_STEP == 2)
     {
-        USB302_Send_Requse(PD_Source_Capabilities_Inf_num); // 进行一次1包请求
         for (i = 0; i < PD_Source_Capabilities_Inf_num; i++)
         {
-            if ((PD_Source_Capabilities_Inf[i].PDC_INF[3] & 0xc0) == 0) // 普通PD手册P154页
+            if (USB302_Decode_PDO(i, &pdo)) // 普通PD手册P154页
             {
-                cachecur = ((PD_Source_Capabilities_Inf[i].PDC_INF[1] & 0x03) << 8) | (PD_Source_Capabilities_Inf[i].PDC_INF[0]);        /*****读取一组电流******/
-                cachecur *= 10;                                                                                                          // 10ma
-                cachevol = ((PD_Source_Capabilities_Inf[i].PDC_INF[2] & 0x0F) << 8) | (PD_Source_Capabilities_Inf[i].PDC_INF[1] & 0xFC); /*****Read voltage******/
-                cachevol >>= 2;
-                cachevol *= 50; // 50mv
-                printf("Voltage: %dV\n", cachevol / 1000);
-                printf("Current: %d mA\n", cachecur);
+                printf("PDO%d: unsupported APDO\n", i + 1);
+                continue;
             }
+            printf("PDO%d: %s %d-%dmV %dmA %lumW\n", i + 1, type_name[pdo.type],
+                   pdo.min_mv, pdo.max_mv, pdo.max_ma, (unsigned long)pdo.max_mw);
         }
+        USB302_Select_PDO(&PD_Request_Inf);
+        printf("Request PDO%d %dmV%s\n", PD_Request_Inf.position, PD_Request_Inf.voltage_mv,
+               PD_Request_Inf.mismatch ? " (mismatch)" : "");
+        USB302_Send_Request(&PD_Request_Inf);
         PD_STEP = 3;
     }
 }
@@ -19,14 +19,101 @@
 
 #define FUSB302_IIC_READ_SDA()  GPIOB_ReadPortPin(GPIO_Pin_12)
 
+/* 状态/中断寄存器，0x3C~0x42可一次连续读出，其中中断寄存器读后清零 */
+#define FUSB302_REG_STATUS0A    0x3C
+#define FUSB302_REG_STATUS1A    0x3D
+#define FUSB302_REG_INTERRUPTA  0x3E
+#define FUSB302_REG_INTERRUPTB  0x3F
+#define FUSB302_REG_STATUS0     0x40
+#define FUSB302_REG_STATUS1     0x41
+#define FUSB302_REG_INTERRUPT   0x42
+#define FUSB302_STATUS_NUM      7
+
+/* 取FUSB30XRefreshStatusRegister()缓存的寄存器值 */
+#define USB302_STATUS(reg)      (USB302_Status[(reg) - FUSB302_REG_STATUS0A])
+
 /* IIC操作类型 */
 #define FUSB302_IIC_WRITE       0
 #define FUSB302_IIC_READ        1
 
+/* IIC传输方式：1=片上硬件IIC（引脚同为PB13/PB12），0=GPIO模拟
+ * 硬件IIC初始化后读不到芯片时自动退回GPIO模拟 */
+#ifndef FUSB302_IIC_HW
+#define FUSB302_IIC_HW          1
+#endif
+#define FUSB302_IIC_SPEED       400000  // 硬件IIC时钟，FUSB302最高支持1MHz
+#define FUSB302_IIC_HW_TIMEOUT  10000   // 硬件IIC等待事件的最大查询次数
+
+/* IIC传输接口，可替换为其他实现（如无芯片时的模拟数据）
+ * write/read从reg开始连续传输len字节，返回0成功、1失败
+ * read_start为中断方式的读取（可为NULL）：返回0表示已启动，传输结束时由实现调用fusb302_iic_xfer_done()，
+ * 完成前data不能再使用，也不能发起其他传输；init同时中止未完成的中断传输 */
+typedef struct
+{
+  void (*init)(void);
+  uint8_t (*write)(uint8_t reg, const uint8_t *data, uint8_t len);
+  uint8_t (*read)(uint8_t reg, uint8_t *data, uint8_t len);
+  uint8_t (*read_start)(uint8_t reg, uint8_t *data, uint8_t len);
+} fusb302_iic_ops_t;
+
+extern const fusb302_iic_ops_t fusb302_iic_hw_ops;                              /* 片上硬件IIC */
+extern const fusb302_iic_ops_t fusb302_iic_soft_ops;                            /* GPIO模拟IIC */
+
 typedef struct
 {
   uint8_t PDC_INF[4];
 } PD_Source_Capabilities_TypeDef;
+
+/* 档位类型（PDO bit30-31） */
+#define USB302_PDO_FIXED        0
+#define USB302_PDO_BATTERY      1
+#define USB302_PDO_VARIABLE     2
+#define USB302_PDO_APDO         3   // 只解码SPR PPS
+
+/* 解码后的档位 */
+typedef struct
+{
+  uint8_t type;                     // USB302_PDO_xxx
+  uint16_t min_mv;                  // 固定电源时等于max_mv
+  uint16_t max_mv;
+  uint16_t max_ma;                  // 电池型按max_mv折算
+  uint32_t max_mw;                  // 可变电源按min_mv计算
+} USB302_PDO_TypeDef;
+
+/* 档位请求 */
+typedef struct
+{
+  uint8_t position;                 // 请求的档位序号(1~7)，0=无
+  uint8_t type;                     // USB302_PDO_xxx
+  uint8_t mismatch;                 // 没有档位满足负载要求，置Capability Mismatch
+  uint16_t voltage_mv;              // 可变/电池为最低电压，PPS为请求的输出电压
+  uint16_t current_ma;
+  uint32_t power_mw;
+} USB302_Request_TypeDef;
+
+/* LED负载要求，USB302_Select_PDO()按此选择档位 */
+#ifndef USB302_LOAD_MIN_MV
+#define USB302_LOAD_MIN_MV      5000
+#endif
+#ifndef USB302_LOAD_MAX_MV
+#define USB302_LOAD_MAX_MV      20000
+#endif
+#ifndef USB302_LOAD_MIN_MA
+#define USB302_LOAD_MIN_MA      500
+#endif
+
+/* PPS：电源电压 = LED灯串正向电压 + 余量，以20mV步进请求固定电压；PWM调光时灯串导通电压与亮度无关，
+ * 电压不随占空比变化。默认关闭，打开后能覆盖该电压的PPS档位优先于固定档位，按实际灯串调整 */
+#ifndef USB302_PPS_ENABLE
+#define USB302_PPS_ENABLE       0
+#endif
+#ifndef USB302_PPS_VF_MV
+#define USB302_PPS_VF_MV        12000   // 灯串导通时的正向电压
+#endif
+#ifndef USB302_PPS_HEADROOM_MV
+#define USB302_PPS_HEADROOM_MV  300     // 驱动所需的电压余量
+#endif
+#define USB302_PPS_STEP_MV      20      // PPS请求电压单位
 /* INT 引脚定义 - PB5 */
 #define FUSB30Xint_GPIO_Port    GPIOB
 #define FUSB30Xint_GPIO         GPIO_Pin_5
@@ -48,21 +135,47 @@ typedef enum
 
 /* IIC底层驱动函数 */
 void fusb302_iic_init(void);                                                    /* 初始化IIC接口 */
+void fusb302_iic_set_ops(const fusb302_iic_ops_t *ops);                          /* 切换IIC传输方式并初始化 */
 uint8_t fusb302_iic_write_reg(uint8_t reg, uint8_t val);                        /* 写FUSB302寄存器 */
 uint8_t fusb302_iic_read_reg(uint8_t reg);                                      /* 读FUSB302寄存器 */
 void fusb302_iic_read_fifo(uint8_t *pBuf, uint8_t len);                         /* 读FUSB302 FIFO */
 void fusb302_iic_write_fifo(uint8_t *data, uint8_t length);                     /* 写FUSB302 FIFO */
+uint8_t fusb302_iic_read_regs(uint8_t reg, uint8_t *buf, uint8_t len);          /* 连续读多个寄存器 */
+void fusb302_iic_xfer_done(uint8_t status);                                     /* 中断方式读取结束（中断上下文），0=成功 */
+void fusb302_iic_set_done_callback(void (*cb)(void));                           /* 中断方式读取结束回调，在中断上下文中调用 */
 
 /* FUSB302功能函数 */
-uint8_t USB302_Init(void);
+void FUSB30XRefreshStatusRegister(void);                                        /* 一次读出0x3C~0x42并清中断 */
+uint8_t USB302_Init(void);                                                      /* 阻塞检测CC并完成连接配置，0=未连接 */
 void Check_USB302(void);
-void USB302_Get_Data(void);                                                     /* 获取PD档位信息（需在PD_STEP==2时调用） */
-void USB302_Data_Service(void);                                                 /* 数据服务 */
-void USB302_Send_Requse(uint8_t req_num);                                       /* 发送PD请求 */
+void USB302_Get_Data(void);                                                     /* 获取PD档位信息（需在PD_STEP==2时调用，距收到档位约10ms） */
+void USB302_Data_Service(void);                                                 /* 数据服务（阻塞读取） */
+void USB302_Send_Requse(uint8_t req_num);                                       /* 按档位序号发送PD请求 */
+void USB302_Send_Request(const USB302_Request_TypeDef *req);                    /* 发送PD请求 */
+uint8_t USB302_Decode_PDO(uint8_t index, USB302_PDO_TypeDef *pdo);              /* 解码档位，0=成功 */
+uint8_t USB302_Select_PDO(USB302_Request_TypeDef *req);                         /* 按负载要求选择档位，0=满足要求 */
+uint16_t USB302_PPS_Voltage(const USB302_PDO_TypeDef *pdo);                     /* 计算PPS请求电压 */
+
+/* 非阻塞连接步骤（USB302_Init()的拆分，步骤之间的等待由调用者完成） */
+void USB302_Reset(void);                                                        /* 复位芯片，之后等待5ms */
+void USB302_Meas_CC_Start(uint8_t cc);                                          /* 开始测量CC1/CC2，之后等待2ms */
+uint8_t USB302_Meas_CC_Read(void);                                              /* 读取测量结果，1=有电压 */
+void USB302_Attach_Start(uint8_t cc);                                           /* 硬件复位包+芯片复位，之后等待5ms */
+void USB302_Attach_Config(void);                                                /* 连接配置，开始等待Source_Capabilities */
+uint8_t USB302_CC_Attached(void);                                               /* 连接后CC脚是否仍有电压 */
+
+/* 中断方式收包（USB302_Data_Service()的拆分）：状态寄存器、FIFO的读取由IIC中断完成，
+ * 每次传输结束调用回调后，由调用者在任务中调用USB302_Rx_Continue()；收包期间不能访问芯片 */
+uint8_t USB302_Rx_Start(void);                                                  /* 开始收包，0=已启动，1=传输不支持中断方式 */
+uint8_t USB302_Rx_Continue(void);                                               /* 传输结束后继续，1=已启动下一次传输，0=本次收包已处理完 */
+void USB302_Rx_Abort(void);                                                     /* 传输超时：复位IIC接口，按通信失败结束本次收包 */
+uint8_t USB302_Rx_Busy(void);                                                   /* 是否正在收包 */
 
 /* 导出全局变量（供UI使用） */
 extern PD_Source_Capabilities_TypeDef PD_Source_Capabilities_Inf[7];
-extern uint8_t PD_Source_Capabilities_Inf_num;
+extern uint8_t PD_Source_Capabilities_Inf_num;                                  /* 档位数（含非固定电源） */
+extern USB302_Request_TypeDef PD_Request_Inf;                                   /* 最近一次请求的档位 */
+extern uint8_t USB302_Status[FUSB302_STATUS_NUM];                               /* 0x3C~0x42缓存 */
 extern uint8_t PD_STEP;                                                         /* PD初始化步骤（2=可获取档位，3=已获取） */
 
 /**
@@ -70,7 +183,7 @@ extern uint8_t PD_STEP;
  * @param   index: 档位索引(0~6)
  * @param   voltage_mv: 输出电压(mV)
  * @param   current_ma: 输出电流(mA)
- * @return  0=成功, 1=无效索引
+ * @return  0=成功, 1=无效索引或非固定电源
  */
 uint8_t USB302_Parse_PDO(uint8_t index, uint16_t *voltage_mv, uint16_t *current_ma);
 
@@ -124,16 +124,16 @@
 #define CLK_OSC32K                          1   // ڴ޸ģڹԤ޸ģɫʹⲿ32K
 #endif
 #ifndef BLE_MEMHEAP_SIZE
-#define BLE_MEMHEAP_SIZE                    (1024*6)
+#define BLE_MEMHEAP_SIZE                    (1024*8)   // ӴBLE_BUFF_NUM251ֽڻ
 #endif
 #ifndef BLE_BUFF_MAX_LEN
-#define BLE_BUFF_MAX_LEN                    27
+#define BLE_BUFF_MAX_LEN                    251        // ATT_MTU247Ӻperipheral_link_setupЭ
 #endif
 #ifndef BLE_BUFF_NUM
-#define BLE_BUFF_NUM                        5
+#define BLE_BUFF_NUM                        8   // ͸һŶӶ֪ͨperipheral_uart_pump
 #endif
 #ifndef BLE_TX_NUM_EVENT
-#define BLE_TX_NUM_EVENT                    1
+#define BLE_TX_NUM_EVENT                    4
 #endif
 #ifndef BLE_TX_POWER
 #define BLE_TX_POWER                        LL_TX_POWEER_0_DBM
@@ -0,0 +1,110 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : fuzz_app_ctrl.c
+ * Author             :
+ * Version            : V1.0
+ * Date               : 2026/01/24
+ * Description        : app_ctrl_dispatch() 的libFuzzer入口
+ *                      每个输入的第1个字节选择特征值（bit0为1时FFF3，否则FFF2），其余为写入的数据，
+ *                      检查FFF2/FFF3的分流和透传的FIFO用量，执行后组应答帧并推进渐变，
+ *                      检查输出宽度和应答帧格式；越界访问由ASan发现
+ *                      clang下链接 -fsanitize=fuzzer，gcc下由 fuzz_main.c 驱动
+ *******************************************************************************/
+
+#include "CONFIG.h"
+#include "PWM.h"
+#include "app_ctrl.h"
+#include "app_uart.h"
+#include "mock_hw.h"
+#include <stdlib.h>
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size);
+void UART3_IRQHandler(void);
+
+static uint16_t tx_room_empty;
+
+static void fuzz_init(void)
+{
+    mock_hw_reset();
+    mock_tmos_reset();
+    PWM_ComplementaryInit();
+    PWM_FadeInit();
+    app_uart_init();
+    tx_room_empty = app_uart_tx_room();
+}
+
+// 模拟THR空中断，把透传数据从发送FIFO排空（不经mock_irq()，不需要寄存器写入记录）
+static void fuzz_uart_drain(void)
+{
+    R8_UART3_IIR = UART_II_THR_EMPTY;
+    while((app_uart_tx_room() != tx_room_empty) && (R8_UART3_IER & RB_IER_THR_EMPTY))
+    {
+        UART3_IRQHandler();
+    }
+    R8_UART3_IIR = UART_II_NO_INTER;
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    static uint8_t init = 0;
+    uint8_t        ack[64];
+    uint16_t       len, w1, w2, room, used;
+    uint8_t        char_id, status;
+
+    if(!init)
+    {
+        fuzz_init();
+        init = 1;
+    }
+    if((size == 0) || (size > 0x10000))
+    {
+        return 0;
+    }
+    char_id = (data[0] & 0x01) ? APP_CTRL_CHAR_CTRL : APP_CTRL_CHAR_RX;
+    data++;
+    size--;
+    room = app_uart_tx_room();
+
+    // 复制到刚好等长的缓冲区，读越过帧尾时ASan立即报错
+    {
+        uint8_t *buf = malloc(size ? size : 1);
+
+        memcpy(buf, data, size);
+        status = app_ctrl_dispatch(char_id, buf, (uint16_t)size);
+        free(buf);
+    }
+
+    // FFF3和旧格式命令不进串口FIFO（串口配置命令可能清空FIFO），透传数据能放下多少放多少
+    used = room - app_uart_tx_room();
+    if(status == APP_CTRL_PASSTHROUGH)
+    {
+        if((char_id != APP_CTRL_CHAR_RX) || app_ctrl_match(data, (uint16_t)size) ||
+           (used != ((size < room) ? size : room)))
+        {
+            abort();
+        }
+        fuzz_uart_drain();
+    }
+    else if((status > APP_CTRL_ERR_VALUE) || (app_uart_tx_room() < room) ||
+            ((char_id == APP_CTRL_CHAR_RX) && !app_ctrl_match(data, (uint16_t)size)))
+    {
+        abort();
+    }
+
+    while((len = app_ctrl_ack_build(ack, sizeof(ack))) != 0)
+    {
+        if((len > sizeof(ack)) || (ack[0] != APP_CTRL_MAGIC) || (ack[2] != APP_CTRL_TLV_ACK) ||
+           (ack[3] + 4 != len))
+        {
+            abort();
+        }
+        app_ctrl_ack_release(len);
+    }
+
+    mock_tmos_run(MS1_TO_SYSTEM_TIME(50));
+    PWM_GetWidthsQ8(&w1, &w2);
+    if((w1 + w2 > PWM_Q8_ONE) || (PWM_GetOutputMode() > PWM_OUTPUT_SEQUENTIAL))
+    {
+        abort();
+    }
+    return 0;
+}
@@ -0,0 +1,99 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : fuzz_main.c
+ * Author             :
+ * Version            : V1.0
+ * Date               : 2026/01/24
+ * Description        : 没有libFuzzer时的驱动（gcc + ASan/UBSan）
+ *                      带参数时逐个重放文件（libFuzzer保存的crash/语料），
+ *                      不带参数时运行固定种子的随机输入：第1个字节选择FFF2/FFF3，
+ *                      之后的数据多数以 [0xA5][版本] 开头
+ *******************************************************************************/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define FUZZ_RUNS       200000
+#define FUZZ_MAX_LEN    601
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size);
+
+static uint32_t rnd_state = 2026;
+
+static uint32_t rnd(void)
+{
+    rnd_state = rnd_state * 1103515245U + 12345U;
+    return rnd_state >> 16;
+}
+
+static int replay(const char *path)
+{
+    static uint8_t buf[0x10000];
+    FILE          *f = fopen(path, "rb");
+    size_t         size;
+
+    if(f == NULL)
+    {
+        perror(path);
+        return 1;
+    }
+    size = fread(buf, 1, sizeof(buf), f);
+    fclose(f);
+    LLVMFuzzerTestOneInput(buf, size);
+    return 0;
+}
+
+// 随机帧：TLV类型集中在已定义的范围内，长度字段偶尔与实际不符
+static size_t random_input(uint8_t *buf)
+{
+    size_t len = 0, target = rnd() % FUZZ_MAX_LEN;
+
+    // 特征值选择：3/4写FFF3，1/4写FFF2
+    buf[len++] = (rnd() % 4) ? 0x01 : 0x00;
+
+    if(rnd() % 8 == 0)
+    {
+        // 旧格式或纯随机数据
+        while(len < 1 + target % 8)
+        {
+            buf[len++] = (uint8_t)rnd();
+        }
+        return len;
+    }
+    buf[len++] = 0xA5;
+    buf[len++] = (rnd() % 16) ? 0x01 : (uint8_t)rnd();
+    while(len + 2 <= target)
+    {
+        uint8_t tlen = (rnd() % 4) ? (uint8_t)(rnd() % 8) : (uint8_t)rnd();
+        size_t  i;
+
+        buf[len++] = (rnd() % 4) ? (uint8_t)(1 + rnd() % 6) : (uint8_t)rnd();
+        buf[len++] = tlen;
+        for(i = 0; (i < tlen) && (len < target); i++)
+        {
+            buf[len++] = (uint8_t)rnd();
+        }
+    }
+    return len;
+}
+
+int main(int argc, char **argv)
+{
+    static uint8_t buf[FUZZ_MAX_LEN];
+    int            i, ret = 0;
+
+    if(argc > 1)
+    {
+        for(i = 1; i < argc; i++)
+        {
+            ret |= replay(argv[i]);
+        }
+        return ret;
+    }
+    for(i = 0; i < FUZZ_RUNS; i++)
+    {
+        LLVMFuzzerTestOneInput(buf, random_input(buf));
+    }
+    printf("%d inputs\n", FUZZ_RUNS);
+    return 0;
+}
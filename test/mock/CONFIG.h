@@ -0,0 +1,6 @@
+/* 固件以 "CONFIG.h" 包含 HAL/include/config.h，大小写敏感的文件系统上用此文件转接 */
+#include "../../HAL/include/config.h"
+
+/* PWM.c更新影子数据中途的插入点，测试用mock_pwmx_fire_in_update在此触发周期结束中断 */
+void mock_pwmx_shadow_hook(void);
+#define PWM_SHADOW_HOOK()    mock_pwmx_shadow_hook()
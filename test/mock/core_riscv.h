@@ -0,0 +1,75 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : core_riscv.h
+ * Author             :
+ * Version            : V1.0
+ * Date               : 2026/01/24
+ * Description        : 主机测试用的 RVMSIS/core_riscv.h
+ *                      PFIC中断使能记录在 mock_pfic_enabled[] 中，
+ *                      CSR访问改为读写 mock_csr，不含任何RISC-V汇编
+ *******************************************************************************/
+
+#ifndef __CORE_RV3A_H__
+#define __CORE_RV3A_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+/* IO definitions */
+#define __I                 volatile const
+#define __O                 volatile
+#define __IO                volatile
+#define RV_STATIC_INLINE    static inline
+
+typedef enum
+{
+    DISABLE = 0,
+    ENABLE = !DISABLE
+} FunctionalState;
+typedef enum
+{
+    RESET = 0,
+    SET = !RESET
+} FlagStatus, ITStatus;
+
+// PFIC中断使能位，下标同 PFIC->IENR
+extern volatile uint32_t mock_pfic_enabled[8];
+
+// 唯一用到的CSR为0x800(全局中断)，所有CSR共用一个变量
+extern volatile unsigned long mock_csr;
+
+#define __nop()                 ((void)0)
+#define read_csr(reg)           (mock_csr)
+#define write_csr(reg, val)     (mock_csr = (val))
+
+#define PFIC_EnableAllIRQ()     {write_csr(0x800, 0x88);}
+#define PFIC_DisableAllIRQ()    {write_csr(0x800, 0x80);}
+
+RV_STATIC_INLINE void PFIC_EnableIRQ(IRQn_Type IRQn)
+{
+    mock_pfic_enabled[(uint32_t)(IRQn) >> 5] |= (1U << ((uint32_t)(IRQn)&0x1F));
+}
+
+RV_STATIC_INLINE void PFIC_DisableIRQ(IRQn_Type IRQn)
+{
+    mock_pfic_enabled[(uint32_t)(IRQn) >> 5] &= ~(1U << ((uint32_t)(IRQn)&0x1F));
+}
+
+RV_STATIC_INLINE uint32_t PFIC_GetStatusIRQ(IRQn_Type IRQn)
+{
+    return ((mock_pfic_enabled[(uint32_t)(IRQn) >> 5] >> ((uint32_t)(IRQn)&0x1F)) & 1U);
+}
+
+RV_STATIC_INLINE void PFIC_SetPriority(IRQn_Type IRQn, uint8_t priority)
+{
+    (void)IRQn;
+    (void)priority;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __CORE_RV3A_H__ */
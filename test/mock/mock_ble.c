@@ -0,0 +1,13 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : mock_ble.c
+ * Author             :
+ * Version            : V1.0
+ * Date               : 2026/01/24
+ * Description        : peripheral.c中供APP层使用的符号
+ *                      测试可注册一个任务并赋给Peripheral_TaskID，以观察串口模块置位的事件
+ *******************************************************************************/
+
+#include "CONFIG.h"
+#include "peripheral.h"
+
+uint8_t Peripheral_TaskID = INVALID_TASK_ID;
@@ -0,0 +1,206 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : mock_fusb302.c
+ * Author             :
+ * Version            : V1.0
+ * Date               : 2026/01/24
+ * Description        : 脚本化的FUSB302寄存器后端
+ *******************************************************************************/
+
+#include "mock_fusb302.h"
+#include <string.h>
+
+#define REG_DEVICE_ID    0x01
+#define REG_CONTROL1     0x07
+#define RX_FLUSH         0x04
+#define RX_EMPTY         0x20
+
+uint8_t mock_fusb302_reg[MOCK_FUSB302_REGS];
+uint8_t mock_fusb302_nack = 0;
+uint16_t mock_fusb302_read_starts = 0;
+
+static uint8_t  mock_rx[MOCK_FUSB302_RX_MAX];
+static uint16_t mock_rx_head = 0;
+static uint16_t mock_rx_tail = 0;
+
+static mock_fusb302_write_t mock_log[MOCK_FUSB302_LOG_MAX];
+static uint16_t             mock_log_num = 0;
+
+// 中断方式读取：已启动、尚未通知结束
+static uint8_t mock_xfer_pending = 0;
+static uint8_t mock_xfer_status = 0;
+
+static void mock_rx_update(void)
+{
+    if(mock_rx_head == mock_rx_tail)
+    {
+        mock_fusb302_reg[FUSB302_REG_STATUS1] |= RX_EMPTY;
+    }
+    else
+    {
+        mock_fusb302_reg[FUSB302_REG_STATUS1] &= ~RX_EMPTY;
+    }
+}
+
+void mock_fusb302_reset(void)
+{
+    memset(mock_fusb302_reg, 0, sizeof(mock_fusb302_reg));
+    mock_fusb302_reg[REG_DEVICE_ID] = 0x91;
+    mock_fusb302_nack = 0;
+    mock_rx_head = mock_rx_tail = 0;
+    mock_log_num = 0;
+    mock_xfer_pending = 0;
+    mock_fusb302_read_starts = 0;
+    mock_rx_update();
+}
+
+static void mock_rx_put(uint8_t byte)
+{
+    if(mock_rx_tail < MOCK_FUSB302_RX_MAX)
+    {
+        mock_rx[mock_rx_tail++] = byte;
+    }
+}
+
+void mock_fusb302_rx(uint16_t header, const uint32_t *obj)
+{
+    uint8_t n = (header >> 12) & 0x07;
+    uint8_t i;
+
+    mock_rx_put(0xE0); // SOP
+    mock_rx_put((uint8_t)header);
+    mock_rx_put((uint8_t)(header >> 8));
+    for(i = 0; i < n; i++)
+    {
+        mock_rx_put((uint8_t)obj[i]);
+        mock_rx_put((uint8_t)(obj[i] >> 8));
+        mock_rx_put((uint8_t)(obj[i] >> 16));
+        mock_rx_put((uint8_t)(obj[i] >> 24));
+    }
+    for(i = 0; i < 4; i++)
+    {
+        mock_rx_put(0xC0 + i); // CRC，不校验
+    }
+    mock_rx_update();
+}
+
+static void mock_init(void)
+{
+}
+
+static uint8_t mock_write(uint8_t reg, const uint8_t *data, uint8_t len)
+{
+    uint8_t i;
+
+    if(mock_fusb302_nack)
+    {
+        return 1;
+    }
+    if(mock_log_num < MOCK_FUSB302_LOG_MAX)
+    {
+        mock_fusb302_write_t *w = &mock_log[mock_log_num++];
+
+        w->reg = reg;
+        w->len = len;
+        memcpy(w->data, data, (len < MOCK_FUSB302_DATA_MAX) ? len : MOCK_FUSB302_DATA_MAX);
+    }
+    // TX FIFO：数据只记录，不进入寄存器文件
+    if(reg == MOCK_FUSB302_FIFO)
+    {
+        return 0;
+    }
+    for(i = 0; (i < len) && (reg + i < MOCK_FUSB302_FIFO); i++)
+    {
+        mock_fusb302_reg[reg + i] = data[i];
+    }
+    if((reg <= REG_CONTROL1) && (reg + len > REG_CONTROL1) && (data[REG_CONTROL1 - reg] & RX_FLUSH))
+    {
+        mock_rx_head = mock_rx_tail = 0;
+        mock_fusb302_reg[REG_CONTROL1] &= ~RX_FLUSH;
+        mock_rx_update();
+    }
+    return 0;
+}
+
+static uint8_t mock_read(uint8_t reg, uint8_t *data, uint8_t len)
+{
+    uint8_t i;
+
+    if(mock_fusb302_nack)
+    {
+        return 1;
+    }
+    for(i = 0; i < len; i++)
+    {
+        if(reg == MOCK_FUSB302_FIFO)
+        {
+            // FIFO地址不递增，读空后返回0
+            data[i] = (mock_rx_head < mock_rx_tail) ? mock_rx[mock_rx_head++] : 0;
+            mock_rx_update();
+            continue;
+        }
+        data[i] = (reg + i < MOCK_FUSB302_REGS) ? mock_fusb302_reg[reg + i] : 0;
+        if((reg + i == FUSB302_REG_INTERRUPTA) || (reg + i == FUSB302_REG_INTERRUPTB) ||
+           (reg + i == FUSB302_REG_INTERRUPT))
+        {
+            mock_fusb302_reg[reg + i] = 0;
+        }
+    }
+    return 0;
+}
+
+static void mock_async_init(void)
+{
+    mock_xfer_pending = 0;
+}
+
+// 数据在启动时即读出，结束通知留到mock_fusb302_xfer_irq()
+static uint8_t mock_read_start(uint8_t reg, uint8_t *data, uint8_t len)
+{
+    if(mock_xfer_pending)
+    {
+        return 1;
+    }
+    mock_fusb302_read_starts++;
+    mock_xfer_status = mock_read(reg, data, len);
+    mock_xfer_pending = 1;
+    return 0;
+}
+
+const fusb302_iic_ops_t mock_fusb302_ops = {mock_init, mock_write, mock_read, NULL};
+const fusb302_iic_ops_t mock_fusb302_async_ops = {mock_async_init, mock_write, mock_read, mock_read_start};
+
+
+uint8_t mock_fusb302_xfer_irq(void)
+{
+    if(!mock_xfer_pending)
+    {
+        return 0;
+    }
+    mock_xfer_pending = 0;
+    fusb302_iic_xfer_done(mock_xfer_status);
+    return 1;
+}
+
+uint16_t mock_fusb302_write_count(void)
+{
+    return mock_log_num;
+}
+
+const mock_fusb302_write_t *mock_fusb302_write_get(uint16_t idx)
+{
+    return (idx < mock_log_num) ? &mock_log[idx] : NULL;
+}
+
+int mock_fusb302_find_write(uint8_t reg, uint16_t from)
+{
+    uint16_t i;
+
+    for(i = from; i < mock_log_num; i++)
+    {
+        if(mock_log[i].reg == reg)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
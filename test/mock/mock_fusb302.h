@@ -0,0 +1,84 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : mock_fusb302.h
+ * Author             :
+ * Version            : V1.0
+ * Date               : 2026/01/24
+ * Description        : 脚本化的FUSB302寄存器后端，经fusb302_iic_set_ops()替换IIC传输
+ *                      - 寄存器文件：连续读写地址自动递增，0x3E/0x3F/0x42中断寄存器读后清零
+ *                      - RX FIFO(0x43)：测试用mock_fusb302_rx()放入电源发来的消息，
+ *                        读空后STATUS1.RX_EMPTY置位，写0x07.RX_FLUSH清空
+ *                      - 每次写入都记录下来（寄存器、数据），TX FIFO的写入即发出的消息
+ *                      - mock_fusb302_async_ops另带中断方式读取：启动时读出数据，
+ *                        由测试调用mock_fusb302_xfer_irq()模拟传输结束中断
+ *******************************************************************************/
+
+#ifndef __MOCK_FUSB302_H__
+#define __MOCK_FUSB302_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "FUSB30X.h"
+
+#define MOCK_FUSB302_REGS        0x44
+#define MOCK_FUSB302_FIFO        0x43
+#define MOCK_FUSB302_RX_MAX      256
+#define MOCK_FUSB302_LOG_MAX     256
+#define MOCK_FUSB302_DATA_MAX    32
+
+// 一次IIC写入
+typedef struct
+{
+    uint8_t reg;
+    uint8_t len;
+    uint8_t data[MOCK_FUSB302_DATA_MAX];
+} mock_fusb302_write_t;
+
+extern const fusb302_iic_ops_t mock_fusb302_ops;
+extern const fusb302_iic_ops_t mock_fusb302_async_ops;
+
+// mock_fusb302_async_ops启动的中断方式读取次数
+extern uint16_t mock_fusb302_read_starts;
+
+// 寄存器文件，测试可直接置位状态/中断寄存器
+extern uint8_t mock_fusb302_reg[MOCK_FUSB302_REGS];
+
+// 非0时所有传输返回失败（芯片无应答）
+extern uint8_t mock_fusb302_nack;
+
+/**
+ * @brief  寄存器复位：DEVICE_ID=0x91，STATUS1.RX_EMPTY，清空RX FIFO和写入记录
+ */
+void mock_fusb302_reset(void);
+
+/**
+ * @brief  RX FIFO中放入一条消息：SOP令牌(0xE0) + 消息头 + 数据对象 + 4字节CRC
+ *
+ * @param  header - PD消息头
+ * @param  obj    - 数据对象，个数取自header的bit14~12
+ */
+void mock_fusb302_rx(uint16_t header, const uint32_t *obj);
+
+/**
+ * @brief  结束已启动的中断方式读取：以中断上下文调用fusb302_iic_xfer_done()
+ *
+ * @return 1 - 有进行中的读取，0 - 没有
+ */
+uint8_t mock_fusb302_xfer_irq(void);
+
+uint16_t mock_fusb302_write_count(void);
+const mock_fusb302_write_t *mock_fusb302_write_get(uint16_t idx);
+
+/**
+ * @brief  从第from条开始查找对reg的写入
+ *
+ * @return 记录下标，没有时返回-1
+ */
+int mock_fusb302_find_write(uint8_t reg, uint16_t from);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __MOCK_FUSB302_H__
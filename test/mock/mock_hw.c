@@ -0,0 +1,183 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : mock_hw.c
+ * Author             :
+ * Version            : V1.0
+ * Date               : 2026/01/24
+ * Description        : 主机测试用寄存器文件、写入记录、PFIC、延时和Data-Flash
+ *******************************************************************************/
+
+#include "CONFIG.h"
+#include "mock_hw.h"
+
+uint8_t mock_sfr[MOCK_SFR_SIZE] __attribute__((aligned(4)));
+
+volatile uint32_t      mock_pfic_enabled[8];
+volatile unsigned long mock_csr;
+
+uint8_t mock_eeprom[MOCK_EEPROM_SIZE];
+
+// 上次同步时的寄存器文件
+static uint8_t mock_sfr_shadow[MOCK_SFR_SIZE];
+
+static mock_reg_write_t mock_trace[MOCK_TRACE_MAX];
+static uint16_t         mock_trace_num = 0;
+static const char      *mock_ctx = MOCK_CTX_MAIN;
+
+void mock_hw_reset(void)
+{
+    memset(mock_sfr, 0, sizeof(mock_sfr));
+    memset(mock_sfr_shadow, 0, sizeof(mock_sfr_shadow));
+    memset((void *)mock_pfic_enabled, 0, sizeof(mock_pfic_enabled));
+    memset(mock_eeprom, 0xFF, sizeof(mock_eeprom));
+    mock_csr = 0;
+    mock_trace_num = 0;
+    mock_ctx = MOCK_CTX_MAIN;
+}
+
+void mock_trace_sync(void)
+{
+    mock_trace_sync_ctx(mock_ctx);
+}
+
+void mock_trace_sync_ctx(const char *ctx)
+{
+    uint32_t word;
+
+    for(word = 0; word < MOCK_SFR_SIZE; word += 4)
+    {
+        mock_reg_write_t *w;
+        uint8_t           first = 4, last = 0, i;
+
+        if(memcmp(&mock_sfr[word], &mock_sfr_shadow[word], 4) == 0)
+        {
+            continue;
+        }
+        for(i = 0; i < 4; i++)
+        {
+            if(mock_sfr[word + i] != mock_sfr_shadow[word + i])
+            {
+                if(first == 4)
+                {
+                    first = i;
+                }
+                last = i;
+            }
+        }
+        if(mock_trace_num < MOCK_TRACE_MAX)
+        {
+            w = &mock_trace[mock_trace_num++];
+            w->ctx = ctx;
+            w->addr = MOCK_SFR_BASE + word + first;
+            w->width = last - first + 1;
+            w->old_value = 0;
+            w->value = 0;
+            for(i = last + 1; i-- > first;)
+            {
+                w->old_value = (w->old_value << 8) | mock_sfr_shadow[word + i];
+                w->value = (w->value << 8) | mock_sfr[word + i];
+            }
+        }
+        memcpy(&mock_sfr_shadow[word], &mock_sfr[word], 4);
+    }
+}
+
+void mock_trace_clear(void)
+{
+    memcpy(mock_sfr_shadow, mock_sfr, sizeof(mock_sfr));
+    mock_trace_num = 0;
+}
+
+uint16_t mock_trace_count(void)
+{
+    return mock_trace_num;
+}
+
+const mock_reg_write_t *mock_trace_get(uint16_t idx)
+{
+    return (idx < mock_trace_num) ? &mock_trace[idx] : NULL;
+}
+
+int mock_trace_find(uint32_t addr, uint16_t from)
+{
+    uint16_t i;
+
+    for(i = from; i < mock_trace_num; i++)
+    {
+        if((addr >= mock_trace[i].addr) && (addr < mock_trace[i].addr + mock_trace[i].width))
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void mock_trace_dump(FILE *fp)
+{
+    uint16_t i;
+
+    for(i = 0; i < mock_trace_num; i++)
+    {
+        fprintf(fp, "%4u %-16s %08X/%u %08X -> %08X\n", i, mock_trace[i].ctx, (unsigned)mock_trace[i].addr,
+                mock_trace[i].width, (unsigned)mock_trace[i].old_value, (unsigned)mock_trace[i].value);
+    }
+}
+
+void mock_irq(const char *name, void (*handler)(void))
+{
+    const char *saved = mock_ctx;
+
+    mock_trace_sync();
+    mock_ctx = name;
+    handler();
+    mock_trace_sync();
+    mock_ctx = saved;
+}
+
+/*********************************************************************
+ * 系统时钟：固定为FREQ_SYS(60MHz)，即main()中SetSysClock()后的值
+ */
+uint32_t GetSysClock(void)
+{
+    return FREQ_SYS;
+}
+
+/*********************************************************************
+ * 延时：主机上不等待，测试中的时间只由TMOS模拟推进
+ */
+void mDelayuS(uint16_t t)
+{
+    (void)t;
+}
+
+void mDelaymS(uint16_t t)
+{
+    (void)t;
+}
+
+/*********************************************************************
+ * Data-Flash：擦除为0xFF，写入直接覆盖
+ */
+uint32_t FLASH_EEPROM_CMD(uint8_t cmd, uint32_t StartAddr, void *Buffer, uint32_t Length)
+{
+    if((StartAddr > MOCK_EEPROM_SIZE) || (Length > MOCK_EEPROM_SIZE - StartAddr))
+    {
+        return 1;
+    }
+    switch(cmd)
+    {
+        case CMD_EEPROM_ERASE:
+            memset(&mock_eeprom[StartAddr], 0xFF, Length);
+            return 0;
+
+        case CMD_EEPROM_WRITE:
+            memcpy(&mock_eeprom[StartAddr], Buffer, Length);
+            return 0;
+
+        case CMD_EEPROM_READ:
+            memcpy(Buffer, &mock_eeprom[StartAddr], Length);
+            return 0;
+
+        default:
+            return 1;
+    }
+}
@@ -0,0 +1,109 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : mock_hw.h
+ * Author             :
+ * Version            : V1.0
+ * Date               : 2026/01/24
+ * Description        : 主机测试的硬件/TMOS模拟接口
+ *                      - 寄存器写入记录：每次同步时把寄存器文件与上次快照比较，
+ *                        变化的字节按对齐的32位字合并为一条记录，并标注当时所处的
+ *                        上下文（主循环或中断名）
+ *                      - TMOS：任务、事件和625us定时器，时间只在mock_tmos_run()中推进
+ *                      - Data-Flash：EEPROM_READ/WRITE/ERASE落在一块内存中
+ *******************************************************************************/
+
+#ifndef __MOCK_HW_H__
+#define __MOCK_HW_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdio.h>
+#include "mock_sfr.h"
+
+#define MOCK_CTX_MAIN            "main"
+#define MOCK_CTX_HW              "hw"
+#define MOCK_TRACE_MAX           4096
+
+// 一条寄存器写入记录，addr为变化的第一个字节，width为到最后一个变化字节的跨度(1-4)
+typedef struct
+{
+    const char *ctx;
+    uint32_t    addr;
+    uint8_t     width;
+    uint32_t    old_value;
+    uint32_t    value;
+} mock_reg_write_t;
+
+/**
+ * @brief  寄存器文件、写入记录、PFIC使能和Data-Flash全部复位（Data-Flash为0xFF）
+ */
+void mock_hw_reset(void);
+
+/**
+ * @brief  记录上次同步以来的寄存器变化，归入当前上下文
+ */
+void mock_trace_sync(void);
+
+/**
+ * @brief  同mock_trace_sync()，变化归入指定上下文（如硬件自己置位的标志记为"hw"）
+ */
+void mock_trace_sync_ctx(const char *ctx);
+
+/**
+ * @brief  以同步后的寄存器文件为起点，丢弃已有记录
+ */
+void mock_trace_clear(void);
+
+uint16_t mock_trace_count(void);
+const mock_reg_write_t *mock_trace_get(uint16_t idx);
+
+/**
+ * @brief  从第from条开始查找覆盖addr的记录
+ *
+ * @return 记录下标，没有时返回-1
+ */
+int mock_trace_find(uint32_t addr, uint16_t from);
+
+void mock_trace_dump(FILE *fp);
+
+/**
+ * @brief  以中断上下文调用handler：之前的变化先归入当前上下文，
+ *         handler中的变化归入name
+ */
+void mock_irq(const char *name, void (*handler)(void));
+
+/**
+ * @brief  PWMX周期结束：周期中断已开启（RB_PWM_IE_CYC且PFIC已使能）时
+ *         置中断标志并调用PWMX_IRQHandler
+ *
+ * @return 1 - 进入了中断，0 - 中断未开启
+ */
+uint8_t mock_pwmx_cycle_end(void);
+
+/**
+ * @brief  置1后，PWM.c下一次更新影子数据时在数据和输出使能两次写入之间
+ *         调用一次mock_pwmx_cycle_end()，用后自动清零
+ */
+extern uint8_t mock_pwmx_fire_in_update;
+
+/**
+ * @brief  TMOS模拟
+ */
+void     mock_tmos_reset(void);
+void     mock_tmos_poll(void);               // 处理已置位的事件，不推进时间
+void     mock_tmos_run(uint32_t ticks);      // 按625us逐tick推进时间并处理到期事件
+uint16_t mock_tmos_pending(uint8_t task_id); // 已置位未处理的事件
+
+/**
+ * @brief  Data-Flash内容
+ */
+#define MOCK_EEPROM_SIZE         0x8000
+extern uint8_t mock_eeprom[MOCK_EEPROM_SIZE];
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __MOCK_HW_H__
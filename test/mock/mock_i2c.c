@@ -0,0 +1,86 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : mock_i2c.c
+ * Author             :
+ * Version            : V1.0
+ * Date               : 2026/01/24
+ * Description        : 硬件I2C控制器模拟：总线上没有器件，任何事件都不会到来
+ *                      （原驱动以32位整数保存寄存器地址，不能在64位主机上编译）
+ *                      FUSB302的测试通过fusb302_iic_set_ops()换成脚本化的寄存器后端
+ *******************************************************************************/
+
+#include "CONFIG.h"
+
+void I2C_Init(I2C_ModeTypeDef I2C_Mode, UINT32 I2C_ClockSpeed, I2C_DutyTypeDef I2C_DutyCycle,
+              I2C_AckTypeDef I2C_Ack, I2C_AckAddrTypeDef I2C_AckAddr, uint16_t I2C_OwnAddress1)
+{
+    (void)I2C_Mode;
+    (void)I2C_ClockSpeed;
+    (void)I2C_DutyCycle;
+    (void)I2C_Ack;
+    (void)I2C_AckAddr;
+    (void)I2C_OwnAddress1;
+}
+
+void I2C_Cmd(FunctionalState NewState)
+{
+    (void)NewState;
+}
+
+void I2C_ITConfig(I2C_ITTypeDef I2C_IT, FunctionalState NewState)
+{
+    (void)I2C_IT;
+    (void)NewState;
+}
+
+void I2C_GenerateSTART(FunctionalState NewState)
+{
+    (void)NewState;
+}
+
+void I2C_GenerateSTOP(FunctionalState NewState)
+{
+    (void)NewState;
+}
+
+void I2C_AcknowledgeConfig(FunctionalState NewState)
+{
+    (void)NewState;
+}
+
+void I2C_NACKPositionConfig(uint16_t I2C_NACKPosition)
+{
+    (void)I2C_NACKPosition;
+}
+
+void I2C_Send7bitAddress(uint8_t Address, uint8_t I2C_Direction)
+{
+    (void)Address;
+    (void)I2C_Direction;
+}
+
+void I2C_SendData(uint8_t Data)
+{
+    (void)Data;
+}
+
+uint8_t I2C_ReceiveData(void)
+{
+    return 0xFF;
+}
+
+uint8_t I2C_CheckEvent(uint32_t I2C_EVENT)
+{
+    (void)I2C_EVENT;
+    return 0;
+}
+
+FlagStatus I2C_GetFlagStatus(uint32_t I2C_FLAG)
+{
+    (void)I2C_FLAG;
+    return RESET;
+}
+
+void I2C_ClearFlag(uint32_t I2C_FLAG)
+{
+    (void)I2C_FLAG;
+}
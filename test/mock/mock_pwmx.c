@@ -0,0 +1,36 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : mock_pwmx.c
+ * Author             :
+ * Version            : V1.0
+ * Date               : 2026/01/24
+ * Description        : PWMX周期结束中断模拟
+ *******************************************************************************/
+
+#include "CONFIG.h"
+#include "mock_hw.h"
+
+extern void PWMX_IRQHandler(void);
+
+uint8_t mock_pwmx_fire_in_update = 0;
+
+uint8_t mock_pwmx_cycle_end(void)
+{
+    if(!(R8_PWM_INT_CTRL & RB_PWM_IE_CYC) || !PFIC_GetStatusIRQ(PWMX_SPI1_IRQn))
+    {
+        return 0;
+    }
+    mock_trace_sync();
+    R8_PWM_INT_CTRL |= RB_PWM_IF_CYC;
+    mock_trace_sync_ctx(MOCK_CTX_HW);
+    mock_irq("PWMX_IRQHandler", PWMX_IRQHandler);
+    return 1;
+}
+
+void mock_pwmx_shadow_hook(void)
+{
+    if(mock_pwmx_fire_in_update)
+    {
+        mock_pwmx_fire_in_update = 0;
+        mock_pwmx_cycle_end();
+    }
+}
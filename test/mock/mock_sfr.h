@@ -0,0 +1,35 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : mock_sfr.h
+ * Author             :
+ * Version            : V1.0
+ * Date               : 2026/01/24
+ * Description        : 主机测试用寄存器文件
+ *                      构建时由 StdPeriphDriver/inc/CH583SFR.h 生成模拟版本，
+ *                      其中 0x4000xxxx 的寄存器地址全部换成 MOCK_SFR_ADDR()，
+ *                      落在下面的 mock_sfr[] 数组中
+ *                      RISC-V上long为32位，主机上为64位，32位类型在此换成定宽类型，
+ *                      否则32位寄存器在主机上按8字节访问
+ *******************************************************************************/
+
+#ifndef __MOCK_SFR_H__
+#define __MOCK_SFR_H__
+
+#include <stdint.h>
+
+// CH583SFR.h 中的类型定义以同名宏是否存在为条件，这里先定义的宏优先
+#define INT32       int32_t
+#define UINT32      uint32_t
+#define UINT32V     uint32_t volatile
+#define PINT32      int32_t *
+#define PUINT32     uint32_t *
+#define PUINT32V    volatile uint32_t *
+
+#define MOCK_SFR_BASE        0x40000000UL
+#define MOCK_SFR_SIZE        0x00010000UL
+
+extern uint8_t mock_sfr[MOCK_SFR_SIZE];
+
+// 寄存器地址 -> 寄存器文件中的主机地址
+#define MOCK_SFR_ADDR(addr)  ((uintptr_t)&mock_sfr[(addr) - MOCK_SFR_BASE])
+
+#endif // __MOCK_SFR_H__
@@ -0,0 +1,217 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : mock_tmos.c
+ * Author             :
+ * Version            : V1.0
+ * Date               : 2026/01/24
+ * Description        : 主机测试用TMOS：任务注册、事件置位/清除、单次和重装载定时器
+ *                      与库中行为一致的地方：tmos_stop_task()只停止定时，不清除已置位的事件；
+ *                      处理函数返回未处理的事件，下一轮继续调用
+ *******************************************************************************/
+
+#include "CONFIG.h"
+#include "mock_hw.h"
+#include <stdlib.h>
+
+#define MOCK_TMOS_TASK_MAX       8
+#define MOCK_TMOS_POLL_MAX       100000
+
+typedef struct
+{
+    pTaskEventHandlerFn handler;
+    tmosEvents          events;
+    tmosTimer           timer[16];   // 每个事件位的剩余tick，0表示未启动
+    tmosTimer           reload[16];  // 重装载值，0表示单次
+} mock_tmos_task_t;
+
+static mock_tmos_task_t mock_tmos_task[MOCK_TMOS_TASK_MAX];
+static uint8_t          mock_tmos_task_num = 0;
+static uint32_t         mock_tmos_clock = 0;
+
+static mock_tmos_task_t *mock_tmos_get(tmosTaskID taskID)
+{
+    return (taskID < mock_tmos_task_num) ? &mock_tmos_task[taskID] : NULL;
+}
+
+// 事件位 -> 定时器下标，只接受单个事件位
+static int mock_tmos_bit(tmosEvents event)
+{
+    int i;
+
+    for(i = 0; i < 16; i++)
+    {
+        if(event == (1U << i))
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void mock_tmos_reset(void)
+{
+    memset(mock_tmos_task, 0, sizeof(mock_tmos_task));
+    mock_tmos_task_num = 0;
+    mock_tmos_clock = 0;
+}
+
+uint16_t mock_tmos_pending(uint8_t task_id)
+{
+    mock_tmos_task_t *t = mock_tmos_get(task_id);
+
+    return t ? t->events : 0;
+}
+
+void mock_tmos_poll(void)
+{
+    uint32_t calls = 0;
+    uint8_t  busy = 1;
+    uint8_t  id;
+
+    while(busy)
+    {
+        busy = 0;
+        // 处理函数一直不清除自己的事件时直接失败，而不是卡死测试
+        if(++calls > MOCK_TMOS_POLL_MAX)
+        {
+            fprintf(stderr, "mock_tmos_poll: event storm\n");
+            abort();
+        }
+        for(id = 0; id < mock_tmos_task_num; id++)
+        {
+            mock_tmos_task_t *t = &mock_tmos_task[id];
+            tmosEvents        events;
+
+            if(t->events)
+            {
+                events = t->events;
+                t->events = 0;
+                t->events |= t->handler(id, events);
+                busy = 1;
+                break; // 与库一致，每轮从优先级最高（最先注册）的任务开始
+            }
+        }
+    }
+}
+
+void mock_tmos_run(uint32_t ticks)
+{
+    while(ticks--)
+    {
+        uint8_t id;
+        int     i;
+
+        mock_tmos_clock++;
+        for(id = 0; id < mock_tmos_task_num; id++)
+        {
+            mock_tmos_task_t *t = &mock_tmos_task[id];
+
+            for(i = 0; i < 16; i++)
+            {
+                if(t->timer[i] && (--t->timer[i] == 0))
+                {
+                    t->events |= (1U << i);
+                    t->timer[i] = t->reload[i];
+                }
+            }
+        }
+        mock_tmos_poll();
+    }
+}
+
+tmosTaskID TMOS_ProcessEventRegister(pTaskEventHandlerFn eventCb)
+{
+    if(mock_tmos_task_num >= MOCK_TMOS_TASK_MAX)
+    {
+        return INVALID_TASK_ID;
+    }
+    mock_tmos_task[mock_tmos_task_num].handler = eventCb;
+    return mock_tmos_task_num++;
+}
+
+bStatus_t tmos_set_event(tmosTaskID taskID, tmosEvents event)
+{
+    mock_tmos_task_t *t = mock_tmos_get(taskID);
+
+    if(t == NULL)
+    {
+        return INVALID_TASK_ID;
+    }
+    t->events |= event;
+    return SUCCESS;
+}
+
+bStatus_t tmos_clear_event(tmosTaskID taskID, tmosEvents event)
+{
+    mock_tmos_task_t *t = mock_tmos_get(taskID);
+
+    if(t == NULL)
+    {
+        return INVALID_TASK_ID;
+    }
+    t->events &= ~event;
+    return SUCCESS;
+}
+
+static bStatus_t mock_tmos_start(tmosTaskID taskID, tmosEvents event, tmosTimer time, tmosTimer reload)
+{
+    mock_tmos_task_t *t = mock_tmos_get(taskID);
+    int               bit = mock_tmos_bit(event);
+
+    if((t == NULL) || (bit < 0))
+    {
+        return INVALID_TASK_ID;
+    }
+    // 0 tick按1 tick处理，下一次推进时间时到期
+    t->timer[bit] = time ? time : 1;
+    t->reload[bit] = reload;
+    return SUCCESS;
+}
+
+BOOL tmos_start_task(tmosTaskID taskID, tmosEvents event, tmosTimer time)
+{
+    return (mock_tmos_start(taskID, event, time, 0) == SUCCESS);
+}
+
+bStatus_t tmos_start_reload_task(tmosTaskID taskID, tmosEvents event, tmosTimer time)
+{
+    return mock_tmos_start(taskID, event, time, time);
+}
+
+bStatus_t tmos_stop_task(tmosTaskID taskID, tmosEvents event)
+{
+    mock_tmos_task_t *t = mock_tmos_get(taskID);
+    int               bit = mock_tmos_bit(event);
+
+    if((t == NULL) || (bit < 0))
+    {
+        return INVALID_TASK_ID;
+    }
+    t->timer[bit] = 0;
+    t->reload[bit] = 0;
+    return SUCCESS;
+}
+
+tmosTimer tmos_get_task_timer(tmosTaskID taskID, tmosEvents event)
+{
+    mock_tmos_task_t *t = mock_tmos_get(taskID);
+    int               bit = mock_tmos_bit(event);
+
+    return ((t == NULL) || (bit < 0)) ? 0 : t->timer[bit];
+}
+
+uint8_t *tmos_msg_receive(tmosTaskID taskID)
+{
+    (void)taskID;
+    return NULL;
+}
+
+bStatus_t tmos_msg_deallocate(uint8_t *msg_ptr)
+{
+    (void)msg_ptr;
+    return SUCCESS;
+}
+
+uint32_t TMOS_GetSystemClock(void)
+{
+    return mock_tmos_clock;
+}
@@ -0,0 +1,266 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : test_app_ctrl.c
+ * Author             :
+ * Version            : V1.0
+ * Date               : 2026/01/24
+ * Description        : app_ctrl_process() 表驱动测试
+ *                      旧格式、帧头/版本、截断、超长、未知类型、非法取值和应答，
+ *                      逐条检查返回值、PWM输出、输出模式和应答
+ *******************************************************************************/
+
+#include "CONFIG.h"
+#include "PWM.h"
+#include "app_ctrl.h"
+#include "app_uart.h"
+#include "mock_hw.h"
+#include "test_util.h"
+
+// 每条用例前的PWM输出，用于判断命令是否被执行
+#define SENT_TOTAL    17
+#define SENT_RATIO    33
+
+#define NO_PWM        -1
+#define NO_ACK        -1
+
+#define PCT(x)        PWM_PCT_TO_Q8(x)
+#define A5            APP_CTRL_MAGIC
+#define V1            APP_CTRL_VERSION
+
+typedef struct
+{
+    const char *name;
+    uint8_t     data[32];
+    uint16_t    len;
+    uint8_t     status;
+    int16_t     total_q8;   // NO_PWM: 输出不变
+    uint16_t    ratio_q8;
+    uint8_t     mode;       // 执行后的输出模式
+    int16_t     ack_seq;    // NO_ACK: 不应答
+} ctrl_case_t;
+
+static const ctrl_case_t ctrl_cases[] = {
+    // 旧格式
+    {"legacy 2B", {30, 70}, 2, APP_CTRL_OK, PCT(30), PCT(70), PWM_OUTPUT_ALIGNED, NO_ACK},
+    {"legacy 4B", {60, 20, 100, 0}, 4, APP_CTRL_OK, PCT(60), PCT(20), PWM_OUTPUT_ALIGNED, NO_ACK},
+    {"legacy clamp", {200, 255}, 2, APP_CTRL_OK, PCT(100), PCT(100), PWM_OUTPUT_ALIGNED, NO_ACK},
+    {"legacy empty", {0}, 0, APP_CTRL_ERR_LENGTH, NO_PWM, 0, PWM_OUTPUT_ALIGNED, NO_ACK},
+    {"legacy 1B", {50}, 1, APP_CTRL_ERR_LENGTH, NO_PWM, 0, PWM_OUTPUT_ALIGNED, NO_ACK},
+    {"legacy 3B", {50, 50, 0}, 3, APP_CTRL_ERR_LENGTH, NO_PWM, 0, PWM_OUTPUT_ALIGNED, NO_ACK},
+    {"legacy 5B", {50, 50, 0, 0, 0}, 5, APP_CTRL_ERR_LENGTH, NO_PWM, 0, PWM_OUTPUT_ALIGNED, NO_ACK},
+
+    // 帧头与版本
+    {"magic only", {A5}, 1, APP_CTRL_ERR_LENGTH, NO_PWM, 0, PWM_OUTPUT_ALIGNED, NO_ACK},
+    {"header only", {A5, V1}, 2, APP_CTRL_OK, NO_PWM, 0, PWM_OUTPUT_ALIGNED, NO_ACK},
+    {"version 0", {A5, 0x00, 0x01, 2, 40, 60}, 6, APP_CTRL_OK, PCT(40), PCT(60), PWM_OUTPUT_ALIGNED, NO_ACK},
+    {"version 2", {A5, 0x02, 0x01, 2, 40, 60}, 6, APP_CTRL_ERR_VERSION, NO_PWM, 0, PWM_OUTPUT_ALIGNED, NO_ACK},
+    {"version 2 seq", {A5, 0x02, 0x05, 1, 9, 0x01, 2, 40, 60}, 9, APP_CTRL_ERR_VERSION, NO_PWM, 0, PWM_OUTPUT_ALIGNED, NO_ACK},
+    {"version ff", {A5, 0xFF}, 2, APP_CTRL_ERR_VERSION, NO_PWM, 0, PWM_OUTPUT_ALIGNED, NO_ACK},
+
+    // 已知类型
+    {"set", {A5, V1, 0x01, 2, 40, 60}, 6, APP_CTRL_OK, PCT(40), PCT(60), PWM_OUTPUT_ALIGNED, NO_ACK},
+    {"fade", {A5, V1, 0x02, 4, 80, 10, 50, 0}, 8, APP_CTRL_OK, PCT(80), PCT(10), PWM_OUTPUT_ALIGNED, NO_ACK},
+    {"set q8", {A5, V1, 0x03, 4, 0x00, 0x01, 0x40, 0x00}, 8, APP_CTRL_OK, 256, 64, PWM_OUTPUT_ALIGNED, NO_ACK},
+    {"set q8 fade", {A5, V1, 0x03, 6, 0x80, 0x00, 0x00, 0x01, 30, 0}, 10, APP_CTRL_OK, 128, 256, PWM_OUTPUT_ALIGNED, NO_ACK},
+    {"set q8 over", {A5, V1, 0x03, 4, 0xFF, 0xFF, 0xFF, 0xFF}, 8, APP_CTRL_OK, 256, 256, PWM_OUTPUT_ALIGNED, NO_ACK},
+    {"mode seq", {A5, V1, 0x04, 1, PWM_OUTPUT_SEQUENTIAL}, 5, APP_CTRL_OK, NO_PWM, 0, PWM_OUTPUT_SEQUENTIAL, NO_ACK},
+    {"mode + set", {A5, V1, 0x01, 2, 50, 50, 0x04, 1, 1}, 9, APP_CTRL_OK, PCT(50), PCT(50), PWM_OUTPUT_SEQUENTIAL, NO_ACK},
+    {"last set wins", {A5, V1, 0x01, 2, 10, 10, 0x01, 2, 90, 90}, 10, APP_CTRL_OK, PCT(90), PCT(90), PWM_OUTPUT_ALIGNED, NO_ACK},
+    {"seq", {A5, V1, 0x05, 1, 0x42, 0x01, 2, 40, 60}, 9, APP_CTRL_OK, PCT(40), PCT(60), PWM_OUTPUT_ALIGNED, 0x42},
+
+    // 非法取值：跳过该条，其余照常执行，返回第一个错误
+    {"set len 3", {A5, V1, 0x01, 3, 1, 2, 3, 0x01, 2, 40, 60}, 11, APP_CTRL_ERR_VALUE, PCT(40), PCT(60), PWM_OUTPUT_ALIGNED, NO_ACK},
+    {"fade len 2", {A5, V1, 0x02, 2, 1, 2}, 6, APP_CTRL_ERR_VALUE, NO_PWM, 0, PWM_OUTPUT_ALIGNED, NO_ACK},
+    {"set q8 len 5", {A5, V1, 0x03, 5, 1, 2, 3, 4, 5}, 9, APP_CTRL_ERR_VALUE, NO_PWM, 0, PWM_OUTPUT_ALIGNED, NO_ACK},
+    {"mode 2", {A5, V1, 0x04, 1, 2}, 5, APP_CTRL_ERR_VALUE, NO_PWM, 0, PWM_OUTPUT_ALIGNED, NO_ACK},
+    {"mode len 0", {A5, V1, 0x04, 0}, 4, APP_CTRL_ERR_VALUE, NO_PWM, 0, PWM_OUTPUT_ALIGNED, NO_ACK},
+    {"seq len 2", {A5, V1, 0x05, 2, 1, 2}, 6, APP_CTRL_ERR_VALUE, NO_PWM, 0, PWM_OUTPUT_ALIGNED, NO_ACK},
+    {"uart parity 5", {A5, V1, 0x06, 6, 0x00, 0xC2, 0x01, 0x00, 5, 1}, 10, APP_CTRL_ERR_VALUE, NO_PWM, 0, PWM_OUTPUT_ALIGNED, NO_ACK},
+    {"uart stop 3", {A5, V1, 0x06, 6, 0x00, 0xC2, 0x01, 0x00, 0, 3}, 10, APP_CTRL_ERR_VALUE, NO_PWM, 0, PWM_OUTPUT_ALIGNED, NO_ACK},
+    {"uart baud 1", {A5, V1, 0x06, 6, 0x01, 0x00, 0x00, 0x00, 0, 1, 0x05, 1, 7}, 13, APP_CTRL_ERR_VALUE, NO_PWM, 0, PWM_OUTPUT_ALIGNED, 7},
+    {"uart 115200", {A5, V1, 0x06, 6, 0x00, 0xC2, 0x01, 0x00, 0, 1, 0x05, 1, 8}, 13, APP_CTRL_OK, NO_PWM, 0, PWM_OUTPUT_ALIGNED, 8},
+    {"bad value acked", {A5, V1, 0x04, 1, 9, 0x05, 1, 3}, 8, APP_CTRL_ERR_VALUE, NO_PWM, 0, PWM_OUTPUT_ALIGNED, 3},
+
+    // 截断：之后的命令不再解析，之前已解析的照常执行
+    {"tlv hdr cut", {A5, V1, 0x01}, 3, APP_CTRL_ERR_TRUNCATED, NO_PWM, 0, PWM_OUTPUT_ALIGNED, NO_ACK},
+    {"tlv value cut", {A5, V1, 0x01, 2, 40}, 5, APP_CTRL_ERR_TRUNCATED, NO_PWM, 0, PWM_OUTPUT_ALIGNED, NO_ACK},
+    {"tlv len ff", {A5, V1, 0x7F, 0xFF, 1, 2, 3}, 7, APP_CTRL_ERR_TRUNCATED, NO_PWM, 0, PWM_OUTPUT_ALIGNED, NO_ACK},
+    {"cut after set", {A5, V1, 0x01, 2, 40, 60, 0x01, 2, 90}, 9, APP_CTRL_ERR_TRUNCATED, PCT(40), PCT(60), PWM_OUTPUT_ALIGNED, NO_ACK},
+    {"cut after seq", {A5, V1, 0x05, 1, 0x11, 0x01, 2, 90}, 8, APP_CTRL_ERR_TRUNCATED, NO_PWM, 0, PWM_OUTPUT_ALIGNED, 0x11},
+    {"value then cut", {A5, V1, 0x04, 1, 7, 0x01}, 6, APP_CTRL_ERR_VALUE, NO_PWM, 0, PWM_OUTPUT_ALIGNED, NO_ACK},
+
+    // 未知类型按长度跳过
+    {"unknown", {A5, V1, 0x7F, 3, 1, 2, 3}, 7, APP_CTRL_OK, NO_PWM, 0, PWM_OUTPUT_ALIGNED, NO_ACK},
+    {"unknown + set", {A5, V1, 0x7F, 3, 1, 2, 3, 0x01, 2, 40, 60}, 11, APP_CTRL_OK, PCT(40), PCT(60), PWM_OUTPUT_ALIGNED, NO_ACK},
+    {"unknown len 0", {A5, V1, 0xC0, 0, 0x01, 2, 40, 60}, 8, APP_CTRL_OK, PCT(40), PCT(60), PWM_OUTPUT_ALIGNED, NO_ACK},
+    {"device types", {A5, V1, 0x81, 2, 1, 0, 0x82, 2, 0, 4}, 10, APP_CTRL_OK, NO_PWM, 0, PWM_OUTPUT_ALIGNED, NO_ACK},
+};
+
+static uint16_t expected_w1(uint16_t total_q8, uint16_t ratio_q8)
+{
+    uint32_t total = PWM_GammaLUT[total_q8 > PWM_Q8_ONE ? PWM_Q8_ONE : total_q8];
+
+    if(ratio_q8 > PWM_Q8_ONE)
+    {
+        ratio_q8 = PWM_Q8_ONE;
+    }
+    return (uint16_t)((total * ratio_q8 + 128) >> 8);
+}
+
+static void setup(void)
+{
+    mock_hw_reset();
+    mock_tmos_reset();
+    PWM_ComplementaryInit();
+    PWM_FadeInit();
+    app_uart_init();
+}
+
+// 执行一条写入并等渐变结束，返回app_ctrl_process()的结果
+static uint8_t run_case(const uint8_t *data, uint16_t len)
+{
+    uint8_t status;
+
+    PWM_SetOutputMode(PWM_OUTPUT_ALIGNED);
+    PWM_SetWidthsQ8(SENT_TOTAL, SENT_RATIO);
+    app_ctrl_ack_flush();
+
+    status = app_ctrl_process(data, len);
+    mock_tmos_run(MS1_TO_SYSTEM_TIME(1000));
+    return status;
+}
+
+static void check_case(const ctrl_case_t *c, uint8_t status)
+{
+    uint16_t w1, w2;
+    uint16_t exp_w1 = expected_w1(SENT_TOTAL, SENT_RATIO);
+    uint16_t exp_sum = PWM_GammaLUT[SENT_TOTAL];
+    uint8_t  ack[32];
+    uint16_t ack_len;
+    uint8_t  ok = 1;
+
+    if(c->total_q8 != NO_PWM)
+    {
+        exp_w1 = expected_w1(c->total_q8, c->ratio_q8);
+        exp_sum = PWM_GammaLUT[c->total_q8];
+    }
+    PWM_GetWidthsQ8(&w1, &w2);
+    ack_len = app_ctrl_ack_build(ack, sizeof(ack));
+
+    if(status != c->status)
+    {
+        fprintf(stderr, "[%s] status %u, expected %u\n", c->name, status, c->status);
+        ok = 0;
+    }
+    if((w1 != exp_w1) || (w1 + w2 != exp_sum))
+    {
+        fprintf(stderr, "[%s] widths %u/%u, expected %u/%u\n", c->name, w1, w2, exp_w1, exp_sum - exp_w1);
+        ok = 0;
+    }
+    if(PWM_GetOutputMode() != c->mode)
+    {
+        fprintf(stderr, "[%s] mode %u, expected %u\n", c->name, PWM_GetOutputMode(), c->mode);
+        ok = 0;
+    }
+    if(c->ack_seq == NO_ACK)
+    {
+        if(ack_len != 0)
+        {
+            fprintf(stderr, "[%s] unexpected ack\n", c->name);
+            ok = 0;
+        }
+    }
+    else if((ack_len != 6) || (ack[2] != APP_CTRL_TLV_ACK) || (ack[4] != c->ack_seq) || (ack[5] != c->status))
+    {
+        fprintf(stderr, "[%s] ack len %u seq %u result %u\n", c->name, ack_len, ack[4], ack[5]);
+        ok = 0;
+    }
+    CHECK(ok);
+}
+
+static void test_table(void)
+{
+    size_t i;
+
+    for(i = 0; i < sizeof(ctrl_cases) / sizeof(ctrl_cases[0]); i++)
+    {
+        const ctrl_case_t *c = &ctrl_cases[i];
+
+        check_case(c, run_case(c->data, c->len));
+    }
+}
+
+// 超长帧：超过一条通知/MTU的写入，TLV长度字段取满255
+static void test_oversize(void)
+{
+    uint8_t  frame[2 + 4 * (2 + 255) + 7];
+    uint16_t len = 0, w1, w2;
+    int      i;
+
+    frame[len++] = A5;
+    frame[len++] = V1;
+    for(i = 0; i < 4; i++)
+    {
+        frame[len++] = 0x70 + i;
+        frame[len++] = 255;
+        memset(&frame[len], 0x01, 255);
+        len += 255;
+    }
+    frame[len++] = APP_CTRL_TLV_SET;
+    frame[len++] = 2;
+    frame[len++] = 70;
+    frame[len++] = 30;
+    frame[len++] = APP_CTRL_TLV_SEQ;
+    frame[len++] = 1;
+    CHECK_EQ(len, sizeof(frame) - 1);
+
+    // 最后的SEQ缺少值：前面的命令执行，应答不发送
+    CHECK_EQ(run_case(frame, len), APP_CTRL_ERR_TRUNCATED);
+    PWM_GetWidthsQ8(&w1, &w2);
+    CHECK_EQ(w1, expected_w1(PCT(70), PCT(30)));
+    CHECK_EQ(app_ctrl_ack_pending(), 0);
+
+    frame[len++] = 0x5A;
+    CHECK_EQ(run_case(frame, len), APP_CTRL_OK);
+    CHECK_EQ(app_ctrl_ack_pending(), 1);
+}
+
+// 应答缓存满后丢弃，不覆盖已有应答
+static void test_ack_overflow(void)
+{
+    uint8_t  frame[] = {A5, V1, APP_CTRL_TLV_SEQ, 1, 0};
+    uint8_t  buf[64];
+    uint16_t len;
+    int      i;
+
+    app_ctrl_ack_flush();
+    for(i = 0; i < APP_CTRL_ACK_MAX + 4; i++)
+    {
+        frame[4] = (uint8_t)i;
+        app_ctrl_process(frame, sizeof(frame));
+    }
+    CHECK_EQ(app_ctrl_ack_pending(), APP_CTRL_ACK_MAX);
+
+    // 一条通知放不下时分批发送，顺序不变
+    len = app_ctrl_ack_build(buf, 4 + 2 * 3);
+    CHECK_EQ(len, 10);
+    CHECK_EQ(buf[3], 6);
+    CHECK_EQ(buf[4], 0);
+    CHECK_EQ(buf[8], 2);
+    app_ctrl_ack_release(len);
+    CHECK_EQ(app_ctrl_ack_pending(), APP_CTRL_ACK_MAX - 3);
+    len = app_ctrl_ack_build(buf, sizeof(buf));
+    CHECK_EQ(buf[4], 3);
+    CHECK_EQ(buf[len - 2], APP_CTRL_ACK_MAX - 1);
+    app_ctrl_ack_release(len);
+    CHECK_EQ(app_ctrl_ack_pending(), 0);
+    CHECK_EQ(app_ctrl_ack_build(buf, sizeof(buf)), 0);
+}
+
+int main(void)
+{
+    setup();
+    test_table();
+    test_oversize();
+    test_ack_overflow();
+    return TEST_RESULT();
+}
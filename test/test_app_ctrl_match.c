@@ -0,0 +1,45 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : test_app_ctrl_match.c
+ * Author             :
+ * Version            : V1.0
+ * Date               : 2026/01/24
+ * Description        : RX特征值(FFF2)的分流：0xA5开头的写入始终是透传数据，
+ *                      2/4字节写入只在APP_CTRL_LEGACY_ON_RX=1时按旧格式命令处理
+ *                      同一文件分别以 APP_CTRL_LEGACY_ON_RX=0/1 编译为两个测试
+ *******************************************************************************/
+
+#include "CONFIG.h"
+#include "app_ctrl.h"
+#include "test_util.h"
+
+static void test_frames_pass_through(void)
+{
+    static const uint8_t frame[] = {APP_CTRL_MAGIC, APP_CTRL_VERSION, APP_CTRL_TLV_SET, 2, 50, 50};
+    static const uint8_t hdr5[] = {APP_CTRL_MAGIC, APP_CTRL_VERSION, 0x7F, 1, 0};
+
+    CHECK_EQ(app_ctrl_match(frame, sizeof(frame)), 0);
+    CHECK_EQ(app_ctrl_match(hdr5, sizeof(hdr5)), 0);
+    CHECK_EQ(app_ctrl_match(frame, 3), 0);
+    CHECK_EQ(app_ctrl_match(frame, 1), 0);
+    CHECK_EQ(app_ctrl_match(frame, 0), 0);
+}
+
+static void test_legacy_lengths(void)
+{
+    static const uint8_t data[] = {30, 70, 0xE8, 0x03, 0, 0, 0, 0};
+    uint16_t             len;
+
+    for(len = 0; len <= sizeof(data); len++)
+    {
+        uint8_t expect = (APP_CTRL_LEGACY_ON_RX && ((len == 2) || (len == 4))) ? 1 : 0;
+
+        CHECK_EQ(app_ctrl_match(data, len), expect);
+    }
+}
+
+int main(void)
+{
+    test_frames_pass_through();
+    test_legacy_lengths();
+    return TEST_RESULT();
+}
@@ -0,0 +1,212 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : test_fifo_copy.c
+ * Author             :
+ * Version            : V1.0
+ * Date               : 2026/01/24
+ * Description        : app_drv_fifo 的拷贝路径与逐字节参考模型对照
+ *                      - fifo_span_copy()：源/目的各种对齐组合与长度，检查拷贝内容和越界
+ *                      - write/read/peek/peek_span：随机长度跨越缓冲区末尾回绕，
+ *                        缓冲区和用户数据均取非4字节对齐的地址
+ *                      fifo_span_copy()是静态函数，这里直接包含源文件
+ *******************************************************************************/
+
+#include "../APP/app_drv_fifo/app_drv_fifo.c"
+#include "test_util.h"
+#include <string.h>
+
+#define GUARD        0xEE
+#define MAX_SPAN     96
+
+static uint32_t rnd_state = 4242;
+
+static uint32_t rnd(void)
+{
+    rnd_state = rnd_state * 1103515245U + 12345U;
+    return rnd_state >> 16;
+}
+
+// 源/目的偏移0-7、长度0-MAX_SPAN的全部组合，目的区两侧各留保护字节
+static void test_span_copy(void)
+{
+    static uint32_t src_buf[(MAX_SPAN + 16) / 4];
+    static uint32_t dst_buf[(MAX_SPAN + 32) / 4];
+    uint8_t        *src = (uint8_t *)src_buf;
+    uint8_t        *dst = (uint8_t *)dst_buf;
+    uint16_t        so, dof, len, i;
+    uint8_t         ok = 1;
+
+    for(i = 0; i < sizeof(src_buf); i++)
+    {
+        src[i] = (uint8_t)(i * 7 + 1);
+    }
+    for(so = 0; so < 8; so++)
+    {
+        for(dof = 0; dof < 8; dof++)
+        {
+            for(len = 0; len <= MAX_SPAN; len++)
+            {
+                memset(dst, GUARD, sizeof(dst_buf));
+                fifo_span_copy(&dst[8 + dof], &src[so], len);
+
+                for(i = 0; i < sizeof(dst_buf); i++)
+                {
+                    uint8_t expect = GUARD;
+
+                    if((i >= 8 + dof) && (i < 8 + dof + len))
+                    {
+                        expect = src[so + i - 8 - dof];
+                    }
+                    if(dst[i] != expect)
+                    {
+                        fprintf(stderr, "src+%u dst+%u len %u: byte %u = %02X, expected %02X\n", so, dof, len,
+                                i, dst[i], expect);
+                        ok = 0;
+                        break;
+                    }
+                }
+            }
+        }
+    }
+    CHECK(ok);
+}
+
+// 参考模型：无界数组上的队列，下标不回绕
+typedef struct
+{
+    uint8_t  data[1 << 16];
+    uint32_t head;
+    uint32_t tail;
+} ref_fifo_t;
+
+static ref_fifo_t ref;
+
+static uint8_t fifo_matches(app_drv_fifo_t *fifo)
+{
+    uint16_t offset = 0, n;
+    uint8_t *span;
+
+    if(app_drv_fifo_length(fifo) != ref.head - ref.tail)
+    {
+        return 0;
+    }
+    // 按peek_span逐段比较，回绕时分两段
+    while((n = app_drv_fifo_peek_span(fifo, offset, &span)) != 0)
+    {
+        if((span < fifo->data) || (span + n > fifo->data + fifo->size) ||
+           (memcmp(span, &ref.data[ref.tail + offset], n) != 0))
+        {
+            return 0;
+        }
+        offset += n;
+    }
+    return offset == ref.head - ref.tail;
+}
+
+static void run_model(uint16_t size, uint8_t buf_offset, uint32_t steps)
+{
+    static uint32_t fifo_buf[(1024 + 8) / 4];
+    static uint32_t user_buf[(1536 + 8) / 4];
+    app_drv_fifo_t  fifo;
+    uint8_t        *user = (uint8_t *)user_buf + 1 + rnd() % 3;
+    uint8_t         ok = 1, wrapped = 0;
+    uint32_t        i;
+
+    memset(&ref, 0, sizeof(ref));
+    CHECK_EQ(app_drv_fifo_init(&fifo, (uint8_t *)fifo_buf + buf_offset, size), APP_DRV_FIFO_RESULT_SUCCESS);
+    // 让16位下标也跨过65535
+    fifo.begin = fifo.end = (uint16_t)(0x10000 - size / 2);
+
+    for(i = 0; (i < steps) && ok; i++)
+    {
+        uint16_t len = (uint16_t)(rnd() % (size + size / 2 + 1));
+        uint16_t before = fifo.end & fifo.size_mask;
+        uint16_t n = len, k;
+
+        switch(rnd() % 3)
+        {
+            case 0:
+                for(k = 0; k < len; k++)
+                {
+                    user[k] = (uint8_t)rnd();
+                }
+                if(app_drv_fifo_write(&fifo, user, &n) == APP_DRV_FIFO_RESULT_SUCCESS)
+                {
+                    memcpy(&ref.data[ref.head], user, n);
+                    ref.head += n;
+                    if(before + n > size)
+                    {
+                        wrapped = 1;
+                    }
+                }
+                else if(ref.head - ref.tail != size)
+                {
+                    ok = 0;
+                }
+                break;
+
+            case 1:
+                memset(user, GUARD, len + 4);
+                if(app_drv_fifo_read(&fifo, user, &n) == APP_DRV_FIFO_RESULT_SUCCESS)
+                {
+                    if((memcmp(user, &ref.data[ref.tail], n) != 0) || (user[n] != GUARD))
+                    {
+                        ok = 0;
+                    }
+                    ref.tail += n;
+                }
+                else if(ref.head != ref.tail)
+                {
+                    ok = 0;
+                }
+                break;
+
+            default:
+                memset(user, GUARD, len + 4);
+                n = app_drv_fifo_peek(&fifo, user, len);
+                if((n != MIN(len, ref.head - ref.tail)) || (memcmp(user, &ref.data[ref.tail], n) != 0) ||
+                   (user[n] != GUARD))
+                {
+                    ok = 0;
+                }
+                break;
+        }
+        if(ref.head > sizeof(ref.data) / 2)
+        {
+            memmove(ref.data, &ref.data[ref.tail], ref.head - ref.tail);
+            ref.head -= ref.tail;
+            ref.tail = 0;
+        }
+        if(ok && !fifo_matches(&fifo))
+        {
+            ok = 0;
+        }
+        if(!ok)
+        {
+            fprintf(stderr, "size %u offset %u: mismatch at step %u\n", size, buf_offset, i);
+        }
+    }
+    CHECK(ok);
+    CHECK(wrapped);
+}
+
+static void test_model(void)
+{
+    static const uint16_t sizes[] = {4, 16, 64, 256, 1024};
+    size_t                i;
+    uint8_t               offset;
+
+    for(i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+    {
+        for(offset = 0; offset < 4; offset++)
+        {
+            run_model(sizes[i], offset, 20000);
+        }
+    }
+}
+
+int main(void)
+{
+    test_span_copy();
+    test_model();
+    return TEST_RESULT();
+}
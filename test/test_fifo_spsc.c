@@ -0,0 +1,186 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : test_fifo_spsc.c
+ * Author             :
+ * Version            : V1.0
+ * Date               : 2026/01/24
+ * Description        : app_drv_fifo 单生产者/单消费者无锁用法的双线程压力测试
+ *                      生产者线程按序号写入（push/write/reserve_span+commit 随机选用），
+ *                      消费者线程同时读取（pop/read/peek+consume/peek_span+consume），
+ *                      逐字节检查序号，任何丢失、重复或读到未发布的数据都会出错
+ *                      主机上两个线程真正并行，比固件上中断与主循环的交错更严格
+ *******************************************************************************/
+
+#include "app_drv_fifo.h"
+#include "test_util.h"
+#include <pthread.h>
+#include <sched.h>
+#include <string.h>
+
+#define FIFO_SIZE      64
+#define TOTAL_BYTES    (16UL * 1000 * 1000)
+
+static uint8_t        fifo_buf[FIFO_SIZE];
+static app_drv_fifo_t fifo;
+
+static unsigned long consumer_errors = 0;
+static unsigned long consumer_first_bad = 0;
+
+// 第n个字节的值：不是n的简单截断，相差256的位置也能区分
+static uint8_t seq_byte(unsigned long n)
+{
+    return (uint8_t)(n ^ (n >> 8) ^ (n >> 16));
+}
+
+static uint32_t rnd(uint32_t *state)
+{
+    *state = *state * 1103515245U + 12345U;
+    return *state >> 16;
+}
+
+static void *producer(void *arg)
+{
+    unsigned long sent = 0;
+    uint32_t      state = 1;
+    uint8_t       chunk[FIFO_SIZE];
+
+    (void)arg;
+    while(sent < TOTAL_BYTES)
+    {
+        uint16_t want = (uint16_t)(1 + rnd(&state) % FIFO_SIZE);
+        uint16_t room = FIFO_SIZE - app_drv_fifo_length(&fifo);
+        uint16_t n, i;
+        uint8_t *span;
+
+        if(want > TOTAL_BYTES - sent)
+        {
+            want = (uint16_t)(TOTAL_BYTES - sent);
+        }
+        // 单核主机上让出CPU，否则满/空时要空转整个时间片
+        if(room == 0)
+        {
+            sched_yield();
+            continue;
+        }
+        switch(rnd(&state) % 3)
+        {
+            case 0:
+                app_drv_fifo_push(&fifo, seq_byte(sent++));
+                break;
+
+            case 1:
+                for(i = 0; i < want; i++)
+                {
+                    chunk[i] = seq_byte(sent + i);
+                }
+                n = want;
+                if(app_drv_fifo_write(&fifo, chunk, &n) == APP_DRV_FIFO_RESULT_SUCCESS)
+                {
+                    sent += n;
+                }
+                break;
+
+            default:
+                n = app_drv_fifo_reserve_span(&fifo, &span);
+                n = (n < want) ? n : want;
+                for(i = 0; i < n; i++)
+                {
+                    span[i] = seq_byte(sent + i);
+                }
+                app_drv_fifo_commit(&fifo, n);
+                sent += n;
+                break;
+        }
+    }
+    return NULL;
+}
+
+static void check_bytes(const uint8_t *data, uint16_t n, unsigned long *p_received)
+{
+    uint16_t i;
+
+    for(i = 0; i < n; i++)
+    {
+        if((data[i] != seq_byte(*p_received + i)) && (consumer_errors++ == 0))
+        {
+            consumer_first_bad = *p_received + i;
+        }
+    }
+    *p_received += n;
+}
+
+static void *consumer(void *arg)
+{
+    unsigned long received = 0;
+    uint32_t      state = 2;
+    uint8_t       chunk[FIFO_SIZE];
+
+    (void)arg;
+    while(received < TOTAL_BYTES)
+    {
+        uint16_t want = (uint16_t)(1 + rnd(&state) % FIFO_SIZE);
+        uint16_t n;
+        uint8_t *span;
+
+        if(app_drv_fifo_is_empty(&fifo))
+        {
+            sched_yield();
+            continue;
+        }
+        switch(rnd(&state) % 4)
+        {
+            case 0:
+                chunk[0] = app_drv_fifo_pop(&fifo);
+                check_bytes(chunk, 1, &received);
+                break;
+
+            case 1:
+                n = want;
+                if(app_drv_fifo_read(&fifo, chunk, &n) == APP_DRV_FIFO_RESULT_SUCCESS)
+                {
+                    check_bytes(chunk, n, &received);
+                }
+                break;
+
+            case 2:
+                n = app_drv_fifo_peek(&fifo, chunk, want);
+                check_bytes(chunk, n, &received);
+                app_drv_fifo_consume(&fifo, n);
+                break;
+
+            default:
+                // 回绕时只处理第一段，剩下的留给下一轮
+                n = app_drv_fifo_peek_span(&fifo, 0, &span);
+                n = (n < want) ? n : want;
+                check_bytes(span, n, &received);
+                app_drv_fifo_consume(&fifo, n);
+                break;
+        }
+    }
+    return NULL;
+}
+
+int main(void)
+{
+    pthread_t            tp, tc;
+    app_drv_fifo_stats_t stats;
+
+    CHECK_EQ(app_drv_fifo_init(&fifo, fifo_buf, sizeof(fifo_buf)), APP_DRV_FIFO_RESULT_SUCCESS);
+    // 16位下标在测试开始后不久回绕
+    fifo.begin = fifo.end = 0xFF00;
+
+    CHECK_EQ(pthread_create(&tc, NULL, consumer, NULL), 0);
+    CHECK_EQ(pthread_create(&tp, NULL, producer, NULL), 0);
+    pthread_join(tp, NULL);
+    pthread_join(tc, NULL);
+
+    if(consumer_errors)
+    {
+        fprintf(stderr, "%lu bad bytes, first at %lu\n", consumer_errors, consumer_first_bad);
+    }
+    CHECK_EQ(consumer_errors, 0);
+    CHECK(app_drv_fifo_is_empty(&fifo));
+    app_drv_fifo_get_stats(&fifo, &stats);
+    CHECK(stats.high_water <= FIFO_SIZE);
+    CHECK_EQ(stats.dropped, 0);
+    return TEST_RESULT();
+}
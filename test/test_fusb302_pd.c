@@ -0,0 +1,381 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : test_fusb302_pd.c
+ * Author             :
+ * Version            : V1.0
+ * Date               : 2026/01/24
+ * Description        : FUSB302 PD协商：脚本化寄存器后端上的 Source_Capabilities -> Request
+ *                      - USB302_Attach_Config() 的寄存器配置
+ *                      - USB302_Data_Service()：第一条Source_Capabilities设置PD版本，
+ *                        第二条保存档位；硬复位重新等待
+ *                      - USB302_Select_PDO() 的选择结果和写入TX FIFO的Request消息(令牌、消息头、RDO)
+ *******************************************************************************/
+
+#include "CONFIG.h"
+#include "FUSB30X.h"
+#include "mock_fusb302.h"
+#include "mock_hw.h"
+#include "test_util.h"
+
+#define PD_HDR(type, rev, n, id)    ((uint16_t)((type) | ((rev) << 6) | 0x20 | 0x100 | ((id) << 9) | ((n) << 12)))
+#define PD_SRC_CAP                  1
+#define PD_GOODCRC                  1
+#define PD_REV20                    1
+#define PD_REV30                    2
+
+#define PDO_FIXED(mv, ma)           ((((uint32_t)(mv) / 50) << 10) | ((ma) / 10))
+#define PDO_PPS(min_mv, max_mv, ma) ((3UL << 30) | (((uint32_t)(max_mv) / 100) << 17) | \
+                                     (((uint32_t)(min_mv) / 100) << 8) | ((ma) / 50))
+
+#define RDO_FLAGS                   ((1UL << 25) | (1UL << 24))
+
+// FUSB30X.c 中未在头文件导出的协商状态
+extern uint8_t PD_MSG_ID;
+extern uint8_t RX_Length;
+
+static const uint32_t caps_fixed[] = {
+    PDO_FIXED(5000, 3000) | (1UL << 26), PDO_FIXED(9000, 3000), PDO_FIXED(15000, 3000),
+    PDO_FIXED(20000, 2250), PDO_FIXED(12000, 1500),
+};
+
+static const uint32_t caps_pps[] = {
+    PDO_FIXED(5000, 3000), PDO_FIXED(9000, 2000), PDO_FIXED(12000, 1500),
+    PDO_PPS(3300, 11000, 3000), PDO_PPS(3300, 21000, 3000), PDO_PPS(3300, 21000, 2000),
+};
+
+static void setup(void)
+{
+    mock_hw_reset();
+    // INT脚(PB5)低电平：有中断
+    mock_fusb302_reset();
+    fusb302_iic_set_ops(&mock_fusb302_ops);
+    USB302_Attach_Start(1);
+    USB302_Attach_Config();
+}
+
+static uint32_t le32(const uint8_t *p)
+{
+    return p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+// 最后一次写入寄存器reg的值，没有时返回-1
+static int last_reg_write(uint8_t reg, uint16_t from)
+{
+    int idx, last = -1;
+
+    while((idx = mock_fusb302_find_write(reg, from)) >= 0)
+    {
+        last = mock_fusb302_write_get(idx)->data[0];
+        from = idx + 1;
+    }
+    return last;
+}
+
+// 电源发两次Source_Capabilities：第一次设置版本并复位PD，第二次保存档位
+static void source_caps(const uint32_t *caps, uint8_t n, uint8_t rev)
+{
+    uint16_t from = mock_fusb302_write_count();
+
+    mock_fusb302_rx(PD_HDR(PD_SRC_CAP, rev, n, 0), caps);
+    USB302_Data_Service();
+    CHECK_EQ(PD_STEP, 1);
+    CHECK_EQ(last_reg_write(0x03, from), ((rev << 6) >> 1) | 0x05);
+    CHECK_EQ(last_reg_write(0x0C, from), 0x02);
+    CHECK_EQ(PD_MSG_ID, 0);
+
+    mock_fusb302_rx(PD_HDR(PD_SRC_CAP, rev, n, 1), caps);
+    USB302_Data_Service();
+    CHECK_EQ(PD_STEP, 2);
+    CHECK_EQ(PD_Source_Capabilities_Inf_num, n);
+    CHECK(mock_fusb302_reg[FUSB302_REG_STATUS1] & 0x20);
+}
+
+// 取出最近一次写入TX FIFO的Request，检查令牌和消息头，返回RDO
+static uint32_t sent_request(uint8_t rev, uint8_t msg_id)
+{
+    static const uint8_t sop[5] = {0x12, 0x12, 0x12, 0x13, 0x86};
+    static const uint8_t eop[3] = {0xFF, 0x14, 0xA1};
+    const mock_fusb302_write_t *w;
+    int                         idx = -1, i, from = 0;
+
+    while((i = mock_fusb302_find_write(MOCK_FUSB302_FIFO, from)) >= 0)
+    {
+        idx = i;
+        from = i + 1;
+    }
+    CHECK(idx >= 0);
+    if(idx < 0)
+    {
+        return 0;
+    }
+    w = mock_fusb302_write_get(idx);
+    CHECK_EQ(w->len, 14);
+    CHECK(memcmp(w->data, sop, sizeof(sop)) == 0);
+    CHECK(memcmp(&w->data[11], eop, sizeof(eop)) == 0);
+    // Request，1个数据对象，Sink/UFP
+    CHECK_EQ(w->data[5], 0x02 | (rev << 6));
+    CHECK_EQ(w->data[6], 0x10 | (msg_id << 1));
+    // 前后的寄存器操作：清TX FIFO，写入后开始发送
+    CHECK_EQ(mock_fusb302_write_get(idx - 1)->reg, 0x06);
+    CHECK_EQ(mock_fusb302_write_get(idx - 1)->data[0], 0x40);
+    CHECK_EQ(mock_fusb302_write_get(idx + 1)->reg, 0x06);
+    CHECK_EQ(mock_fusb302_write_get(idx + 1)->data[0], 0x05);
+    return le32(&w->data[7]);
+}
+
+static void test_attach_config(void)
+{
+    setup();
+    CHECK_EQ(last_reg_write(0x02, 0), 0x05);   // MEAS_CC1
+    CHECK_EQ(last_reg_write(0x03, 0), 0x41);   // BMC TX on CC1
+    CHECK_EQ(last_reg_write(0x0B, 0), 0x0F);
+    CHECK_EQ(PD_STEP, 0);
+    CHECK_EQ(PD_Source_Capabilities_Inf_num, 0);
+}
+
+// 固定档位：窗口内功率最大的为15V/3A与20V/2.25A（45W），取序号小的
+static void test_fixed_request(void)
+{
+    uint8_t msg_id;
+    uint32_t rdo;
+
+    setup();
+    source_caps(caps_fixed, 5, PD_REV20);
+    msg_id = PD_MSG_ID;
+
+    USB302_Get_Data();
+    CHECK_EQ(PD_STEP, 3);
+    CHECK_EQ(PD_Request_Inf.position, 3);
+    CHECK_EQ(PD_Request_Inf.type, USB302_PDO_FIXED);
+    CHECK_EQ(PD_Request_Inf.voltage_mv, 15000);
+    CHECK_EQ(PD_Request_Inf.current_ma, 3000);
+    CHECK_EQ(PD_Request_Inf.mismatch, 0);
+
+    rdo = sent_request(PD_REV20, msg_id);
+    CHECK_EQ(rdo, (3UL << 28) | RDO_FLAGS | (300UL << 10) | 300);
+    CHECK_EQ(PD_MSG_ID, msg_id + 1);
+
+    // 电源回GoodCRC/Accept，消息序号继续递增
+    mock_fusb302_rx(PD_HDR(PD_GOODCRC, PD_REV20, 0, 1) & ~0x100, NULL);
+    USB302_Data_Service();
+    CHECK_EQ(PD_MSG_ID, msg_id + 2);
+}
+
+// 窗口内没有满足电流要求的档位：请求第1档并置Capability Mismatch
+static void test_mismatch(void)
+{
+    static const uint32_t caps[] = {PDO_FIXED(5000, 400), PDO_FIXED(9000, 300)};
+    uint32_t              rdo;
+
+    setup();
+    source_caps(caps, 2, PD_REV20);
+    CHECK_EQ(USB302_Select_PDO(&PD_Request_Inf), 1);
+    CHECK_EQ(PD_Request_Inf.position, 1);
+    CHECK_EQ(PD_Request_Inf.mismatch, 1);
+    USB302_Get_Data();
+    rdo = sent_request(PD_REV20, 1);
+    CHECK_EQ(rdo, (1UL << 28) | (1UL << 26) | RDO_FLAGS | (40UL << 10) | 40);
+}
+
+// 带PPS的电源：PPS启用时选覆盖LED电压、电流最大的APDO，请求电压固定；默认关闭时按固定档位选择
+static void test_pps_caps(void)
+{
+    uint32_t rdo;
+
+    setup();
+    source_caps(caps_pps, 6, PD_REV30);
+    USB302_Get_Data();
+#if USB302_PPS_ENABLE
+    {
+        uint16_t mv = (USB302_PPS_VF_MV + USB302_PPS_HEADROOM_MV) / USB302_PPS_STEP_MV * USB302_PPS_STEP_MV;
+
+        // 档位4的最高电压不够，档位5与6覆盖范围相同，取电流大的5
+        CHECK_EQ(PD_Request_Inf.position, 5);
+        CHECK_EQ(PD_Request_Inf.type, USB302_PDO_APDO);
+        CHECK_EQ(PD_Request_Inf.voltage_mv, mv);
+        rdo = sent_request(PD_REV30, 1);
+        CHECK_EQ(rdo, (5UL << 28) | RDO_FLAGS | ((uint32_t)(mv / 20) << 9) | (3000 / 50));
+    }
+#else
+    // APDO不参与选择：9V/2A(18W)与12V/1.5A(18W)功率相同，取序号小的
+    CHECK_EQ(PD_Request_Inf.position, 2);
+    CHECK_EQ(PD_Request_Inf.type, USB302_PDO_FIXED);
+    rdo = sent_request(PD_REV20, 1);
+    CHECK_EQ(rdo, (2UL << 28) | RDO_FLAGS | (200UL << 10) | 200);
+#endif
+}
+
+// PPS的RDO电压字段为11位(bit19-9)，超出的请求电压不能写进bit20之上的保留位/标志位
+static void test_pps_rdo_mask(void)
+{
+    USB302_Request_TypeDef req;
+    uint8_t                msg_id;
+    uint32_t               rdo;
+
+    setup();
+    source_caps(caps_pps, 6, PD_REV30);
+    msg_id = PD_MSG_ID;
+    memset(&req, 0, sizeof(req));
+    req.position = 5;
+    req.type = USB302_PDO_APDO;
+    req.voltage_mv = 0x801 * USB302_PPS_STEP_MV;
+    req.current_ma = 3000;
+    USB302_Send_Request(&req);
+    rdo = sent_request(PD_REV30, msg_id);
+    CHECK_EQ(rdo, (5UL << 28) | RDO_FLAGS | (1UL << 9) | (3000 / 50));
+}
+
+// 电源端硬复位：档位作废，重新等待Source_Capabilities
+static void test_hard_reset(void)
+{
+    setup();
+    source_caps(caps_fixed, 5, PD_REV20);
+    mock_fusb302_reg[FUSB302_REG_INTERRUPTA] = 0x01;
+    USB302_Data_Service();
+    CHECK_EQ(PD_STEP, 0);
+    CHECK_EQ(PD_Source_Capabilities_Inf_num, 0);
+    CHECK_EQ(mock_fusb302_reg[FUSB302_REG_INTERRUPTA], 0);
+
+    source_caps(caps_fixed, 5, PD_REV20);
+}
+
+// INT脚无效时不访问芯片；芯片无应答时按无消息处理
+static void test_idle_and_nack(void)
+{
+    uint16_t n;
+
+    setup();
+    mock_fusb302_rx(PD_HDR(PD_SRC_CAP, PD_REV20, 5, 0), caps_fixed);
+    R32_PB_PIN |= GPIO_Pin_5;
+    n = mock_fusb302_write_count();
+    USB302_Data_Service();
+    CHECK_EQ(mock_fusb302_write_count(), n);
+    CHECK_EQ(PD_STEP, 0);
+
+    R32_PB_PIN &= ~GPIO_Pin_5;
+    mock_fusb302_nack = 1;
+    USB302_Data_Service();
+    CHECK_EQ(PD_STEP, 0);
+    CHECK_EQ(RX_Length, 0);
+}
+
+static uint16_t done_calls = 0;
+
+static void count_done(void)
+{
+    done_calls++;
+}
+
+// 中断方式收包：逐次结束读取并继续，返回启动的读取次数
+static uint16_t async_service(void)
+{
+    uint16_t starts = mock_fusb302_read_starts;
+    uint16_t calls = done_calls;
+
+    CHECK_EQ(USB302_Rx_Start(), 0);
+    CHECK(USB302_Rx_Busy());
+    // 上一次收包未结束时不能再启动
+    CHECK_EQ(USB302_Rx_Start(), 1);
+    while(mock_fusb302_xfer_irq())
+    {
+        if(!USB302_Rx_Continue())
+        {
+            break;
+        }
+    }
+    CHECK(!USB302_Rx_Busy());
+    // 每次读取结束都调用一次回调
+    CHECK_EQ(done_calls - calls, mock_fusb302_read_starts - starts);
+    return mock_fusb302_read_starts - starts;
+}
+
+static void setup_async(void)
+{
+    setup();
+    fusb302_iic_set_ops(&mock_fusb302_async_ops);
+    fusb302_iic_set_done_callback(count_done);
+    done_calls = 0;
+}
+
+// 中断方式收包：状态寄存器、令牌+消息头、数据对象三次读取，结果与阻塞读取相同
+static void test_async_rx(void)
+{
+    uint16_t from;
+    uint8_t  msg_id;
+
+    // 阻塞传输不支持中断方式，由调用者改用USB302_Data_Service()
+    setup();
+    CHECK_EQ(USB302_Rx_Start(), 1);
+
+    setup_async();
+    from = mock_fusb302_write_count();
+    mock_fusb302_rx(PD_HDR(PD_SRC_CAP, PD_REV20, 5, 0), caps_fixed);
+    CHECK_EQ(async_service(), 3);
+    CHECK_EQ(PD_STEP, 1);
+    CHECK_EQ(last_reg_write(0x07, from), 0x04);
+
+    mock_fusb302_rx(PD_HDR(PD_SRC_CAP, PD_REV20, 5, 1), caps_fixed);
+    CHECK_EQ(async_service(), 3);
+    CHECK_EQ(PD_STEP, 2);
+    CHECK_EQ(PD_Source_Capabilities_Inf_num, 5);
+    CHECK_EQ(RX_Length, 3 + 5 * 4 + 4);
+    CHECK_EQ(le32(PD_Source_Capabilities_Inf[2].PDC_INF), caps_fixed[2]);
+
+    msg_id = PD_MSG_ID;
+    USB302_Get_Data();
+    CHECK_EQ(sent_request(PD_REV20, msg_id), (3UL << 28) | RDO_FLAGS | (300UL << 10) | 300);
+
+    // 只有中断、没有消息：读一次状态寄存器即结束
+    mock_fusb302_reg[FUSB302_REG_INTERRUPTA] = 0x01;
+    CHECK_EQ(async_service(), 1);
+    CHECK_EQ(PD_STEP, 0);
+    CHECK_EQ(RX_Length, 0);
+
+    // 芯片无应答：按没有消息处理
+    mock_fusb302_rx(PD_HDR(PD_SRC_CAP, PD_REV20, 5, 0), caps_fixed);
+    mock_fusb302_nack = 1;
+    CHECK_EQ(async_service(), 1);
+    CHECK_EQ(PD_STEP, 0);
+    CHECK_EQ(RX_Length, 0);
+}
+
+// 读取数据对象时超时：中止传输，丢弃该消息并清空RX FIFO，之后可重新收包
+static void test_async_abort(void)
+{
+    uint16_t from;
+
+    setup_async();
+    mock_fusb302_rx(PD_HDR(PD_SRC_CAP, PD_REV20, 5, 0), caps_fixed);
+    CHECK_EQ(USB302_Rx_Start(), 0);
+    CHECK(mock_fusb302_xfer_irq());
+    CHECK_EQ(USB302_Rx_Continue(), 1);
+    CHECK(mock_fusb302_xfer_irq());
+    CHECK_EQ(USB302_Rx_Continue(), 1);
+
+    from = mock_fusb302_write_count();
+    USB302_Rx_Abort();
+    CHECK(!USB302_Rx_Busy());
+    CHECK_EQ(RX_Length, 0);
+    CHECK_EQ(PD_STEP, 0);
+    CHECK_EQ(last_reg_write(0x07, from), 0x04);
+    // 中止后不再有结束通知
+    CHECK(!mock_fusb302_xfer_irq());
+    CHECK_EQ(USB302_Rx_Continue(), 0);
+
+    mock_fusb302_rx(PD_HDR(PD_SRC_CAP, PD_REV20, 5, 0), caps_fixed);
+    CHECK_EQ(async_service(), 3);
+    CHECK_EQ(PD_STEP, 1);
+}
+
+int main(void)
+{
+    test_attach_config();
+    test_fixed_request();
+    test_mismatch();
+    test_pps_caps();
+    test_pps_rdo_mask();
+    test_hard_reset();
+    test_idle_and_nack();
+    test_async_rx();
+    test_async_abort();
+    return TEST_RESULT();
+}
@@ -0,0 +1,235 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : test_pwm_commit.c
+ * Author             :
+ * Version            : V1.0
+ * Date               : 2026/01/24
+ * Description        : PWM4/PWM5数据寄存器(0x40005004)的提交时机
+ *                      输出开启后，宽度更新只写影子(g_hw_data)，两路数据在PWMX周期结束
+ *                      中断中以一次半字写入提交；周期内多次更新只提交最后一次
+ *******************************************************************************/
+
+#include "CONFIG.h"
+#include "PWM.h"
+#include "mock_hw.h"
+#include "test_util.h"
+
+#define PWMX_DATA_ADDR    0x40005004UL
+#define PWMX_IRQ_CTX      "PWMX_IRQHandler"
+
+static uint32_t rnd_state = 12345;
+
+static uint32_t rnd(void)
+{
+    rnd_state = rnd_state * 1103515245U + 12345U;
+    return rnd_state >> 16;
+}
+
+static uint16_t hw_width(uint16_t w)
+{
+    return (uint16_t)(w - (w >> 8));
+}
+
+// 当前宽度对应的寄存器半字（对齐模式）
+static uint16_t expected_data(void)
+{
+    uint16_t w1, w2;
+
+    PWM_GetWidthsQ8(&w1, &w2);
+    return (uint16_t)(hw_width(w1) | (hw_width(w2) << 8));
+}
+
+static uint16_t reg_data(void)
+{
+    return (uint16_t)(R8_PWM4_DATA | (R8_PWM5_DATA << 8));
+}
+
+static void setup(void)
+{
+    mock_hw_reset();
+    mock_tmos_reset();
+    PWM_ComplementaryInit();
+    PWM_FadeInit();
+    // 第一次设置在输出开启前直接写入
+    PWM_SetWidthsQ8(128, 128);
+    mock_trace_sync();
+    mock_trace_clear();
+}
+
+// from之后对PWM4/PWM5数据寄存器的写入是否都发生在周期结束中断中
+static uint8_t data_written_in_irq_only(uint16_t from)
+{
+    uint16_t i;
+
+    for(i = from; i < mock_trace_count(); i++)
+    {
+        const mock_reg_write_t *w = mock_trace_get(i);
+
+        if((w->addr <= PWMX_DATA_ADDR + 1) && (w->addr + w->width > PWMX_DATA_ADDR) &&
+           (strcmp(w->ctx, PWMX_IRQ_CTX) != 0))
+        {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static void test_random_updates(void)
+{
+    uint16_t committed, pending;
+    uint8_t  stale = 0, late = 0, in_main = 0;
+    int      i;
+
+    setup();
+    committed = reg_data();
+    pending = committed;
+
+    for(i = 0; i < 5000; i++)
+    {
+        uint16_t from = mock_trace_count();
+
+        switch(rnd() % 4)
+        {
+            case 0:
+            case 1:
+                PWM_SetWidthsQ8(rnd() % (PWM_Q8_ONE + 1), rnd() % (PWM_Q8_ONE + 1));
+                break;
+
+            case 2:
+                PWM_FadeToQ8(rnd() % (PWM_Q8_ONE + 1), rnd() % (PWM_Q8_ONE + 1), 20 + rnd() % 80);
+                break;
+
+            default:
+                mock_tmos_run(1 + rnd() % 20);
+                break;
+        }
+        pending = expected_data();
+        mock_trace_sync();
+
+        // 周期结束前寄存器保持上次提交的值
+        if(reg_data() != committed)
+        {
+            stale = 1;
+        }
+        if(rnd() % 3)
+        {
+            mock_pwmx_cycle_end();
+            committed = reg_data();
+            if(committed != pending)
+            {
+                late = 1;
+            }
+        }
+        if(!data_written_in_irq_only(from))
+        {
+            in_main = 1;
+        }
+        if(mock_trace_count() > MOCK_TRACE_MAX / 2)
+        {
+            mock_trace_clear();
+        }
+    }
+    CHECK(!stale);
+    CHECK(!late);
+    CHECK(!in_main);
+}
+
+static void test_halfword_commit(void)
+{
+    int                     idx;
+    const mock_reg_write_t *w;
+
+    setup();
+    // 两次更新都在同一个周期内，只提交后一次
+    PWM_SetWidthsQ8(PWM_Q8_ONE, PWM_Q8_ONE / 4);
+    PWM_SetWidthsQ8(PWM_Q8_ONE, PWM_Q8_ONE * 3 / 4);
+    mock_trace_sync();
+    CHECK_EQ(mock_trace_find(PWMX_DATA_ADDR, 0), -1);
+    CHECK_EQ(mock_trace_find(PWMX_DATA_ADDR + 1, 0), -1);
+
+    CHECK(mock_pwmx_cycle_end());
+    CHECK_EQ(reg_data(), expected_data());
+    idx = mock_trace_find(PWMX_DATA_ADDR, 0);
+    CHECK(idx >= 0);
+    if(idx >= 0)
+    {
+        w = mock_trace_get(idx);
+        CHECK(strcmp(w->ctx, PWMX_IRQ_CTX) == 0);
+        CHECK_EQ(w->addr, PWMX_DATA_ADDR);
+        CHECK_EQ(w->width, 2);
+        CHECK_EQ(w->value, expected_data());
+        CHECK_EQ(mock_trace_find(PWMX_DATA_ADDR, idx + 1), -1);
+    }
+
+    // 已提交且没有新数据时不再进入中断
+    CHECK(!mock_pwmx_cycle_end());
+}
+
+// 顺序模式：PWM5低电平有效，数据为256-width2，同样只在周期结束提交
+static void test_sequential(void)
+{
+    uint16_t w1, w2;
+    int      idx;
+
+    setup();
+    PWM_SetOutputMode(PWM_OUTPUT_SEQUENTIAL);
+    mock_pwmx_cycle_end();
+    mock_trace_sync();
+    mock_trace_clear();
+
+    PWM_SetWidthsQ8(PWM_Q8_ONE, PWM_Q8_ONE / 4);
+    PWM_GetWidthsQ8(&w1, &w2);
+    mock_trace_sync();
+    CHECK_EQ(mock_trace_find(PWMX_DATA_ADDR, 0), -1);
+    CHECK(mock_pwmx_cycle_end());
+    CHECK_EQ(R8_PWM4_DATA, hw_width(w1));
+    CHECK_EQ(R8_PWM5_DATA, (uint8_t)(PWM_Q8_ONE - w2));
+    idx = mock_trace_find(PWMX_DATA_ADDR, 0);
+    CHECK(idx >= 0);
+    if(idx >= 0)
+    {
+        CHECK(strcmp(mock_trace_get(idx)->ctx, PWMX_IRQ_CTX) == 0);
+    }
+}
+
+// 顺序模式下width2由非0变为0：上一次更新的周期结束中断在两次影子写入之间到来，
+// 不能以PWM5数据0（低电平有效即整周期高电平）配合旧的使能提交，否则PWM5与PWM4重叠
+static void test_sequential_irq_in_update(void)
+{
+    uint16_t w1, w2;
+
+    setup();
+    PWM_SetOutputMode(PWM_OUTPUT_SEQUENTIAL);
+    mock_pwmx_cycle_end();
+    PWM_SetWidthsQ8(PWM_Q8_ONE / 2, PWM_Q8_ONE / 2);
+    mock_pwmx_cycle_end();
+    CHECK(R8_PWM_OUT_EN & PWM_CHANNEL_2);
+
+    // 待提交的更新，中断已开启
+    PWM_SetWidthsQ8(PWM_Q8_ONE / 2, PWM_Q8_ONE * 3 / 4);
+    mock_pwmx_fire_in_update = 1;
+    // 比例为256：PWM4占全部，width2为0
+    PWM_SetWidthsQ8(PWM_Q8_ONE / 2, PWM_Q8_ONE);
+    CHECK_EQ(mock_pwmx_fire_in_update, 0);
+    CHECK(!(R8_PWM_OUT_EN & PWM_CHANNEL_2) || (R8_PWM5_DATA != 0));
+
+    // 下一个周期结束时完整提交：PWM5关闭
+    CHECK(mock_pwmx_cycle_end());
+    PWM_GetWidthsQ8(&w1, &w2);
+    CHECK_EQ(w2, 0);
+    CHECK_EQ(R8_PWM4_DATA, hw_width(w1));
+    CHECK(R8_PWM_OUT_EN & PWM_CHANNEL_1);
+    CHECK(!(R8_PWM_OUT_EN & PWM_CHANNEL_2));
+}
+
+int main(void)
+{
+    test_halfword_commit();
+    test_random_updates();
+    test_sequential();
+    test_sequential_irq_in_update();
+    if(test_failures)
+    {
+        mock_trace_dump(stderr);
+    }
+    return TEST_RESULT();
+}
@@ -0,0 +1,95 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : test_pwm_fade.c
+ * Author             :
+ * Version            : V1.0
+ * Date               : 2026/01/24
+ * Description        : 渐变引擎：按tick推进到目标，直接设置打断渐变后
+ *                      已置位的PWM_FADE_EVT不能再改变输出
+ *******************************************************************************/
+
+#include "CONFIG.h"
+#include "PWM.h"
+#include "mock_hw.h"
+#include "test_util.h"
+
+// PWM_FadeInit()是复位后第一个注册的任务
+#define PWM_TASK    0
+
+static void setup(void)
+{
+    mock_hw_reset();
+    mock_tmos_reset();
+    PWM_ComplementaryInit();
+    PWM_FadeInit();
+    PWM_SetWidthsQ8(0, PWM_Q8_ONE);
+}
+
+static void test_fade_reaches_target(void)
+{
+    uint16_t w1, w2, last = 0;
+    uint8_t  mono = 1;
+    int      i;
+
+    setup();
+    PWM_FadeToQ8(PWM_Q8_ONE, PWM_Q8_ONE, 100);
+    CHECK(PWM_FadeIsActive());
+    for(i = 0; i < 10; i++)
+    {
+        mock_tmos_run(MS1_TO_SYSTEM_TIME(PWM_FADE_TICK_MS));
+        PWM_GetWidthsQ8(&w1, &w2);
+        if(w1 < last)
+        {
+            mono = 0;
+        }
+        last = w1;
+    }
+    CHECK(mono);
+    CHECK(!PWM_FadeIsActive());
+    CHECK_EQ(w1, PWM_Q8_ONE);
+    CHECK_EQ(tmos_get_task_timer(PWM_TASK, PWM_FADE_EVT), 0);
+}
+
+// 定时已到期、事件已置位但尚未处理时被直接设置打断
+static void test_stop_clears_pending_event(void)
+{
+    uint16_t w1, w2;
+
+    setup();
+    PWM_FadeToQ8(PWM_Q8_ONE, PWM_Q8_ONE, 500);
+    mock_tmos_run(MS1_TO_SYSTEM_TIME(PWM_FADE_TICK_MS) * 3);
+    CHECK(PWM_FadeIsActive());
+
+    tmos_set_event(PWM_TASK, PWM_FADE_EVT);
+    PWM_SetWidthsQ8(64, PWM_Q8_ONE);
+    CHECK(!PWM_FadeIsActive());
+    CHECK_EQ(mock_tmos_pending(PWM_TASK) & PWM_FADE_EVT, 0);
+    CHECK_EQ(tmos_get_task_timer(PWM_TASK, PWM_FADE_EVT), 0);
+
+    mock_tmos_run(MS1_TO_SYSTEM_TIME(PWM_FADE_TICK_MS) * 10);
+    PWM_GetWidthsQ8(&w1, &w2);
+    CHECK_EQ(w1, PWM_GammaLUT[64]);
+}
+
+// 没有渐变时收到的事件直接丢弃
+static void test_stray_event_ignored(void)
+{
+    uint16_t w1, w2;
+
+    setup();
+    PWM_FadeToQ8(PWM_Q8_ONE, PWM_Q8_ONE, 100);
+    PWM_SetWidthsQ8(32, PWM_Q8_ONE);
+
+    tmos_set_event(PWM_TASK, PWM_FADE_EVT);
+    mock_tmos_poll();
+    PWM_GetWidthsQ8(&w1, &w2);
+    CHECK_EQ(w1, PWM_GammaLUT[32]);
+    CHECK(!PWM_FadeIsActive());
+}
+
+int main(void)
+{
+    test_fade_reaches_target();
+    test_stop_clears_pending_event();
+    test_stray_event_ignored();
+    return TEST_RESULT();
+}
@@ -0,0 +1,119 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : test_pwm_gamma.c
+ * Author             :
+ * Version            : V1.0
+ * Date               : 2026/01/24
+ * Description        : 编译进固件的 PWM_GammaLUT 检查，及总宽度经查表后的分配
+ *                      同一文件分别以 PWM_GAMMA_ENABLE=1/0 编译为两个测试
+ *******************************************************************************/
+
+#include "CONFIG.h"
+#include "PWM.h"
+#include "mock_hw.h"
+#include "test_util.h"
+#include <math.h>
+
+// 与 tools/gen_pwm_gamma.py 的默认指数一致
+#define GAMMA    2.2
+
+#if (PWM_GAMMA_ENABLE)
+static void test_lut(void)
+{
+    uint8_t  mono = 1, nonzero = 1, formula = 1;
+    uint16_t x;
+
+    CHECK_EQ(sizeof(PWM_GammaLUT) / sizeof(PWM_GammaLUT[0]), PWM_Q8_ONE + 1);
+    CHECK_EQ(PWM_GammaLUT[0], 0);
+    CHECK_EQ(PWM_GammaLUT[PWM_Q8_ONE], PWM_Q8_ONE);
+
+    for(x = 1; x <= PWM_Q8_ONE; x++)
+    {
+        long y = lround(pow((double)x / PWM_Q8_ONE, GAMMA) * PWM_Q8_ONE);
+
+        if(y == 0)
+        {
+            y = 1;
+        }
+        if(PWM_GammaLUT[x] < PWM_GammaLUT[x - 1])
+        {
+            fprintf(stderr, "not monotonic at %u\n", x);
+            mono = 0;
+        }
+        if(PWM_GammaLUT[x] == 0)
+        {
+            nonzero = 0;
+        }
+        if(PWM_GammaLUT[x] != y)
+        {
+            fprintf(stderr, "LUT[%u] = %u, expected %ld\n", x, PWM_GammaLUT[x], y);
+            formula = 0;
+        }
+    }
+    CHECK(mono);
+    CHECK(nonzero);
+    CHECK(formula);
+}
+#endif
+
+// 输出的总宽度：使能时为查表值，关闭时等于输入
+static uint16_t expected_total(uint16_t total_q8)
+{
+#if (PWM_GAMMA_ENABLE)
+    return PWM_GammaLUT[total_q8];
+#else
+    return total_q8;
+#endif
+}
+
+static void test_output(void)
+{
+    uint16_t x, w1, w2;
+    uint8_t  all_pwm1 = 1, split = 1;
+
+    mock_hw_reset();
+    mock_tmos_reset();
+    PWM_ComplementaryInit();
+
+    for(x = 0; x <= PWM_Q8_ONE; x++)
+    {
+        PWM_SetWidthsQ8(x, PWM_Q8_ONE);
+        PWM_GetWidthsQ8(&w1, &w2);
+        if((w1 != expected_total(x)) || (w2 != 0))
+        {
+            fprintf(stderr, "total %u ratio 256: %u/%u\n", x, w1, w2);
+            all_pwm1 = 0;
+        }
+
+        PWM_SetWidthsQ8(x, PWM_Q8_ONE / 2);
+        PWM_GetWidthsQ8(&w1, &w2);
+        if((w1 + w2 != expected_total(x)) || (w1 != ((expected_total(x) * 128U + 128U) >> 8)))
+        {
+            fprintf(stderr, "total %u ratio 128: %u/%u\n", x, w1, w2);
+            split = 0;
+        }
+    }
+    CHECK(all_pwm1);
+    CHECK(split);
+
+    // 端点
+    PWM_SetWidthsQ8(0, PWM_Q8_ONE);
+    PWM_GetWidthsQ8(&w1, &w2);
+    CHECK_EQ(w1, 0);
+    PWM_SetWidthsQ8(PWM_Q8_ONE, PWM_Q8_ONE);
+    PWM_GetWidthsQ8(&w1, &w2);
+    CHECK_EQ(w1, PWM_Q8_ONE);
+
+    // 超过256的输入钳位到256
+    PWM_SetWidthsQ8(1000, PWM_Q8_ONE);
+    PWM_GetWidthsQ8(&w1, &w2);
+    CHECK_EQ(w1, PWM_Q8_ONE);
+}
+
+int main(void)
+{
+#if (PWM_GAMMA_ENABLE)
+    test_lut();
+#endif
+    test_output();
+    return TEST_RESULT();
+}
@@ -0,0 +1,185 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : test_pwm_protocol.c
+ * Author             :
+ * Version            : V1.0
+ * Date               : 2026/01/24
+ * Description        : 2字节/4字节旧格式PWM命令端到端测试
+ *                      app_ctrl_process() -> PWM模块 -> PWMX寄存器，
+ *                      渐变由模拟TMOS推进，宽度在PWMX周期结束中断中提交
+ *******************************************************************************/
+
+#include "CONFIG.h"
+#include "PWM.h"
+#include "app_ctrl.h"
+#include "mock_hw.h"
+#include "test_util.h"
+
+#define PWMX_DATA_ADDR    0x40005004UL
+
+// 按协议计算PWM4/PWM5的期望寄存器值
+static void expect_hw(uint8_t total_pct, uint8_t pwm4_pct, uint8_t *d4, uint8_t *d5)
+{
+    uint32_t total = PWM_PCT_TO_Q8(total_pct);
+    uint32_t w1;
+
+#if (PWM_GAMMA_ENABLE)
+    total = PWM_GammaLUT[total];
+#endif
+    w1 = (total * PWM_PCT_TO_Q8(pwm4_pct) + 128) >> 8;
+    *d4 = (uint8_t)(w1 - (w1 >> 8));
+    *d5 = (uint8_t)((total - w1) - ((total - w1) >> 8));
+}
+
+// 推进ms毫秒，每个tick结束时经过一次PWMX周期结束
+static void run_ms(uint32_t ms)
+{
+    uint32_t ticks = MS1_TO_SYSTEM_TIME(ms);
+
+    while(ticks--)
+    {
+        mock_tmos_run(1);
+        mock_pwmx_cycle_end();
+    }
+}
+
+static uint8_t send(const uint8_t *p, uint16_t len)
+{
+    uint8_t status = app_ctrl_process(p, len);
+
+    mock_trace_sync();
+    return status;
+}
+
+static void test_init(void)
+{
+    mock_hw_reset();
+    mock_tmos_reset();
+    PWM_ComplementaryInit();
+    PWM_FadeInit();
+    mock_trace_sync();
+
+    CHECK(PFIC_GetStatusIRQ(PWMX_SPI1_IRQn));
+    CHECK_EQ(R8_PWM_OUT_EN & (CH_PWM4 | CH_PWM5), 0);
+    CHECK_EQ(R8_PWM_CONFIG & 0x0F, 0); // PWMX_Cycle_256
+    CHECK_EQ(R8_PWM_CLOCK_DIV, 3);
+}
+
+// 首次设置：输出尚未开启，数据直接写入后开启两路
+static void test_first_set(void)
+{
+    const uint8_t cmd[] = {50, 50};
+    uint8_t       d4, d5;
+
+    expect_hw(50, 50, &d4, &d5);
+    mock_trace_clear();
+    CHECK_EQ(send(cmd, sizeof(cmd)), APP_CTRL_OK);
+
+    CHECK_EQ(R8_PWM4_DATA, d4);
+    CHECK_EQ(R8_PWM5_DATA, d5);
+    CHECK_EQ(R8_PWM_OUT_EN & (CH_PWM4 | CH_PWM5), CH_PWM4 | CH_PWM5);
+    CHECK(mock_trace_find(PWMX_DATA_ADDR, 0) >= 0);
+}
+
+// 输出开启后：新宽度等到周期结束中断才以一次半字写入提交
+static void test_set_at_cycle_end(void)
+{
+    const uint8_t cmd[] = {100, 25};
+    uint8_t       d4, d5, old4 = R8_PWM4_DATA, old5 = R8_PWM5_DATA;
+    int           idx;
+
+    expect_hw(100, 25, &d4, &d5);
+    CHECK(d4 != old4);
+    CHECK(d5 != old5);
+
+    mock_trace_clear();
+    CHECK_EQ(send(cmd, sizeof(cmd)), APP_CTRL_OK);
+    CHECK_EQ(R8_PWM4_DATA, old4);
+    CHECK_EQ(R8_PWM5_DATA, old5);
+    CHECK(R8_PWM_INT_CTRL & RB_PWM_IE_CYC);
+
+    CHECK(mock_pwmx_cycle_end());
+    CHECK_EQ(R8_PWM4_DATA, d4);
+    CHECK_EQ(R8_PWM5_DATA, d5);
+
+    idx = mock_trace_find(PWMX_DATA_ADDR, 0);
+    CHECK(idx >= 0);
+    if(idx >= 0)
+    {
+        const mock_reg_write_t *w = mock_trace_get(idx);
+
+        CHECK(strcmp(w->ctx, "PWMX_IRQHandler") == 0);
+        CHECK_EQ(w->width, 2);
+        CHECK_EQ(w->value, (uint32_t)d4 | ((uint32_t)d5 << 8));
+    }
+    // 提交后关闭周期中断
+    CHECK(!(R8_PWM_INT_CTRL & RB_PWM_IE_CYC));
+    CHECK(!mock_pwmx_cycle_end());
+}
+
+// 相同命令不产生任何寄存器写入
+static void test_same_value(void)
+{
+    const uint8_t cmd[] = {100, 25};
+
+    mock_trace_clear();
+    CHECK_EQ(send(cmd, sizeof(cmd)), APP_CTRL_OK);
+    CHECK_EQ(mock_trace_count(), 0);
+}
+
+// 超出范围的值按100%处理；长度非法的写入不改变输出
+static void test_clamp_and_length(void)
+{
+    const uint8_t cmd[] = {200, 255};
+    const uint8_t bad[] = {10, 20, 30};
+
+    CHECK_EQ(send(cmd, sizeof(cmd)), APP_CTRL_OK);
+    mock_pwmx_cycle_end();
+    CHECK_EQ(R8_PWM4_DATA, 255);
+    CHECK_EQ(R8_PWM5_DATA, 0);
+
+    mock_trace_clear();
+    CHECK_EQ(send(bad, sizeof(bad)), APP_CTRL_ERR_LENGTH);
+    CHECK_EQ(send(bad, 0), APP_CTRL_ERR_LENGTH);
+    mock_pwmx_cycle_end();
+    CHECK_EQ(mock_trace_count(), 0);
+}
+
+// 4字节命令：100ms渐变到0，PWM4单调下降，结束时两路均为0
+static void test_fade(void)
+{
+    const uint8_t cmd[] = {0, 50, 100, 0};
+    uint8_t       last = R8_PWM4_DATA;
+    uint8_t       ok = 1;
+    int           i;
+
+    CHECK_EQ(send(cmd, sizeof(cmd)), APP_CTRL_OK);
+    CHECK(PWM_FadeIsActive());
+    for(i = 0; i < 10; i++)
+    {
+        run_ms(PWM_FADE_TICK_MS);
+        if(R8_PWM4_DATA > last)
+        {
+            ok = 0;
+        }
+        last = R8_PWM4_DATA;
+    }
+    CHECK(ok);
+    CHECK(!PWM_FadeIsActive());
+    CHECK_EQ(R8_PWM4_DATA, 0);
+    CHECK_EQ(R8_PWM5_DATA, 0);
+}
+
+int main(void)
+{
+    test_init();
+    test_first_set();
+    test_set_at_cycle_end();
+    test_same_value();
+    test_clamp_and_length();
+    test_fade();
+    if(test_failures)
+    {
+        mock_trace_dump(stderr);
+    }
+    return TEST_RESULT();
+}
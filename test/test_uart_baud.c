@@ -0,0 +1,160 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : test_uart_baud.c
+ * Author             :
+ * Version            : V1.0
+ * Date               : 2026/01/24
+ * Description        : app_uart_baud_divisor() 在60MHz下的分频系数
+ *                      - tools/uart_baud_check.py 的常用波特率逐项对照DL和接受/拒绝
+ *                      - 每个接受的波特率：误差在APP_UART_BAUD_TOLERANCE内，DL±1都不更接近
+ *                      - app_uart_config() 把同样的DL写入UART3
+ *******************************************************************************/
+
+#include "CONFIG.h"
+#include "app_uart.h"
+#include "mock_hw.h"
+#include "test_util.h"
+
+#define FSYS    60000000UL
+
+typedef struct
+{
+    uint32_t baud;
+    uint16_t dl;    // 0：不支持
+} baud_case_t;
+
+// 与 tools/uart_baud_check.py 的 COMMON_RATES 相同，DL为该脚本在60MHz下的输出
+static const baud_case_t common_rates[] = {
+    {1200, 6250},   {2400, 3125},   {4800, 1563},    {9600, 781},    {14400, 521},   {19200, 391},
+    {38400, 195},   {57600, 130},   {115200, 65},    {230400, 33},   {250000, 30},   {460800, 16},
+    {500000, 15},   {921600, 8},    {1000000, 0},    {1500000, 5},   {2000000, 0},   {3000000, 0},
+};
+
+static double rate_error(uint32_t fsys, uint32_t baud, uint16_t dl)
+{
+    double actual = (double)fsys / 8 / dl;
+
+    return (actual > baud) ? (actual - baud) / baud : (baud - actual) / baud;
+}
+
+// 接受的DL：误差在容限内，且相邻的DL不会更接近
+static uint8_t dl_is_best(uint32_t fsys, uint32_t baud, uint16_t dl)
+{
+    double err = rate_error(fsys, baud, dl);
+
+    if(err * 1000 > APP_UART_BAUD_TOLERANCE)
+    {
+        return 0;
+    }
+    if((dl > 1) && (rate_error(fsys, baud, dl - 1) < err))
+    {
+        return 0;
+    }
+    if((dl < 0xFFFF) && (rate_error(fsys, baud, dl + 1) < err))
+    {
+        return 0;
+    }
+    return 1;
+}
+
+static void test_common_rates(void)
+{
+    size_t i;
+
+    for(i = 0; i < sizeof(common_rates) / sizeof(common_rates[0]); i++)
+    {
+        const baud_case_t *c = &common_rates[i];
+        uint16_t           dl = 0;
+        bool               ok = app_uart_baud_divisor(FSYS, c->baud, &dl);
+
+        if((ok != (c->dl != 0)) || (ok && (dl != c->dl)) || (ok && !dl_is_best(FSYS, c->baud, dl)))
+        {
+            fprintf(stderr, "%lu baud: %s dl %u, expected dl %u\n", (unsigned long)c->baud,
+                    ok ? "accepted" : "rejected", dl, c->dl);
+        }
+        CHECK_EQ(ok, c->dl != 0);
+        if(ok)
+        {
+            CHECK_EQ(dl, c->dl);
+            CHECK(dl_is_best(FSYS, c->baud, dl));
+        }
+    }
+}
+
+// 300bps到3Mbps全范围：接受的都满足容限和最优，拒绝的确实没有满足容限的DL
+static void test_sweep(void)
+{
+    uint32_t baud;
+    uint8_t  best = 1, reject = 1;
+
+    for(baud = 300; baud <= 3000000; baud += (baud < 20000) ? 1 : 37)
+    {
+        uint16_t dl;
+
+        if(app_uart_baud_divisor(FSYS, baud, &dl))
+        {
+            if(!dl_is_best(FSYS, baud, dl))
+            {
+                fprintf(stderr, "%lu baud: dl %u not best\n", (unsigned long)baud, dl);
+                best = 0;
+            }
+        }
+        else
+        {
+            uint32_t near = (FSYS / 8) / baud;
+
+            if(((near >= 1) && (near <= 0xFFFF) && (rate_error(FSYS, baud, near) * 1000 <= APP_UART_BAUD_TOLERANCE)) ||
+               ((near + 1 <= 0xFFFF) && (rate_error(FSYS, baud, near + 1) * 1000 <= APP_UART_BAUD_TOLERANCE)))
+            {
+                fprintf(stderr, "%lu baud: rejected but supported\n", (unsigned long)baud);
+                reject = 0;
+            }
+        }
+    }
+    CHECK(best);
+    CHECK(reject);
+}
+
+static void test_limits(void)
+{
+    uint16_t dl = 0x1234;
+
+    CHECK(!app_uart_baud_divisor(FSYS, 0, &dl));
+    CHECK(!app_uart_baud_divisor(FSYS, 100, &dl));          // DL > 0xFFFF
+    CHECK(!app_uart_baud_divisor(FSYS, FSYS / 8 * 3, &dl)); // DL = 0
+    CHECK_EQ(dl, 0x1234);
+    CHECK(app_uart_baud_divisor(FSYS, FSYS / 8, &dl));
+    CHECK_EQ(dl, 1);
+}
+
+// app_uart_config() 以GetSysClock()计算，写入的DL与上面一致
+static void test_config_writes_dl(void)
+{
+    size_t i;
+
+    mock_hw_reset();
+    mock_tmos_reset();
+    app_uart_init();
+    CHECK_EQ(GetSysClock(), FSYS);
+
+    for(i = 0; i < sizeof(common_rates) / sizeof(common_rates[0]); i++)
+    {
+        const baud_case_t *c = &common_rates[i];
+        uint16_t           old = R16_UART3_DL;
+
+        CHECK_EQ(app_uart_config(c->baud, APP_UART_PARITY_NONE, 1), c->dl != 0);
+        CHECK_EQ(R16_UART3_DL, c->dl ? c->dl : old);
+        if(c->dl)
+        {
+            CHECK_EQ(R8_UART3_DIV, 1);
+        }
+    }
+}
+
+int main(void)
+{
+    test_common_rates();
+    test_sweep();
+    test_limits();
+    test_config_writes_dl();
+    return TEST_RESULT();
+}
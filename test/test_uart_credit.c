@@ -0,0 +1,152 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : test_uart_credit.c
+ * Author             :
+ * Version            : V1.0
+ * Date               : 2026/01/24
+ * Description        : 串口发送FIFO的流控额度（UART_CREDIT_EVT）
+ *                      测试注册一个任务代替peripheral任务，记录串口模块置位的额度事件：
+ *                      - 越过高水位时通知一次，降到低水位后由app_uart_process()再通知
+ *                      - app_uart_config()清空FIFO后清除限流状态并立即给出新额度
+ *                      - 断开连接(app_uart_tx_credit_reset)后，新连接越过高水位时重新通知
+ *******************************************************************************/
+
+#include "CONFIG.h"
+#include "app_uart.h"
+#include "peripheral.h"
+#include "mock_hw.h"
+#include "test_util.h"
+
+// 与 app_uart.c 中的 APP_UART_TX_BUFFER_LENGTH / APP_UART_TX_CREDIT_HIGH / APP_UART_TX_CREDIT_LOW 一致
+#define TX_BUFFER     1024U
+#define CREDIT_HIGH   (TX_BUFFER / 2)
+#define CREDIT_LOW    (TX_BUFFER / 4)
+
+void UART3_IRQHandler(void);
+
+static uint16_t credit_events = 0;
+
+static tmosEvents fake_peripheral(tmosTaskID task_id, tmosEvents events)
+{
+    (void)task_id;
+    if(events & UART_CREDIT_EVT)
+    {
+        credit_events++;
+        return (events ^ UART_CREDIT_EVT);
+    }
+    // 串口->蓝牙发送等其他事件直接丢弃
+    return 0;
+}
+
+static void setup(void)
+{
+    mock_hw_reset();
+    mock_tmos_reset();
+    Peripheral_TaskID = TMOS_ProcessEventRegister(fake_peripheral);
+    app_uart_init();
+    // 静态的限流状态只在上电时为0，各用例之间手动清除
+    app_uart_tx_credit_reset();
+    mock_tmos_poll();
+    credit_events = 0;
+    CHECK_EQ(app_uart_tx_room(), TX_BUFFER);
+}
+
+// 蓝牙写入len字节并处理事件，返回本次新增的额度事件数
+static uint16_t ble_write(uint16_t len)
+{
+    static uint8_t data[TX_BUFFER];
+    uint16_t       before = credit_events;
+
+    app_uart_tx_data(data, len);
+    app_uart_process();
+    mock_tmos_poll();
+    return credit_events - before;
+}
+
+// 模拟THR空中断，把发送FIFO排空到剩余len字节
+static void uart_drain_to(uint16_t len)
+{
+    R8_UART3_IIR = UART_II_THR_EMPTY;
+    while((TX_BUFFER - app_uart_tx_room() > len) && (R8_UART3_IER & RB_IER_THR_EMPTY))
+    {
+        mock_irq("UART3_IRQHandler", UART3_IRQHandler);
+    }
+    R8_UART3_IIR = UART_II_NO_INTER;
+}
+
+static uint16_t main_loop(void)
+{
+    uint16_t before = credit_events;
+
+    app_uart_process();
+    mock_tmos_poll();
+    return credit_events - before;
+}
+
+static void test_high_low(void)
+{
+    setup();
+    CHECK_EQ(ble_write(CREDIT_HIGH - 1), 0);
+    CHECK_EQ(ble_write(1), 1);
+    // 已限流，继续写入不再通知
+    CHECK_EQ(ble_write(16), 0);
+
+    uart_drain_to(CREDIT_LOW + 8);
+    CHECK_EQ(main_loop(), 0);
+    uart_drain_to(CREDIT_LOW);
+    CHECK_EQ(main_loop(), 1);
+    CHECK_EQ(main_loop(), 0);
+
+    // 新额度之后再次越过高水位
+    CHECK_EQ(ble_write(CREDIT_HIGH), 1);
+}
+
+// 限流中、尚未排空到低水位时重新配置串口
+static void test_config_resets_throttle(void)
+{
+    setup();
+    CHECK_EQ(ble_write(CREDIT_HIGH), 1);
+    CHECK(app_uart_config(115200, APP_UART_PARITY_NONE, 1));
+    CHECK_EQ(app_uart_tx_room(), TX_BUFFER);
+    CHECK_EQ(main_loop(), 1);
+
+    // 清空后的FIFO再次越过高水位时照常通知
+    CHECK_EQ(ble_write(CREDIT_HIGH), 1);
+
+    // 不支持的配置不动FIFO，也不发额度
+    CHECK(!app_uart_config(1, APP_UART_PARITY_NONE, 1));
+    CHECK_EQ(main_loop(), 0);
+}
+
+// 中断已置位恢复标志，但主循环处理前就重新配置：不应再补发一次旧额度
+static void test_config_drops_resume(void)
+{
+    setup();
+    CHECK_EQ(ble_write(CREDIT_HIGH), 1);
+    uart_drain_to(CREDIT_LOW);
+    CHECK(app_uart_config(9600, APP_UART_PARITY_EVEN, 1));
+    CHECK_EQ(main_loop(), 1);
+    CHECK_EQ(main_loop(), 0);
+}
+
+// 断开连接：旧连接的限流状态不能带到新连接
+static void test_link_terminated(void)
+{
+    setup();
+    CHECK_EQ(ble_write(CREDIT_HIGH), 1);
+    uart_drain_to(CREDIT_LOW);
+
+    app_uart_tx_credit_reset();
+    CHECK_EQ(main_loop(), 0);
+    uart_drain_to(0);
+
+    CHECK_EQ(ble_write(CREDIT_HIGH), 1);
+}
+
+int main(void)
+{
+    test_high_low();
+    test_config_resets_throttle();
+    test_config_drops_resume();
+    test_link_terminated();
+    return TEST_RESULT();
+}
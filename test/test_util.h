@@ -0,0 +1,45 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : test_util.h
+ * Author             :
+ * Version            : V1.0
+ * Date               : 2026/01/24
+ * Description        : 主机测试的检查宏，失败时打印位置并继续，main()以TEST_RESULT()结束
+ *******************************************************************************/
+
+#ifndef __TEST_UTIL_H__
+#define __TEST_UTIL_H__
+
+#include <stdio.h>
+
+static int test_checks = 0;
+static int test_failures = 0;
+
+#define CHECK(cond)                                                                     \
+    do                                                                                  \
+    {                                                                                   \
+        test_checks++;                                                                  \
+        if(!(cond))                                                                     \
+        {                                                                               \
+            fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond);   \
+            test_failures++;                                                            \
+        }                                                                               \
+    } while(0)
+
+#define CHECK_EQ(a, b)                                                                  \
+    do                                                                                  \
+    {                                                                                   \
+        long long test_a_ = (long long)(a), test_b_ = (long long)(b);                   \
+        test_checks++;                                                                  \
+        if(test_a_ != test_b_)                                                          \
+        {                                                                               \
+            fprintf(stderr, "%s:%d: CHECK_EQ(%s, %s) failed: %lld != %lld\n", __FILE__, \
+                    __LINE__, #a, #b, test_a_, test_b_);                                \
+            test_failures++;                                                            \
+        }                                                                               \
+    } while(0)
+
+#define TEST_RESULT()                                                                   \
+    (printf("%s: %d checks, %d failed\n", __FILE__, test_checks, test_failures),        \
+     (test_failures ? 1 : 0))
+
+#endif // __TEST_UTIL_H__
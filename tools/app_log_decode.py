@@ -0,0 +1,120 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+把 app_log 输出的 "#L" 行还原为文本。
+
+固件只输出格式编号和整数参数（十六进制），格式字符串取自
+APP/include/app_log.h 中的 APP_LOG_FMT_TABLE，编号即表中顺序。
+其余串口输出原样保留，可直接处理整段串口抓包：
+
+    python tools/app_log_decode.py capture.txt
+    python tools/app_log_decode.py < capture.txt
+    python tools/app_log_decode.py --only capture.txt    # 只输出解码结果
+
+行格式：#L <time> <id> <lost> [arg...]
+    time - TMOS系统时钟，单位625us
+    lost - 该记录之前因环形缓冲区满而丢弃的记录数
+"""
+
+import argparse
+import os
+import re
+import sys
+
+HEADER_DEFAULT = os.path.join(os.path.dirname(__file__), "..", "APP", "include", "app_log.h")
+
+TICK_US = 625
+
+ENTRY_RE = re.compile(r'X\(\s*(\w+)\s*,\s*"((?:[^"\\]|\\.)*)"\s*\)')
+SPEC_RE = re.compile(r'%([-+ 0#]*\d*(?:\.\d+)?)(?:hh|h|ll|l|z)?([diuxXcs%])')
+
+
+def load_table(header):
+    with open(header, encoding="utf-8") as f:
+        text = f.read()
+    start = text.find("#define APP_LOG_FMT_TABLE")
+    if start < 0:
+        raise SystemExit("APP_LOG_FMT_TABLE not found in %s" % header)
+    # 宏定义以续行符结尾的行组成，遇到第一行不以 '\' 结尾即结束
+    lines = []
+    for line in text[start:].splitlines():
+        lines.append(line)
+        if not line.rstrip().endswith("\\"):
+            break
+    table = []
+    for name, fmt in ENTRY_RE.findall("\n".join(lines)):
+        table.append((name, bytes(fmt, "utf-8").decode("unicode_escape")))
+    return table
+
+
+def format_c(fmt, args):
+    """按C printf语义格式化，参数均为32位整数。"""
+    it = iter(args)
+
+    def sub(m):
+        flags, conv = m.group(1), m.group(2)
+        if conv == "%":
+            return "%"
+        try:
+            v = next(it)
+        except StopIteration:
+            return "<?>"
+        if conv in "di":
+            if v & 0x80000000:
+                v -= 1 << 32
+            return ("%" + flags + "d") % v
+        if conv == "c":
+            return chr(v & 0xFF)
+        if conv == "s":
+            return "<str@%08x>" % v
+        return ("%" + flags + conv) % v
+
+    return SPEC_RE.sub(sub, fmt)
+
+
+def decode_line(table, line):
+    fields = line.split()[1:]
+    try:
+        values = [int(x, 16) for x in fields]
+    except ValueError:
+        return None
+    if len(values) < 3:
+        return None
+    time, fid, lost, args = values[0], values[1], values[2], values[3:]
+    stamp = "[%10.4f]" % (time * TICK_US / 1e6)
+    out = []
+    if lost:
+        out.append("%s ... %d record(s) lost" % (stamp, lost))
+    if fid < len(table):
+        out.append("%s %s" % (stamp, format_c(table[fid][1], args)))
+    else:
+        out.append("%s <unknown id %d> %s" % (stamp, fid, " ".join(fields[3:])))
+    return out
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("capture", nargs="?", help="串口抓包文件，缺省读stdin")
+    ap.add_argument("--header", default=HEADER_DEFAULT, help="app_log.h 路径")
+    ap.add_argument("--only", action="store_true", help="只输出解码后的 #L 行")
+    opt = ap.parse_args()
+
+    table = load_table(opt.header)
+    src = open(opt.capture, encoding="utf-8", errors="replace") if opt.capture else sys.stdin
+    with src:
+        for raw in src:
+            line = raw.rstrip("\r\n")
+            idx = line.find("#L ")
+            decoded = decode_line(table, line[idx:]) if idx >= 0 else None
+            if decoded is not None:
+                # 与其他PRINT输出粘连时，前缀部分原样保留
+                if idx > 0 and not opt.only:
+                    print(line[:idx])
+                print("\n".join(decoded))
+                continue
+            if not opt.only:
+                print(line)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,82 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+生成 APP/Src/PWM_Gamma.c 中的感知亮度(gamma)查找表。
+
+表的输入/输出均为Q8宽度 (0-256, 256表示100%)，共257项，编译进flash，
+运行时只做一次查表，无需pow()。修改指数后重新运行本脚本即可：
+
+    python tools/gen_pwm_gamma.py --gamma 2.2
+
+生成前会检查：两端点 0->0、256->256，表单调不减，非零输入不会输出0。
+"""
+
+import argparse
+import os
+
+Q8_ONE = 256
+OUT_DEFAULT = os.path.join(os.path.dirname(__file__), "..", "APP", "Src", "PWM_Gamma.c")
+
+
+def build_table(gamma):
+    table = []
+    for x in range(Q8_ONE + 1):
+        y = int(round(((x / Q8_ONE) ** gamma) * Q8_ONE))
+        if x > 0 and y == 0:
+            y = 1  # 最低档位仍保持可见的最小宽度，避免调光低端“熄灭”
+        table.append(y)
+    return table
+
+
+def check_table(table):
+    assert len(table) == Q8_ONE + 1, "table length"
+    assert table[0] == 0, "endpoint 0 must map to 0"
+    assert table[Q8_ONE] == Q8_ONE, "endpoint 256 must map to 256"
+    for i in range(1, len(table)):
+        assert table[i] >= table[i - 1], "table not monotonic at %d" % i
+        assert table[i] > 0, "non-zero input %d maps to 0" % i
+
+
+def render(table, gamma):
+    lines = []
+    lines.append("/********************************** (C) COPYRIGHT *******************************")
+    lines.append(" * File Name          : PWM_Gamma.c")
+    lines.append(" * Author             :")
+    lines.append(" * Version            : V1.0")
+    lines.append(" * Date               : 2025/12/01")
+    lines.append(" * Description        : PWM感知亮度(gamma)查找表，由 tools/gen_pwm_gamma.py 生成，")
+    lines.append(" *                      请勿手工修改。gamma = %.2f" % gamma)
+    lines.append(" *******************************************************************************/")
+    lines.append("")
+    lines.append('#include "PWM.h"')
+    lines.append("")
+    lines.append("#if (PWM_GAMMA_ENABLE)")
+    lines.append("")
+    lines.append("// 输入：Q8感知亮度 (0-256)，输出：Q8实际宽度 (0-256)")
+    lines.append("const uint16_t PWM_GammaLUT[PWM_Q8_ONE + 1] = {")
+    for i in range(0, len(table), 16):
+        chunk = ", ".join("%3d" % v for v in table[i:i + 16])
+        lines.append("    %s," % chunk)
+    lines.append("};")
+    lines.append("")
+    lines.append("#endif")
+    lines.append("")
+    return "\n".join(lines)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Generate the PWM gamma lookup table")
+    parser.add_argument("--gamma", type=float, default=2.2, help="gamma exponent (default 2.2)")
+    parser.add_argument("--out", default=OUT_DEFAULT, help="output C file")
+    args = parser.parse_args()
+
+    table = build_table(args.gamma)
+    check_table(table)
+
+    with open(args.out, "w", encoding="utf-8", newline="\n") as f:
+        f.write(render(table, args.gamma))
+    print("wrote %s (gamma=%.2f)" % (os.path.normpath(args.out), args.gamma))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,82 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+检查透传串口(UART3)在给定系统时钟下各波特率的分频系数。
+
+与 APP/Src/app_uart.c 中 app_uart_baud_divisor() 使用相同的算法：
+预分频固定为1，baud = Fsys / 8 / DL，DL取 Fsys/8/baud 两侧中波特率误差
+较小的一个（直接对DL四舍五入在中点附近会选错），误差超过
+APP_UART_BAUD_TOLERANCE(千分之20) 的波特率拒绝配置。
+
+    python tools/uart_baud_check.py                 # 60MHz，常用波特率
+    python tools/uart_baud_check.py --fsys 32000000 --baud 250000 500000
+
+逐项输出 DL、实际波特率和误差；对每个接受的波特率还会检查
+DL±1 都不会更接近目标，以及误差确实在容限内，任何一项不满足时返回1。
+"""
+
+import argparse
+import sys
+
+TOLERANCE_PERMILLE = 20
+
+COMMON_RATES = [
+    1200, 2400, 4800, 9600, 14400, 19200, 38400, 57600, 115200, 230400,
+    250000, 460800, 500000, 921600, 1000000, 1500000, 2000000, 3000000,
+]
+
+
+def divisor(fsys, baud):
+    """app_uart_baud_divisor() 的Python版本，不支持时返回None。"""
+    if baud == 0:
+        return None
+    clk = fsys // 8
+    dl = clk // baud
+    err_lo = clk - baud * dl
+    err_hi = baud * (dl + 1) - clk
+    # 误差乘以DL后比较：|clk/dl - baud| * dl = |clk - baud*dl|
+    if dl == 0 or err_hi * dl < err_lo * (dl + 1):
+        dl += 1
+        err_lo = err_hi
+    if dl > 0xFFFF:
+        return None
+    if err_lo * 1000 > baud * dl * TOLERANCE_PERMILLE:
+        return None
+    return dl
+
+
+def check(fsys, baud, dl):
+    """返回发现的问题列表，空表示通过。"""
+    problems = []
+    err = abs(fsys / 8 / dl - baud) / baud
+    if err * 1000 > TOLERANCE_PERMILLE:
+        problems.append("error %.2f%% over tolerance" % (err * 100))
+    for other in (dl - 1, dl + 1):
+        if 0 < other <= 0xFFFF and abs(fsys / 8 / other - baud) < abs(fsys / 8 / dl - baud):
+            problems.append("DL %d is closer than %d" % (other, dl))
+    return problems
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("--fsys", type=int, default=60000000, help="系统时钟，默认60MHz")
+    ap.add_argument("--baud", type=int, nargs="*", default=COMMON_RATES, help="要检查的波特率")
+    opt = ap.parse_args()
+
+    failed = False
+    print("%9s %6s %9s %7s  %s" % ("baud", "DL", "actual", "error", "result"))
+    for baud in opt.baud:
+        dl = divisor(opt.fsys, baud)
+        if dl is None:
+            print("%9d %6s %9s %7s  rejected" % (baud, "-", "-", "-"))
+            continue
+        actual = opt.fsys / 8 / dl
+        problems = check(opt.fsys, baud, dl)
+        failed |= bool(problems)
+        print("%9d %6d %9.0f %+6.2f%%  %s" % (baud, dl, actual, (actual - baud) * 100 / baud,
+                                               "; ".join(problems) if problems else "ok"))
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())